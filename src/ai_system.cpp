@@ -1,12 +1,19 @@
 // internal
 #include "ai_system.hpp"
 
-void AISystem::step(float elapsed_ms)
+bool AISystem::init() {
+	if (!behaviours.load(behaviour_path("bosses.json"))) {
+		fprintf(stderr, "Failed to load boss behaviours\n");
+		return false;
+	}
+	return true;
+}
+
+void AISystem::step(const FrameContext& frame)
 {
-	// update player entity
-	auto players = registry.players.entities;
-	if (!players.empty()) {
-		player = players.back();
+	float elapsed_ms = frame.elapsed_ms;
+	if (frame.has_player) {
+		player = frame.player;
 	}
 	if (MOVE_ENEMIES) {
 		move_enemies(elapsed_ms);
@@ -14,7 +21,7 @@ void AISystem::step(float elapsed_ms)
 		swarm_block_interestpoint(elapsed_ms);
 	};
 	enemy_shoot(elapsed_ms);
-	enemy_dash(elapsed_ms);
+	step_boss_behaviours(elapsed_ms);
 }
 
 void AISystem::move_enemies(float elapsed_ms) {
@@ -161,124 +168,164 @@ void AISystem::swarm_block_interestpoint(float elapsed_ms) {
 	}
 }
 
+// True as soon as the entity is partially visible on screen
+static bool is_on_screen(vec2 player_position, const Transform& transform) {
+	vec2 distance = abs(player_position - transform.position) - length(transform.scale / 2.f);
+	return distance.x <= CONTENT_WIDTH_PX / 2 && distance.y <= CONTENT_HEIGHT_PX / 2;
+}
+
 void AISystem::enemy_shoot(float elapsed_ms) {
+	vec2 playerposition = registry.transforms.get(player).position;
 	for (Entity entity : registry.guns.entities) {
+		// Boss guns are driven by their behaviour program
+		if (!registry.enemies.has(entity) || registry.bosses.has(entity)) continue;
 		Gun& enemyGun = registry.guns.get(entity);
-		vec2 playerposition = registry.transforms.get(player).position;
-		Transform& enemy_transform = registry.transforms.get(entity);
-		vec2 distance = abs(playerposition - enemy_transform.position) - length(enemy_transform.scale / 2.f);	// As soon as the enemy is partially visible
-		if (registry.enemies.has(entity) && distance.x <= CONTENT_WIDTH_PX / 2 && distance.y <= CONTENT_HEIGHT_PX / 2) {
-			if (enemyGun.attack_timer <= 0) {
-				Enemy& enemy = registry.enemies.get(entity);
-				if (enemy.type == ENEMY_ID::BOSS) {
-					if (registry.bosses.get(entity).activated) {
-						createBullet(entity, enemyGun.bullet_size, enemyGun.bullet_color);
-					}
-				} else if (enemy.type == ENEMY_ID::FRIENDBOSS) {
-					if (registry.bosses.get(entity).activated) {
-						float decision = (static_cast<float>(rand()) / RAND_MAX); //This generates num between 0 and 1
-						if (decision <= 0.7f) {
-							createBullet(entity, enemyGun.bullet_size, enemyGun.bullet_color);
-						}
-						else {
-							enemy_special_attack(entity);
-						}
-					}
-				} else {
-					createBullet(entity, { 13.f, 13.f }, { 0.718f, 1.f, 0.f, 1.f });
-				}
-				enemyGun.attack_timer = enemyGun.attack_delay;
-			}
+		if (is_on_screen(playerposition, registry.transforms.get(entity)) && enemyGun.attack_timer <= 0) {
+			createBullet(registry, entity, { 13.f, 13.f }, { 0.718f, 1.f, 0.f, 1.f });
+			enemyGun.attack_timer = enemyGun.attack_delay;
 		}
 		enemyGun.attack_timer = max(enemyGun.attack_timer - elapsed_ms, 0.f);
+	}
+}
 
+void AISystem::step_boss_behaviours(float elapsed_ms) {
+	for (uint i = 0; i < registry.bosses.size(); i++) {
+		Entity entity = registry.bosses.entities[i];
+		Boss& boss = registry.bosses.components[i];
+		if (registry.dashes.has(entity)) {
+			Dash& dash = registry.dashes.get(entity);
+			dash.active_timer_ms = max(dash.active_timer_ms - elapsed_ms, 0.f);
+		}
+		if (!boss.activated || boss.type == BOSS_ID::BOSS_COUNT) continue;
+		// A dying boss has lost its gun and stops attacking
+		if (!registry.guns.has(entity)) continue;
+
+		const BehaviourProgram& program = behaviours.get(boss.type);
+		// One stream per boss per tick, shared by all tracks so each roll is a fresh draw
+		RandomStream rng = registry.random.stream(RNG_STREAM_ID::AI_BEHAVIOUR, entity);
+		for (uint track = 0; track < program.track_entries.size(); track++) {
+			run_behaviour_track(entity, boss, program, track, elapsed_ms, rng);
+		}
 	}
 }
 
-void AISystem::enemy_dash(float elapsed_ms) {
-	vec2 playerposition = registry.transforms.get(player).position;
-	for (Entity entity : registry.dashes.entities) {
-		Transform enemyTransform = registry.transforms.get(entity);
-		if (registry.enemies.has(entity) && registry.bosses.has(entity) && registry.bosses.get(entity).activated) {
-			Enemy& enemyAttrib = registry.enemies.get(entity);
-			Dash& enemyDash = registry.dashes.get(entity);
-			
-			if (enemyDash.delay_timer_ms <= 0.f) {
-				// setup a new dash
-				Motion& enemymotion = registry.motions.get(entity);
-				float currAngle = enemyTransform.angle - enemyTransform.angle_offset;
-				vec2 targetDiff = playerposition - enemyTransform.position;
-				float targetAngle = atan2f(targetDiff.y, targetDiff.x);
-				float distance = length(targetDiff) - length(enemyTransform.scale) - 100.f;
-				float angleRemaining = fabs(targetAngle - currAngle);
-				float dashVelocity; vec2 dashDirection;
-				if (distance < 300.f && enemyAttrib.type == ENEMY_ID::FRIENDBOSS) {
-					// Dashing around the player
-					float decision = (static_cast<float>(rand()) / RAND_MAX); //This generates num between 0 and 1
-					float rightOrleft = decision < 0.5 ? M_PI / 2.f : -M_PI / 2.f;
-					dashDirection = normalize(vec2(cos(currAngle + rightOrleft), sin(currAngle + rightOrleft)));
-					dashVelocity = enemyDash.max_dash_velocity;
-				}
-				else if (angleRemaining <= M_PI / 9.f || angleRemaining - M_PI < ANGLE_PRECISION) {
-					// Dashing towards the player
-					dashDirection = normalize(vec2(cos(currAngle), sin(currAngle)));
-					// Do not pass the player
-					if (enemyDash.max_dash_velocity * enemyDash.active_duration_ms / 1000.f > distance) {
-						dashVelocity = distance / (enemyDash.active_duration_ms / 1000.f);
-					}
-					else {
-						dashVelocity = enemyDash.max_dash_velocity;
-					}
-					
-				} else {
-					return;	// Do not dash
-				}
-				enemymotion.velocity += dashVelocity * dashDirection;
-				enemyDash.delay_timer_ms = enemyDash.delay_duration_ms;
-				enemyDash.active_timer_ms = enemyDash.active_duration_ms;
+void AISystem::run_behaviour_track(Entity entity, Boss& boss, const BehaviourProgram& program, uint track, float elapsed_ms, RandomStream& rng) {
+	float& wait_ms = boss.wait_ms[track];
+	if (wait_ms > 0.f) {
+		wait_ms = max(wait_ms - elapsed_ms, 0.f);
+		return;
+	}
+
+	const BehaviourInstruction* code = &program.code[program.track_entries[track]];
+	uint& pc = boss.pc[track];
+	// Bounded so a track without waits cannot stall the frame
+	for (int steps = 0; steps < MAX_BEHAVIOUR_STEPS; steps++) {
+		const BehaviourInstruction& inst = code[pc++];
+		switch (inst.op) {
+		case BEHAVIOUR_OP::REQUIRE_VISIBLE:
+			if (!is_on_screen(registry.transforms.get(player).position, registry.transforms.get(entity))) {
+				pc--;
+				return;
 			}
-			else {
-				enemyDash.delay_timer_ms = max(enemyDash.delay_timer_ms - elapsed_ms, 0.f);
-				enemyDash.active_timer_ms = max(enemyDash.active_timer_ms - elapsed_ms, 0.f);
+			break;
+		case BEHAVIOUR_OP::REQUIRE_FACING_PLAYER: {
+			Transform& transform = registry.transforms.get(entity);
+			vec2 targetDiff = registry.transforms.get(player).position - transform.position;
+			float angleRemaining = fabs(atan2f(targetDiff.y, targetDiff.x) - (transform.angle - transform.angle_offset));
+			if (!(angleRemaining <= inst.a || angleRemaining - M_PI < ANGLE_PRECISION)) {
+				pc--;
+				return;
 			}
+			break;
+		}
+		case BEHAVIOUR_OP::IF_PLAYER_WITHIN: {
+			Transform& transform = registry.transforms.get(entity);
+			float distance = length(registry.transforms.get(player).position - transform.position) - length(transform.scale) - 100.f;
+			if (distance >= inst.a) pc = inst.jump;
+			break;
+		}
+		case BEHAVIOUR_OP::CHANCE:
+			if (rng.uniform() > inst.a) pc = inst.jump;
+			break;
+		case BEHAVIOUR_OP::GOTO:
+			pc = inst.jump;
+			break;
+		case BEHAVIOUR_OP::WAIT:
+			wait_ms = inst.a;
+			return;
+		case BEHAVIOUR_OP::WAIT_GUN:
+			wait_ms = registry.guns.get(entity).attack_delay;
+			return;
+		case BEHAVIOUR_OP::WAIT_DASH:
+			wait_ms = registry.dashes.get(entity).delay_duration_ms;
+			return;
+		case BEHAVIOUR_OP::SHOOT: {
+			Gun& gun = registry.guns.get(entity);
+			createBullet(registry, entity, gun.bullet_size, gun.bullet_color);
+			break;
+		}
+		case BEHAVIOUR_OP::EMIT: {
+			Gun& gun = registry.guns.get(entity);
+			const BehaviourEmit& emit = program.emits[(uint)inst.a];
+			vec2 size = emit.bullet_size != vec2(0.f) ? emit.bullet_size : gun.bullet_size;
+			vec4 color = emit.bullet_color.a > 0.f ? emit.bullet_color : gun.bullet_color;
+			createBulletPattern(registry, entity, emit.pattern, size, color);
+			break;
+		}
+		case BEHAVIOUR_OP::CLONES:
+			clone_attack(entity, (int)inst.a, inst.b);
+			break;
+		case BEHAVIOUR_OP::DASH_TOWARDS_PLAYER:
+		case BEHAVIOUR_OP::DASH_AROUND_PLAYER:
+			boss_dash(entity, inst.op == BEHAVIOUR_OP::DASH_AROUND_PLAYER, rng);
+			break;
+		case BEHAVIOUR_OP::LOOP:
+			pc = 0;
+			break;
+		default:
+			assert(false && "Unhandled behaviour op");
+			break;
 		}
 	}
-
 }
 
+void AISystem::boss_dash(Entity entity, bool around_player, RandomStream& rng) {
+	Transform& enemyTransform = registry.transforms.get(entity);
+	Motion& enemymotion = registry.motions.get(entity);
+	Dash& enemyDash = registry.dashes.get(entity);
 
-void AISystem::enemy_special_attack(Entity enemy) {
-	Transform& enemytransform = registry.transforms.get(enemy);
-	Transform& playertransform = registry.transforms.get(player);
-
-	float decision = (static_cast<float>(rand()) / RAND_MAX); //This generates num between 0 and 1
-
-	if (decision <= 0.9f){ //90% of the time the boss will scattershot
-		spread_attack(enemy);
+	float currAngle = enemyTransform.angle - enemyTransform.angle_offset;
+	vec2 targetDiff = registry.transforms.get(player).position - enemyTransform.position;
+	float distance = length(targetDiff) - length(enemyTransform.scale) - 100.f;
+	float dashVelocity; vec2 dashDirection;
+	if (around_player) {
+		// Dashing around the player
+		float rightOrleft = rng.uniform() < 0.5 ? M_PI / 2.f : -M_PI / 2.f;
+		dashDirection = normalize(vec2(cos(currAngle + rightOrleft), sin(currAngle + rightOrleft)));
+		dashVelocity = enemyDash.max_dash_velocity;
 	}
 	else {
-		clone_attack(enemy, 5);
-	}
-}
-
-void AISystem::spread_attack(Entity enemy) {
-	Transform& enemytransform = registry.transforms.get(enemy);
-
-	for (int i = 0; i < 6; i++) {
-		enemytransform.angle += 1;
-		createBullet(enemy, { 13.f, 13.f }, { 1.f, 0.8f, 0.8f, 1.f });
+		// Dashing towards the player
+		dashDirection = normalize(vec2(cos(currAngle), sin(currAngle)));
+		// Do not pass the player
+		if (enemyDash.max_dash_velocity * enemyDash.active_duration_ms / 1000.f > distance) {
+			dashVelocity = distance / (enemyDash.active_duration_ms / 1000.f);
+		}
+		else {
+			dashVelocity = enemyDash.max_dash_velocity;
+		}
 	}
-
+	enemymotion.velocity += dashVelocity * dashDirection;
+	enemyDash.active_timer_ms = enemyDash.active_duration_ms;
 }
 
-void AISystem::clone_attack(Entity enemy, int clones) {
-	Transform& playertransform = registry.transforms.get(player);
-	
+void AISystem::clone_attack(Entity enemy, int clones, float distance) {
 	for (int i = 0; i < clones; i++) {
+		Transform& playertransform = registry.transforms.get(player);
 		playertransform.angle += 1;
-		float xpos = playertransform.position.x + cos(playertransform.angle) * 800;
-		float ypos = playertransform.position.y + sin(playertransform.angle) * 800;
-		createBossClone({ xpos,ypos });
+		float xpos = playertransform.position.x + cos(playertransform.angle) * distance;
+		float ypos = playertransform.position.y + sin(playertransform.angle) * distance;
+		createBossClone(registry, { xpos,ypos });
 
 	}
 
@@ -4,23 +4,33 @@
 
 #include "tiny_ecs_registry.hpp"
 #include "common.hpp"
+#include "random_service.hpp"
 #include "world_init.hpp"
 #include "world_system.hpp"
+#include "boss_behaviour.hpp"
+#include "frame_context.hpp"
 
 class AISystem
 {
 public:
-	void step(float elapsed_ms);
+	AISystem(ECSRegistry& registry) : registry(registry) {}
+
+	// Loads and compiles boss behaviours, false if they can't be loaded
+	bool init();
+	void step(const FrameContext& frame);
 
 private:
+	ECSRegistry& registry;
 	Entity player; // Keep reference to player entity
+	BehaviourLibrary behaviours;
+	static const int MAX_BEHAVIOUR_STEPS = 16;	// Instructions a track may execute per frame
 	void move_enemies(float elapsed_ms);
 	void enemy_shoot(float elapsed_ms);
 	void move_articulated_part(float elapsed_seconds, Entity partEntity, Motion& partMotion, Transform& partTranform, Transform& playerTransform);
-	void enemy_dash(float elapsed_ms);
-	void enemy_special_attack(Entity enemy);
-	void spread_attack(Entity enemy);
-	void clone_attack(Entity enemy, int clones);
+	void step_boss_behaviours(float elapsed_ms);
+	void run_behaviour_track(Entity entity, Boss& boss, const BehaviourProgram& program, uint track, float elapsed_ms, RandomStream& rng);
+	void boss_dash(Entity entity, bool around_player, RandomStream& rng);
+	void clone_attack(Entity enemy, int clones, float distance);
 	void swarm_keep_distance(float elapsed_ms);
 	void swarm_block_interestpoint(float elapsed_ms);
 };
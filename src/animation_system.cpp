@@ -80,7 +80,7 @@ void RenderSystem::animationSys_step(float elapsed_ms) {
     }
 }
 
-void RenderSystem::animationSys_switchAnimation(Entity& entity, 
+void RenderSystem::animationSys_switchAnimation(ECSRegistry& registry, Entity& entity, 
     ANIMATION_FRAME_COUNT animationType,
     int update_period_ms) {
 
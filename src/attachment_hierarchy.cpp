@@ -0,0 +1,78 @@
+// internal
+#include "attachment_hierarchy.hpp"
+
+static const std::vector<Entity> no_children;
+
+Attachment& AttachmentContainer::attach(Entity child, Entity parent) {
+	Attachment attachment;
+	attachment.parent = parent;
+	Attachment& inserted = insert(child, attachment);
+
+	auto it = nodes.find(parent);
+	if (it == nodes.end()) {
+		it = nodes.insert({ parent, Node{ parent, {} } }).first;
+	}
+	it->second.children.push_back(child);
+	return inserted;
+}
+
+void AttachmentContainer::remove(Entity e) {
+	if (has(e)) {
+		auto it = nodes.find(get(e).parent);
+		if (it != nodes.end()) {
+			std::vector<Entity>& siblings = it->second.children;
+			for (uint i = 0; i < siblings.size(); i++) {
+				if ((unsigned int)siblings[i] == (unsigned int)e) {
+					siblings[i] = siblings.back();
+					siblings.pop_back();
+					break;
+				}
+			}
+			if (siblings.empty()) nodes.erase(it);
+		}
+	}
+	ComponentContainer<Attachment>::remove(e);
+}
+
+void AttachmentContainer::clear() {
+	nodes.clear();
+	ComponentContainer<Attachment>::clear();
+}
+
+std::unique_ptr<ContainerSnapshot> AttachmentContainer::create_snapshot() {
+	return std::unique_ptr<ContainerSnapshot>(new Snapshot());
+}
+
+void AttachmentContainer::save(ContainerSnapshot& snapshot) {
+	ComponentContainer<Attachment>::save(snapshot);
+	static_cast<Snapshot&>(snapshot).nodes = nodes;
+}
+
+void AttachmentContainer::restore(const ContainerSnapshot& snapshot) {
+	ComponentContainer<Attachment>::restore(snapshot);
+	// A copy keeps the iteration order, which collect_roots depends on
+	nodes = static_cast<const Snapshot&>(snapshot).nodes;
+}
+
+const std::vector<Entity>& AttachmentContainer::children_of(Entity parent) {
+	auto it = nodes.find(parent);
+	return it == nodes.end() ? no_children : it->second.children;
+}
+
+void AttachmentContainer::collect_subtree(Entity root, std::vector<Entity>& out) {
+	// out doubles as the traversal queue, which gives a breadth first (depth ordered) result
+	size_t next = out.size();
+	out.push_back(root);
+	while (next < out.size()) {
+		const std::vector<Entity>& children = children_of(out[next++]);
+		out.insert(out.end(), children.begin(), children.end());
+	}
+}
+
+void AttachmentContainer::collect_roots(std::vector<Entity>& out) {
+	for (auto& node : nodes) {
+		if (!has(node.second.parent)) {
+			out.push_back(node.second.parent);
+		}
+	}
+}
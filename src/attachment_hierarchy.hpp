@@ -0,0 +1,51 @@
+#pragma once
+
+// internal
+#include "tiny_ecs.hpp"
+#include "components.hpp"
+
+// stlib
+#include <unordered_map>
+#include <vector>
+
+// The attachment container, plus an index from every parent to its direct children so that
+// attachment trees (player gear, boss arms) can be walked and destroyed without scanning all
+// attachments. Attachments are added through attach() so the index knows the parent; the usual
+// remove/clear keep it up to date.
+class AttachmentContainer : public ComponentContainer<Attachment>
+{
+public:
+	Attachment& attach(Entity child, Entity parent);
+
+	void remove(Entity e);
+	void clear();
+
+	// The parent index is saved along with the attachments
+	std::unique_ptr<ContainerSnapshot> create_snapshot();
+	void save(ContainerSnapshot& snapshot);
+	void restore(const ContainerSnapshot& snapshot);
+
+	bool is_attached_to(Entity child, Entity parent) { return has(child) && get(child).parent == parent; }
+	// Direct children of an entity, empty if it has none
+	const std::vector<Entity>& children_of(Entity parent);
+	// Appends root and all its attachments, parents before their children
+	void collect_subtree(Entity root, std::vector<Entity>& out);
+	// Appends every entity that has attachments without being an attachment itself
+	void collect_roots(std::vector<Entity>& out);
+
+private:
+	// Must go through attach()
+	using ComponentContainer<Attachment>::insert;
+	using ComponentContainer<Attachment>::emplace;
+	using ComponentContainer<Attachment>::emplace_with_duplicates;
+
+	struct Node {
+		Entity parent;
+		std::vector<Entity> children;
+	};
+	std::unordered_map<unsigned int, Node> nodes;	// Keyed by the parent
+
+	struct Snapshot : ComponentContainer<Attachment>::Snapshot {
+		std::unordered_map<unsigned int, Node> nodes;
+	};
+};
@@ -0,0 +1,137 @@
+// internal
+#include "autoplay_bot.hpp"
+#include "random_service.hpp"
+#include "tiny_ecs_registry.hpp"
+
+const float BOT_TAP_INTERVAL_MS = 1000.f;		// Restarts after death
+const float BOT_WANDER_INTERVAL_MS = 8000.f;	// New wander point when there is no waypoint
+const float BOT_WANDER_RADIUS = 3000.f;
+const float BOT_CHEST_RANGE = 250.f;			// Walks onto unopened chests this close and holds interact
+const float BOT_ARRIVE_DISTANCE = 60.f;
+const float BOT_SHOOT_RANGE = 900.f;
+const float BOT_SLASH_RANGE = 150.f;
+const float BOT_THREAT_RANGE = 300.f;			// Bullets closer than this and heading at the player are dodged
+const float BOT_AIM_DISTANCE = 300.f;			// Cursor distance from the screen center
+
+void AutoplayBot::step(ECSRegistry& registry, const FrameContext& frame, std::vector<InputEvent>& events) {
+	played_ms += frame.elapsed_ms;
+	wander_timer_ms -= frame.elapsed_ms;
+
+	// Tap a key now and then, restarts the game once the death screen is up
+	tap_timer_ms -= frame.elapsed_ms;
+	bool tap = tap_timer_ms <= 0.f;
+	if (tap) tap_timer_ms = BOT_TAP_INTERVAL_MS;
+	set_key(GLFW_KEY_ENTER, tap, events);
+
+	if (!frame.has_player || registry.deathTimers.has(frame.player)) {
+		// Let go of everything while dead
+		for (int key : { GLFW_KEY_W, GLFW_KEY_A, GLFW_KEY_S, GLFW_KEY_D, GLFW_KEY_SPACE, GLFW_KEY_LEFT_SHIFT }) {
+			set_key(key, false, events);
+		}
+		set_mouse_button(GLFW_MOUSE_BUTTON_LEFT, false, events);
+		set_mouse_button(GLFW_MOUSE_BUTTON_RIGHT, false, events);
+		return;
+	}
+	vec2 player_position = registry.transforms.get(frame.player).position;
+
+	// Movement: dodge incoming bullets first, otherwise head for a chest or the nearest waypoint
+	vec2 direction = { 0.f, 0.f };
+	bool dash = false;
+	bool interact = false;
+	vec2 bullet_velocity;
+	if (policy != AUTOPLAY_POLICY::NO_DODGE && find_threat(registry, player_position, bullet_velocity)) {
+		direction = normalize(vec2(-bullet_velocity.y, bullet_velocity.x));
+		dash = true;
+	}
+	else {
+		vec2 destination = pick_destination(registry, player_position);
+		for (uint i = 0; i < registry.chests.size(); i++) {
+			Entity chest_entity = registry.chests.entities[i];
+			if (registry.chests.components[i].isOpened || !registry.transforms.has(chest_entity)) continue;
+			vec2 chest_position = registry.transforms.get(chest_entity).position;
+			if (distance(chest_position, player_position) < BOT_CHEST_RANGE) {
+				destination = chest_position;
+				interact = true;
+				break;
+			}
+		}
+		vec2 offset = destination - player_position;
+		if (length(offset) > BOT_ARRIVE_DISTANCE) direction = normalize(offset);
+	}
+	set_key(GLFW_KEY_D, direction.x > 0.3f, events);
+	set_key(GLFW_KEY_A, direction.x < -0.3f, events);
+	set_key(GLFW_KEY_W, direction.y > 0.3f, events);
+	set_key(GLFW_KEY_S, direction.y < -0.3f, events);
+	set_key(GLFW_KEY_LEFT_SHIFT, dash, events);
+	set_key(GLFW_KEY_SPACE, interact, events);
+
+	// Aim at the nearest enemy and shoot it, slash when it gets close
+	float nearest = BOT_SHOOT_RANGE;
+	vec2 aim = { 0.f, 0.f };
+	for (Entity enemy : registry.enemies.entities) {
+		if (!registry.transforms.has(enemy) || registry.deathTimers.has(enemy)) continue;
+		vec2 offset = registry.transforms.get(enemy).position - player_position;
+		float enemy_distance = length(offset);
+		if (enemy_distance < nearest) {
+			nearest = enemy_distance;
+			aim = offset;
+		}
+	}
+	bool has_target = nearest < BOT_SHOOT_RANGE;
+	if (has_target && length(aim) > 0.f) {
+		// Window coordinates, on_mouse_move aims from the screen center where the player is
+		vec2 cursor = normalize(aim) * BOT_AIM_DISTANCE;
+		events.push_back(InputEvent::cursor_move({ CONTENT_WIDTH_PX / 2.f + cursor.x, CONTENT_HEIGHT_PX / 2.f - cursor.y }));
+	}
+	set_mouse_button(GLFW_MOUSE_BUTTON_LEFT, has_target && policy != AUTOPLAY_POLICY::MELEE, events);
+	set_mouse_button(GLFW_MOUSE_BUTTON_RIGHT, has_target && nearest < BOT_SLASH_RANGE, events);
+}
+
+vec2 AutoplayBot::pick_destination(ECSRegistry& registry, vec2 player_position) {
+	float nearest = INFINITY;
+	vec2 destination = player_position;
+	for (const Waypoint& waypoint : registry.waypoints.components) {
+		float waypoint_distance = distance(waypoint.interest_point, player_position);
+		if (waypoint_distance < nearest) {
+			nearest = waypoint_distance;
+			destination = waypoint.interest_point;
+		}
+	}
+	if (nearest < INFINITY) return destination;
+
+	// Nothing to go for, roam around the map
+	if (wander_timer_ms <= 0.f || distance(wander_point, player_position) < BOT_ARRIVE_DISTANCE) {
+		RandomStream rng = registry.random.stream(RNG_STREAM_ID::AUTOPLAY);
+		float angle = rng.uniform(0.f, 2 * M_PI);
+		wander_point = rng.uniform(0.f, BOT_WANDER_RADIUS) * vec2(cosf(angle), sinf(angle));
+		wander_timer_ms = BOT_WANDER_INTERVAL_MS;
+	}
+	return wander_point;
+}
+
+bool AutoplayBot::find_threat(ECSRegistry& registry, vec2 player_position, vec2& bullet_velocity) const {
+	const ProjectilePool& projectiles = registry.projectiles;
+	float nearest = BOT_THREAT_RANGE;
+	for (uint i = 0; i < projectiles.size(); i++) {
+		if (!(projectiles.teams[i] & PROJECTILE_HITS_PLAYERS) || !projectiles.is_alive(i)) continue;
+		vec2 to_player = player_position - projectiles.positions[i];
+		float bullet_distance = length(to_player);
+		if (bullet_distance < nearest && dot(to_player, projectiles.velocities[i]) > 0.f) {
+			nearest = bullet_distance;
+			bullet_velocity = projectiles.velocities[i];
+		}
+	}
+	return nearest < BOT_THREAT_RANGE && length(bullet_velocity) > 0.f;
+}
+
+void AutoplayBot::set_key(int key, bool down, std::vector<InputEvent>& events) {
+	if (keys_down[key] == down) return;
+	keys_down[key] = down;
+	events.push_back(InputEvent::key(key, down ? GLFW_PRESS : GLFW_RELEASE, 0));
+}
+
+void AutoplayBot::set_mouse_button(int button, bool down, std::vector<InputEvent>& events) {
+	if (mouse_buttons_down[button] == down) return;
+	mouse_buttons_down[button] = down;
+	events.push_back(InputEvent::mouse_button(button, down ? GLFW_PRESS : GLFW_RELEASE, 0));
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "frame_context.hpp"
+#include "input_recording.hpp"
+
+// stlib
+#include <vector>
+
+// How the bot plays, so runs can be compared across play styles
+enum class AUTOPLAY_POLICY {
+	FULL = 0,				// Shoots, slashes and dodges
+	NO_DODGE = FULL + 1,	// Never sidesteps or dashes away from bullets
+	MELEE = NO_DODGE + 1,	// Only slashes, never shoots
+	AUTOPLAY_POLICY_COUNT = MELEE + 1
+};
+const int autoplay_policy_count = (int)AUTOPLAY_POLICY::AUTOPLAY_POLICY_COUNT;
+const char* const autoplay_policy_names[autoplay_policy_count] = { "full", "no_dodge", "melee" };
+
+// Plays the game through the regular input path for unattended soak tests. Every tick it emits the
+// key, mouse and cursor events a player would: steer towards the nearest waypoint, hold interact at
+// unopened chests, aim and shoot at the nearest enemy, and sidestep (and dash) away from incoming
+// bullets. It periodically taps a key, which restarts the game after death.
+class AutoplayBot
+{
+public:
+	// Stops after duration_ms of simulated time, 0 plays forever
+	AutoplayBot(float duration_ms = 0.f, AUTOPLAY_POLICY policy = AUTOPLAY_POLICY::FULL) : duration_ms(duration_ms), policy(policy) {}
+
+	// Appends this tick's input to events, to be passed to WorldSystem::handle_input_event
+	void step(ECSRegistry& registry, const FrameContext& frame, std::vector<InputEvent>& events);
+	bool is_finished() const { return duration_ms > 0.f && played_ms >= duration_ms; }
+
+private:
+	void set_key(int key, bool down, std::vector<InputEvent>& events);
+	void set_mouse_button(int button, bool down, std::vector<InputEvent>& events);
+	vec2 pick_destination(ECSRegistry& registry, vec2 player_position);
+	bool find_threat(ECSRegistry& registry, vec2 player_position, vec2& bullet_velocity) const;
+
+	float duration_ms;
+	AUTOPLAY_POLICY policy;
+	float played_ms = 0.f;
+	float tap_timer_ms = 0.f;
+	float wander_timer_ms = 0.f;
+	vec2 wander_point = { 0.f, 0.f };
+	bool keys_down[GLFW_KEY_LAST + 1] = {};
+	bool mouse_buttons_down[GLFW_MOUSE_BUTTON_LAST + 1] = {};
+};
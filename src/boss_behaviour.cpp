@@ -0,0 +1,215 @@
+// internal
+#include "boss_behaviour.hpp"
+
+// stlib
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+static const std::unordered_map<std::string, BOSS_ID> boss_names = {
+	{ "bacteriophage", BOSS_ID::BACTERIOPHAGE },
+	{ "friend", BOSS_ID::FRIEND }
+};
+
+static const std::unordered_map<std::string, BEHAVIOUR_OP> op_names = {
+	{ "require_visible", BEHAVIOUR_OP::REQUIRE_VISIBLE },
+	{ "require_facing_player", BEHAVIOUR_OP::REQUIRE_FACING_PLAYER },
+	{ "if_player_within", BEHAVIOUR_OP::IF_PLAYER_WITHIN },
+	{ "chance", BEHAVIOUR_OP::CHANCE },
+	{ "goto", BEHAVIOUR_OP::GOTO },
+	{ "wait", BEHAVIOUR_OP::WAIT },
+	{ "shoot", BEHAVIOUR_OP::SHOOT },
+	{ "emit", BEHAVIOUR_OP::EMIT },
+	{ "clones", BEHAVIOUR_OP::CLONES },
+	{ "dash_towards_player", BEHAVIOUR_OP::DASH_TOWARDS_PLAYER },
+	{ "dash_around_player", BEHAVIOUR_OP::DASH_AROUND_PLAYER }
+};
+
+static const std::unordered_map<std::string, BULLET_PATTERN_ID> pattern_names = {
+	{ "single", BULLET_PATTERN_ID::SINGLE },
+	{ "fan", BULLET_PATTERN_ID::FAN },
+	{ "ring", BULLET_PATTERN_ID::RING },
+	{ "spiral", BULLET_PATTERN_ID::SPIRAL },
+	{ "burst", BULLET_PATTERN_ID::BURST }
+};
+
+static vec2 read_curve(const json& step, const char* key, vec2 fallback = { 1.f, 1.f }) {
+	if (!step.contains(key)) return fallback;
+	const json& curve = step[key];
+	if (curve.is_number()) return vec2(curve.get<float>());
+	return { curve.at(0).get<float>(), curve.at(1).get<float>() };
+}
+
+bool BehaviourLibrary::load(const std::string& path) {
+	std::ifstream file(path);
+	if (!file) {
+		fprintf(stderr, "Failed to open behaviour file %s\n", path.c_str());
+		return false;
+	}
+
+	// Compiled aside, so a failed load leaves no half compiled program behind
+	BehaviourProgram compiled[boss_type_count];
+	try {
+		json behaviours;
+		file >> behaviours;
+		if (!compile(behaviours, compiled)) return false;
+	}
+	catch (const json::exception& e) {
+		fprintf(stderr, "Behaviour file %s: %s\n", path.c_str(), e.what());
+		return false;
+	}
+	for (int i = 0; i < boss_type_count; i++) {
+		programs[i] = std::move(compiled[i]);
+	}
+	return true;
+}
+
+bool BehaviourLibrary::compile(const json& behaviours, BehaviourProgram (&compiled)[boss_type_count]) {
+	for (auto& boss : behaviours.items()) {
+		auto it = boss_names.find(boss.key());
+		if (it == boss_names.end()) {
+			fprintf(stderr, "Behaviour: unknown boss %s\n", boss.key().c_str());
+			return false;
+		}
+		BehaviourProgram& program = compiled[(int)it->second];
+		program = BehaviourProgram();
+
+		const json& tracks = boss.value().at("tracks");
+		if (tracks.size() > MAX_BEHAVIOUR_TRACKS) {
+			fprintf(stderr, "Behaviour %s: too many tracks (%d max)\n", boss.key().c_str(), MAX_BEHAVIOUR_TRACKS);
+			return false;
+		}
+		for (auto& track : tracks.items()) {
+			if (!compile_track(boss.key(), track.key(), track.value(), program)) {
+				return false;
+			}
+		}
+		std::cout << "Compiled behaviour " << boss.key() << ": " << program.track_entries.size() << " tracks, "
+			<< program.code.size() << " instructions" << std::endl;
+	}
+	return true;
+}
+
+bool BehaviourLibrary::compile_track(const std::string& boss_name, const std::string& track_name, const json& steps, BehaviourProgram& program) {
+	// First pass: resolve labels to instruction indices relative to the track entry
+	std::unordered_map<std::string, uint> labels;
+	uint index = 0;
+	for (const json& step : steps) {
+		if (step.contains("op")) {
+			index++;
+		} else if (step.contains("label")) {
+			labels[step["label"].get<std::string>()] = index;
+		}
+	}
+
+	auto resolve = [&](const json& step, const char* key, uint& target) {
+		if (!step.contains(key)) {
+			fprintf(stderr, "Behaviour %s/%s: missing \"%s\"\n", boss_name.c_str(), track_name.c_str(), key);
+			return false;
+		}
+		auto it = labels.find(step[key].get<std::string>());
+		if (it == labels.end()) {
+			fprintf(stderr, "Behaviour %s/%s: unknown label %s\n", boss_name.c_str(), track_name.c_str(), step[key].get<std::string>().c_str());
+			return false;
+		}
+		target = it->second;
+		return true;
+	};
+
+	// Second pass: emit instructions
+	program.track_entries.push_back((uint)program.code.size());
+	for (const json& step : steps) {
+		if (!step.contains("op")) continue;
+
+		std::string name = step["op"].get<std::string>();
+		auto it = op_names.find(name);
+		if (it == op_names.end()) {
+			fprintf(stderr, "Behaviour %s/%s: unknown op %s\n", boss_name.c_str(), track_name.c_str(), name.c_str());
+			return false;
+		}
+
+		BehaviourInstruction inst;
+		inst.op = it->second;
+		switch (inst.op) {
+		case BEHAVIOUR_OP::REQUIRE_FACING_PLAYER:
+			inst.a = step.value("angle", (float)M_PI / 9.f);
+			break;
+		case BEHAVIOUR_OP::IF_PLAYER_WITHIN:
+			inst.a = step.value("distance", 0.f);
+			if (!resolve(step, "else", inst.jump)) return false;
+			break;
+		case BEHAVIOUR_OP::CHANCE:
+			inst.a = step.value("p", 0.5f);
+			if (!resolve(step, "else", inst.jump)) return false;
+			break;
+		case BEHAVIOUR_OP::GOTO:
+			if (!resolve(step, "to", inst.jump)) return false;
+			break;
+		case BEHAVIOUR_OP::WAIT:
+			// "timer" reads the delay from the boss components at run time so difficulty scaling still applies
+			if (step.contains("timer")) {
+				std::string timer = step["timer"].get<std::string>();
+				if (timer == "gun") {
+					inst.op = BEHAVIOUR_OP::WAIT_GUN;
+				} else if (timer == "dash") {
+					inst.op = BEHAVIOUR_OP::WAIT_DASH;
+				} else {
+					fprintf(stderr, "Behaviour %s/%s: unknown timer %s\n", boss_name.c_str(), track_name.c_str(), timer.c_str());
+					return false;
+				}
+			} else {
+				inst.a = step.value("ms", 0.f);
+			}
+			break;
+		case BEHAVIOUR_OP::EMIT: {
+			BehaviourEmit emit;
+			BulletPattern& pattern = emit.pattern;
+			std::string type = step.value("pattern", std::string("single"));
+			auto pattern_it = pattern_names.find(type);
+			if (pattern_it == pattern_names.end()) {
+				fprintf(stderr, "Behaviour %s/%s: unknown pattern %s\n", boss_name.c_str(), track_name.c_str(), type.c_str());
+				return false;
+			}
+			pattern.type = pattern_it->second;
+			// Signed, so a negative count is caught instead of wrapping around
+			int count = step.value("count", 1);
+			if (count <= 0) {
+				fprintf(stderr, "Behaviour %s/%s: pattern with no bullets\n", boss_name.c_str(), track_name.c_str());
+				return false;
+			}
+			pattern.count = (uint)count;
+			pattern.spread = step.value("spread", 0.f);
+			pattern.angle_offset = step.value("angle_offset", 0.f);
+			pattern.speed_curve = read_curve(step, "speed", pattern.type == BULLET_PATTERN_ID::BURST ? BURST_SPEED_CURVE : vec2(1.f));
+			pattern.size_curve = read_curve(step, "size");
+			if (pattern.type == BULLET_PATTERN_ID::BURST && pattern.count > 1 && pattern.speed_curve.x == pattern.speed_curve.y) {
+				fprintf(stderr, "Behaviour %s/%s: bullets of a burst need different speeds\n", boss_name.c_str(), track_name.c_str());
+				return false;
+			}
+			if (step.contains("bullet_size")) {
+				const json& size = step["bullet_size"];
+				emit.bullet_size = { size.at(0).get<float>(), size.at(1).get<float>() };
+			}
+			if (step.contains("bullet_color")) {
+				const json& color = step["bullet_color"];
+				emit.bullet_color = { color.at(0).get<float>(), color.at(1).get<float>(), color.at(2).get<float>(), color.at(3).get<float>() };
+			}
+			inst.a = (float)program.emits.size();
+			program.emits.push_back(emit);
+			break;
+		}
+		case BEHAVIOUR_OP::CLONES:
+			inst.a = step.value("count", 5.f);
+			inst.b = step.value("distance", 800.f);
+			break;
+		default:
+			break;
+		}
+		program.code.push_back(inst);
+	}
+
+	BehaviourInstruction loop;
+	loop.op = BEHAVIOUR_OP::LOOP;
+	program.code.push_back(loop);
+	return true;
+}
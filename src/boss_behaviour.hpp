@@ -0,0 +1,68 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "components.hpp"
+#include "world_init.hpp"
+
+// stlib
+#include <string>
+#include <vector>
+
+// Boss behaviours are authored in data/behaviours/*.json and compiled at load time into a
+// flat instruction array per boss. Each behaviour has up to MAX_BEHAVIOUR_TRACKS tracks that
+// run side by side; a track executes until it hits a wait or an unmet requirement, and loops
+// back to its first instruction when it reaches the end.
+enum class BEHAVIOUR_OP {
+	REQUIRE_VISIBLE = 0,							// Yield until the boss is at least partially on screen
+	REQUIRE_FACING_PLAYER = REQUIRE_VISIBLE + 1,	// Yield until facing the player (a: max angle in radians)
+	IF_PLAYER_WITHIN = REQUIRE_FACING_PLAYER + 1,	// Jump unless the gap to the player is below a
+	CHANCE = IF_PLAYER_WITHIN + 1,					// Jump unless a random roll is below a
+	GOTO = CHANCE + 1,
+	WAIT = GOTO + 1,								// Wait a milliseconds
+	WAIT_GUN = WAIT + 1,							// Wait Gun::attack_delay
+	WAIT_DASH = WAIT_GUN + 1,						// Wait Dash::delay_duration_ms
+	SHOOT = WAIT_DASH + 1,							// Fire the boss gun
+	EMIT = SHOOT + 1,								// Fire emit number a of the program
+	CLONES = EMIT + 1,								// Spawn a clones at distance b around the player
+	DASH_TOWARDS_PLAYER = CLONES + 1,
+	DASH_AROUND_PLAYER = DASH_TOWARDS_PLAYER + 1,
+	LOOP = DASH_AROUND_PLAYER + 1,					// Emitted at the end of every track
+	BEHAVIOUR_OP_COUNT = LOOP + 1
+};
+
+struct BehaviourInstruction {
+	BEHAVIOUR_OP op = BEHAVIOUR_OP::LOOP;
+	float a = 0.f;
+	float b = 0.f;
+	uint jump = 0;		// Branch target, relative to the track entry
+};
+
+// A bullet pattern of a program and the look of its bullets
+struct BehaviourEmit {
+	BulletPattern pattern;
+	vec2 bullet_size = { 0.f, 0.f };			// The gun's when zero
+	vec4 bullet_color = { 0.f, 0.f, 0.f, 0.f };	// The gun's when fully transparent
+};
+
+struct BehaviourProgram {
+	std::vector<BehaviourInstruction> code;
+	std::vector<uint> track_entries;	// Index of the first instruction of each track
+	std::vector<BehaviourEmit> emits;	// Referenced by EMIT
+};
+
+// Compiled programs for every BOSS_ID
+class BehaviourLibrary
+{
+public:
+	// Parses and compiles the behaviour file. Returns false on any error, including malformed JSON,
+	// and keeps the programs it had in that case.
+	bool load(const std::string& path);
+	const BehaviourProgram& get(BOSS_ID id) const { return programs[(int)id]; }
+
+private:
+	BehaviourProgram programs[boss_type_count];
+
+	bool compile(const json& behaviours, BehaviourProgram (&compiled)[boss_type_count]);
+	bool compile_track(const std::string& boss_name, const std::string& track_name, const json& steps, BehaviourProgram& program);
+};
@@ -21,6 +21,13 @@ void Transformation::translate(vec2 offset)
 	mat = mat * T;
 }
 
+mat3 model_matrix(vec2 position, float angle, vec2 scale)
+{
+	float c = cosf(angle);
+	float s = sinf(angle);
+	return { { c * scale.x, s * scale.x, 0.f },{ -s * scale.y, c * scale.y, 0.f },{ position.x, position.y, 1.f } };
+}
+
 bool gl_has_errors()
 {
 	GLenum error = glGetError();
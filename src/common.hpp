@@ -32,6 +32,8 @@ inline std::string shader_path(const std::string& name) {return std::string(PROJ
 inline std::string textures_path(const std::string& name) {return data_path() + "/textures/" + std::string(name);};
 inline std::string audio_path(const std::string& name) {return data_path() + "/audio/" + std::string(name);};
 inline std::string mesh_path(const std::string& name) {return data_path() + "/meshes/" + std::string(name);};
+inline std::string behaviour_path(const std::string& name) {return data_path() + "/behaviours/" + std::string(name);};
+inline std::string prefab_path(const std::string& name) {return data_path() + "/prefabs/" + std::string(name);};
 
 
 #ifndef M_PI
@@ -48,6 +50,9 @@ struct Transformation {
 	void translate(vec2 offset);
 };
 
+// Same matrix as translate(position), rotate(angle), scale(scale) from the identity, without the matrix products
+mat3 model_matrix(vec2 position, float angle, vec2 scale);
+
 bool gl_has_errors();
 
 // Game configuration
@@ -71,6 +76,7 @@ const float DEATH_EFFECT_DURATION_ENEMY = 250.f;
 const float PLAYER_ATTACK_DELAY = 300.f;
 const float PLAYER_SWORD_ATTACK_DELAY = 500.f;
 const float PLAYER_DASH_DELAY = 800.f;
+const float AUTOSAVE_INTERVAL_MS = 60000.f;
 const float BOSS_MAX_VELOCITY = 250.f;
 const float FRIEND_BOSS_MAX_VELOCITY = 350.f;
 const float FRIEND_BOSS_DIFFICULTY = 1.0f;	// 1 : normal | <1 : easy | >1 : hard
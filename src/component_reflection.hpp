@@ -0,0 +1,117 @@
+#pragma once
+
+// internal
+#include "reflection.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// Field lists of the components that make up a world, see reflection.hpp. Every field has to be
+// listed for the JSON form to be complete; the binary form copies trivially copyable components whole.
+REFLECT_COMPONENT(Game, "game", isFirstBossDefeated, isCureObtained, isSecondBossDefeated, isCystTutorialDisplayed)
+REFLECT_TAG(Player, "players")
+REFLECT_COMPONENT(Enemy, "enemies", type, sword_attack_cd, region)
+REFLECT_COMPONENT(Transform, "transforms", position, scale, angle, is_screen_coord, angle_offset, world)
+REFLECT_COMPONENT(Motion, "motions", velocity, angular_velocity, force, max_velocity, max_angular_velocity,
+	acceleration_unit, deceleration_unit, allow_accel)
+REFLECT_COMPONENT(Attachment, "attachments", type, parent, relative_transform_1, moved_angle, relative_transform_2,
+	angle_offset, angle_freedom)
+REFLECT_COMPONENT(PlayerAbility, "playerAbilities", id)
+REFLECT_COMPONENT(DeathTimer, "deathTimers", timer_ms)
+REFLECT_COMPONENT(RenderRequest, "renderRequests", used_texture, used_effect, used_geometry, order)
+REFLECT_COMPONENT(vec4, "colors", x, y, z, w)
+REFLECT_COMPONENT(Region, "regions", theme, goal, enemy, boss, is_cleared, interest_point)
+REFLECT_COMPONENT(Chest, "chests", ability, isOpened, position, waveActivated)
+REFLECT_TAG(Cure, "cure")
+REFLECT_COMPONENT(Health, "healthValues", health, maxHealth, healthIncrement, healthMultiplier)
+REFLECT_COMPONENT(Healthbar, "healthbar", previous_health, timer_ms, full_health_color)
+REFLECT_COMPONENT(Invincibility, "invincibility", timer_ms)
+REFLECT_COMPONENT(Animation, "animations", total_frame, curr_frame, timer_ms, update_period_ms, pause_animation, loop_interval)
+REFLECT_COMPONENT(Dash, "dashes", delay_duration_ms, delay_timer_ms, active_duration_ms, active_timer_ms, max_dash_velocity)
+REFLECT_COMPONENT(Cyst, "cysts", health, sword_attack_cd)
+REFLECT_TAG(CollidePlayer, "collidePlayers")
+REFLECT_TAG(CollideEnemy, "collideEnemies")
+REFLECT_COMPONENT(Gun, "guns", damage, attack_timer, attack_delay, angle_offset, bullet_speed, bullet_color, bullet_size, offset)
+REFLECT_COMPONENT(Melee, "melees", melee_entity, damage, attack_timer, animation_timer, attack_delay)
+REFLECT_COMPONENT(Waypoint, "waypoints", target, goal, interest_point, icon_scale)
+REFLECT_COMPONENT(Boss, "bosses", activated, type, pc, wait_ms)
+REFLECT_COMPONENT(GameMode, "gameMode", id, max_green, max_red, max_yellow, enemy_health_map, FRIEND_BOSS_DIFFICULTY)
+REFLECT_TAG(TripleBullets, "tripleBullets")
+REFLECT_TAG(LotsOfBullets, "lotsOfBullets")
+
+// Mesh pointers are saved as the geometry they point into, -1 when they point elsewhere
+struct MeshRef {
+	int32_t geometry = -1;
+};
+REFLECT_COMPONENT(MeshRef, "meshPtrs", geometry)
+
+// The containers a world snapshot holds, in restore order: transforms come first since the enemy
+// insert hook reads them.
+template <typename Visitor>
+constexpr void for_each_world_container(Visitor&& visitor)
+{
+	visitor(&ECSRegistry::transforms);
+	visitor(&ECSRegistry::game);
+	visitor(&ECSRegistry::gameMode);
+	visitor(&ECSRegistry::players);
+	visitor(&ECSRegistry::motions);
+	visitor(&ECSRegistry::meshPtrs);
+	visitor(&ECSRegistry::renderRequests);
+	visitor(&ECSRegistry::colors);
+	visitor(&ECSRegistry::regions);
+	visitor(&ECSRegistry::chests);
+	visitor(&ECSRegistry::cure);
+	visitor(&ECSRegistry::healthValues);
+	visitor(&ECSRegistry::healthbar);
+	visitor(&ECSRegistry::guns);
+	visitor(&ECSRegistry::invincibility);
+	visitor(&ECSRegistry::dashes);
+	visitor(&ECSRegistry::animations);
+	visitor(&ECSRegistry::collidePlayers);
+	visitor(&ECSRegistry::collideEnemies);
+	visitor(&ECSRegistry::cysts);
+	visitor(&ECSRegistry::melees);
+	visitor(&ECSRegistry::waypoints);
+	visitor(&ECSRegistry::bosses);
+	visitor(&ECSRegistry::playerAbilities);
+	visitor(&ECSRegistry::deathTimers);
+	visitor(&ECSRegistry::enemies);
+	visitor(&ECSRegistry::attachments);
+	visitor(&ECSRegistry::tripleBullets);
+	visitor(&ECSRegistry::lotsOfBullets);
+}
+
+// The containers that are not part of a world: screen, menu, debug and camera state, and the
+// distance rings, which SpawnManager::track rebuilds
+template <typename Visitor>
+constexpr void for_each_non_world_container(Visitor&& visitor)
+{
+	visitor(&ECSRegistry::screenStates);
+	visitor(&ECSRegistry::debugComponents);
+	visitor(&ECSRegistry::camera);
+	visitor(&ECSRegistry::menuElems);
+	visitor(&ECSRegistry::menuButtons);
+	visitor(&ECSRegistry::distanceRings);
+	visitor(&ECSRegistry::credits);
+}
+
+struct ContainerCounter {
+	int count = 0;
+	template <typename Member>
+	constexpr void operator()(Member) { count++; }
+};
+
+constexpr int world_container_count() {
+	ContainerCounter counter;
+	for_each_world_container(counter);
+	for_each_non_world_container(counter);
+	return counter.count;
+}
+
+constexpr int registry_container_count() {
+	ContainerCounter counter;
+	ECSRegistry::for_each_container(counter);
+	return counter.count;
+}
+
+// A container in neither list would silently drop out of save games
+static_assert(world_container_count() == registry_container_count(),
+	"Every ECSRegistry container goes into for_each_world_container or for_each_non_world_container");
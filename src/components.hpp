@@ -62,8 +62,10 @@ enum class COLLISION_TYPE {
 	BULLET_WITH_BOUNDARY = BULLET_WITH_BULLET + 1,
 	BULLET_WITH_CYST = BULLET_WITH_BOUNDARY + 1,
 	SWORD_WITH_ENEMY = BULLET_WITH_CYST + 1,
-	SWORD_WITH_CYST = SWORD_WITH_ENEMY + 1
+	SWORD_WITH_CYST = SWORD_WITH_ENEMY + 1,
+	COLLISION_TYPE_COUNT = SWORD_WITH_CYST + 1
 };
+const int collision_type_count = (int)COLLISION_TYPE::COLLISION_TYPE_COUNT;
 
 enum class CYST_EFFECT_ID {
 	// POSITIVE EFFECTS
@@ -83,6 +85,17 @@ enum class CYST_EFFECT_ID {
 const int cyst_effect_count = static_cast<int>(CYST_EFFECT_ID::EFFECT_COUNT);
 const int cyst_neg_start = static_cast<int>(CYST_EFFECT_ID::SLOW);
 
+// Delayed changes to the world, see WorldSystem::schedule_event
+enum class TIMED_EVENT_ID {
+	CAMERA_SHAKE_END = 0,						// values[0]: the shake amount
+	SQUISH_END = CAMERA_SHAKE_END + 1,			// values[0]: the squish amount
+	CHEST_WAVE_END = SQUISH_END + 1,			// entity is the chest
+	CHEST_REARM = CHEST_WAVE_END + 1,			// entity is the chest
+	EFFECT_END = CHEST_REARM + 1,				// entity is the effect icon, see EffectsSystem::end_effect
+	TIMED_EVENT_COUNT = EFFECT_END + 1
+};
+const int timed_event_count = (int)TIMED_EVENT_ID::TIMED_EVENT_COUNT;
+
 enum class GAME_STATE {
 	START_MENU = 0,
 	PAUSE_MENU = START_MENU + 1,
@@ -407,6 +420,7 @@ struct Camera {
 struct Enemy {
 	ENEMY_ID type;
 	float sword_attack_cd = 0.f;
+	int region = 0;	// Region the enemy is counted in by PopulationIndex, the one it spawned in
 };
 
 // Data relevant to the shape of entities
@@ -416,6 +430,10 @@ struct Transform {
 	float angle = 0.f;
 	bool is_screen_coord = false;
 	float angle_offset = 0.f;
+	// Model matrix used by rendering and mesh collision. Rebuilt by PhysicsSystem whenever position,
+	// angle or scale changed, attachments compose theirs from the parent and only decompose it back
+	// when gameplay needs to.
+	mat3 world = mat3(1.f);
 };
 
 // Data relevant to the movement of entities
@@ -444,27 +462,6 @@ struct PlayerAbility {
 	PLAYER_ABILITY_ID id;
 };
 
-// Stucture to store collision information
-struct Collision {
-	// Note, the first object is stored in the ECS container.entities
-	COLLISION_TYPE collision_type;
-	Entity other_entity; // the second object involved in the collision
-	vec2 knockback_dir;
-	Collision(COLLISION_TYPE collision_type, Entity& other_entity) {
-		this->other_entity = other_entity;
-		this->collision_type = collision_type;
-	};
-	Collision(COLLISION_TYPE collision_type) {
-		assert((collision_type == COLLISION_TYPE::WITH_BOUNDARY || collision_type == COLLISION_TYPE::BULLET_WITH_BOUNDARY) &&
-			"other_entity must be specified unless colliding with boundary");
-		this->collision_type = collision_type;
-	}
-	Collision(COLLISION_TYPE collision_type, vec2 knockback_dir) {
-		this->collision_type = collision_type;
-		this->knockback_dir = knockback_dir;
-	}
-};
-
 // Data structure for toggling debug mode
 struct Debug {
 	bool in_debug_mode = 0;
@@ -539,6 +536,12 @@ struct Cure {
 
 };
 
+// Distance ring around the player a regular enemy is in, see SpawnManager
+struct DistanceRing {
+	int ring = 0;
+	uint slot = 0;	// Position in the ring's entity list
+};
+
 struct Health {
 	float health = 100.f;
 	float maxHealth = 100.f;
@@ -556,11 +559,6 @@ struct Invincibility {
 	float timer_ms = 700.f;
 };
 
-struct Projectile {
-	float damage = 10.f;
-	
-};
-
 struct Animation {
 	int total_frame = 1;
 	int curr_frame = 0;
@@ -592,11 +590,6 @@ struct CollideEnemy {
 
 };
 
-struct TimedEvent {
-	float timer_ms = 10000.f;
-	std::function<void()> callback;
-};
-
 struct MenuElem {
 
 };
@@ -635,8 +628,14 @@ struct Waypoint {
 	vec2 icon_scale = { 20.f, 20.f };
 };
 
+// Independent instruction streams a boss behaviour can run (e.g. shooting and dashing)
+const int MAX_BEHAVIOUR_TRACKS = 4;
+
 struct Boss {
 	bool activated = false;
+	BOSS_ID type = BOSS_ID::BOSS_COUNT;				// Selects the compiled behaviour program
+	uint pc[MAX_BEHAVIOUR_TRACKS] = {};				// Program counter of each track, relative to the track entry
+	float wait_ms[MAX_BEHAVIOUR_TRACKS] = {};		// Remaining wait of each track
 };
 
 struct Credits {
@@ -660,4 +659,13 @@ struct TripleBullets {
 
 struct LotsOfBullets {
 };
+
+// A delayed change to the world. Plain data, so pending events can be saved and scheduled again.
+const int timed_event_value_count = 8;
+struct TimedEvent {
+	TIMED_EVENT_ID type = TIMED_EVENT_ID::TIMED_EVENT_COUNT;
+	Entity entity;
+	CYST_EFFECT_ID effect = CYST_EFFECT_ID::EFFECT_COUNT;	// Of an EFFECT_END
+	float values[timed_event_value_count] = {};	// Meaning depends on type
+};
 #pragma endregion
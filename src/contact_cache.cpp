@@ -0,0 +1,74 @@
+// internal
+#include "contact_cache.hpp"
+
+uint64_t ContactCache::key(Entity a, Entity b) {
+	uint64_t id_a = (unsigned int)a;
+	uint64_t id_b = (unsigned int)b;
+	return id_a < id_b ? (id_a << 32) | id_b : (id_b << 32) | id_a;
+}
+
+Contact& ContactCache::touch(Entity a, Entity b, bool& entered) {
+	auto it = index.find(key(a, b));
+	if (it != index.end()) {
+		Contact& contact = contacts[it->second];
+		entered = contact.rearmed;
+		contact.rearmed = false;
+		contact.last_step = step;
+		return contact;
+	}
+
+	entered = true;
+	index[key(a, b)] = (uint32_t)contacts.size();
+	contacts.emplace_back();
+	Contact& contact = contacts.back();
+	contact.entity = a;
+	contact.other_entity = b;
+	contact.last_step = step;
+	return contact;
+}
+
+void ContactCache::end_step() {
+	// Backwards, remove_at moves the last contact into the freed spot
+	for (uint32_t i = (uint32_t)contacts.size(); i-- > 0;) {
+		if (contacts[i].last_step != step) {
+			remove_at(i);
+		}
+	}
+}
+
+void ContactCache::rearm(Entity e) {
+	for (Contact& contact : contacts) {
+		if (contact.entity == e || contact.other_entity == e) {
+			contact.rearmed = true;
+		}
+	}
+}
+
+void ContactCache::rearm(Entity a, Entity b) {
+	auto it = index.find(key(a, b));
+	if (it != index.end()) {
+		contacts[it->second].rearmed = true;
+	}
+}
+
+void ContactCache::forget(Entity e) {
+	for (uint32_t i = (uint32_t)contacts.size(); i-- > 0;) {
+		if (contacts[i].entity == e || contacts[i].other_entity == e) {
+			remove_at(i);
+		}
+	}
+}
+
+void ContactCache::clear() {
+	contacts.clear();
+	index.clear();
+}
+
+void ContactCache::remove_at(uint32_t i) {
+	index.erase(key(contacts[i].entity, contacts[i].other_entity));
+	if (i != contacts.size() - 1) {
+		contacts[i] = contacts.back();
+		index[key(contacts[i].entity, contacts[i].other_entity)] = i;
+	}
+	contacts.pop_back();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+// internal
+#include "tiny_ecs.hpp"
+#include "components.hpp"
+
+// stlib
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// A pair of overlapping entities, kept alive for as long as they keep overlapping
+struct Contact {
+	Entity entity;			// Ordered the way the collision type expects, see collisionhelper
+	Entity other_entity;
+	COLLISION_TYPE type = COLLISION_TYPE::WITH_BOUNDARY;
+	bool has_type = false;	// False for pairs gameplay does not care about, e.g. a chest and an enemy
+	bool rearmed = false;	// Enters again at its next touch, see ContactCache::rearm
+	uint32_t last_step = 0;
+};
+
+// Persistent set of touching entity pairs. The physics system touches every overlapping pair once
+// per step; a pair touched for the first time has entered, a pair that was not touched again has
+// ended. (a, b) and (b, a) are the same contact.
+class ContactCache
+{
+public:
+	void begin_step() { step++; }
+	// The contact for the pair, created if they were not touching. entered is set in that case and
+	// when the contact was rearmed.
+	Contact& touch(Entity a, Entity b, bool& entered);
+	// Removes every contact that was not touched this step
+	void end_step();
+	// Whether the pair touched in the last step
+	bool touching(Entity a, Entity b) const { return index.count(key(a, b)) > 0; }
+
+	// Lets contacts that keep overlapping enter again, e.g. once a hit cooldown of one of them ran out
+	void rearm(Entity e);
+	void rearm(Entity a, Entity b);
+
+	// Drops the contacts of a removed entity without reporting them
+	void forget(Entity e);
+	void clear();
+
+	size_t size() const { return contacts.size(); }
+
+private:
+	static uint64_t key(Entity a, Entity b);
+	void remove_at(uint32_t i);
+
+	std::vector<Contact> contacts;
+	std::unordered_map<uint64_t, uint32_t> index;	// Pair key to position in contacts
+	uint32_t step = 0;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "components.hpp"
+
+// stlib
+#include <functional>
+#include <vector>
+
+// A collision reported by the physics system. The COLLISION_TYPE is the queue it sits in. Pairs are
+// reported when they start touching, or again once rearmed while they keep touching (see
+// contact_cache.hpp). Boundaries are not tracked, every step a body moves into one is a collision.
+struct CollisionEvent {
+	Entity entity;			// The first object, e.g. the player in PLAYER_WITH_ENEMY or the sword in SWORD_WITH_CYST
+	Entity other_entity;	// The second object, the entity itself for boundary collisions
+	vec2 knockback_dir = { 0.f, 0.f };
+};
+
+// Frame-scoped collision events. Physics publishes into one contiguous queue per COLLISION_TYPE,
+// gameplay subscribes one handler per type and gets all events of that type as a batch on dispatch().
+class CollisionEventBus
+{
+public:
+	typedef std::function<void(const std::vector<CollisionEvent>&)> Handler;
+
+	// Events nobody subscribed to are dropped right away
+	void publish(COLLISION_TYPE type, Entity entity, Entity other_entity, vec2 knockback_dir = { 0.f, 0.f }) {
+		if (!wants(type)) return;
+		queues[(int)type].push_back({ entity, other_entity, knockback_dir });
+	}
+
+	void subscribe(COLLISION_TYPE type, Handler handler) {
+		handlers[(int)type] = handler;
+	}
+
+	bool wants(COLLISION_TYPE type) const {
+		return bool(handlers[(int)type]);
+	}
+
+	// Hands every non-empty queue to its handler in COLLISION_TYPE order, then empties the queues
+	void dispatch() {
+		for (int type = 0; type < collision_type_count; type++) {
+			if (!queues[type].empty()) {
+				handlers[type](queues[type]);
+			}
+		}
+		clear();
+	}
+
+	// Drops pending events, subscriptions are kept
+	void clear() {
+		for (std::vector<CollisionEvent>& queue : queues) {
+			queue.clear();
+		}
+	}
+
+	size_t size(COLLISION_TYPE type) const { return queues[(int)type].size(); }
+
+private:
+	std::vector<CollisionEvent> queues[collision_type_count];
+	Handler handlers[collision_type_count];
+};
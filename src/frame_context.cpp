@@ -0,0 +1,37 @@
+// internal
+#include "frame_context.hpp"
+
+void FrameContext::begin(ECSRegistry& registry, float elapsed_ms_arg) {
+	elapsed_ms = elapsed_ms_arg;
+
+	// The player might change on death
+	has_player = !registry.players.entities.empty();
+	if (has_player) {
+		player = registry.players.entities.back();
+	}
+
+	update_camera(registry);
+}
+
+void FrameContext::update_camera(ECSRegistry& registry) {
+	assert(registry.camera.size() == 1);
+	camera_position = registry.camera.components[0].position;
+
+	// Fake projection matrix, scales with respect to window coordinates
+	Transformation projection_transform;
+	projection_transform.scale({ 2.f / CONTENT_WIDTH_PX, 2.f / CONTENT_HEIGHT_PX });
+	projection = projection_transform.mat;
+
+	Transformation view_transform;
+	view_transform.translate(-camera_position);
+	view = view_transform.mat;
+	Transformation inverse_view_transform;
+	inverse_view_transform.translate(camera_position);
+	inverse_view = inverse_view_transform.mat;
+
+	view_projection = projection * view;
+
+	vec2 half_screen = vec2(CONTENT_WIDTH_PX, CONTENT_HEIGHT_PX) / 2.f;
+	view_min = camera_position - half_screen;
+	view_max = camera_position + half_screen;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// Values several systems need every tick, computed once by main instead of by each system.
+// begin() runs after the world step (which may restart the game and replace the player),
+// update_camera() again before drawing since the camera follows the player after physics.
+struct FrameContext {
+	float elapsed_ms = 0.f;
+
+	// Camera
+	vec2 camera_position = { 0.f, 0.f };
+	mat3 projection = { { 1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f }, { 0.f, 0.f, 1.f } };		// Screen to device coordinates
+	mat3 view = { { 1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f }, { 0.f, 0.f, 1.f } };			// World to screen coordinates
+	mat3 inverse_view = { { 1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f }, { 0.f, 0.f, 1.f } };	// Screen to world coordinates
+	mat3 view_projection = { { 1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f }, { 0.f, 0.f, 1.f } };
+	vec2 view_min = { 0.f, 0.f };	// World space rectangle covered by the screen
+	vec2 view_max = { 0.f, 0.f };
+
+	// The player of the current game, valid when has_player is set
+	Entity player;
+	bool has_player = false;
+
+	void begin(ECSRegistry& registry, float elapsed_ms);
+	void update_camera(ECSRegistry& registry);
+
+	// Within radius_scale screen radii of the camera
+	bool is_outside_screen(vec2 position, float radius_scale = 1.f) const {
+		return length(position - camera_position) > SCREEN_RADIUS * radius_scale;
+	}
+	vec2 to_screen(vec2 world_position) const { return vec2(view * vec3(world_position, 1.f)); }
+	vec2 to_world(vec2 screen_position) const { return vec2(inverse_view * vec3(screen_position, 1.f)); }
+};
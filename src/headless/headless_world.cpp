@@ -0,0 +1,34 @@
+// internal
+#include "headless_world.hpp"
+
+HeadlessWorld::HeadlessWorld()
+	: world_system(registry), render_system(registry), physics_system(registry), ai_system(registry)
+{
+	// Parallel worlds would all write the same save file
+	world_system.autosave_interval_ms = 0.f;
+}
+
+bool HeadlessWorld::init(bool skip_menus) {
+	// The null backends always hand out a window
+	GLFWwindow* window = world_system.create_window();
+	if (!window) {
+		return false;
+	}
+	render_system.init(window);
+	if (!world_system.init(&render_system, &frame) || !ai_system.init()) {
+		return false;
+	}
+	if (skip_menus) {
+		world_system.start_run(false);
+	}
+	frame.begin(registry, 0.f);
+	return true;
+}
+
+void HeadlessWorld::tick(const std::vector<InputEvent>& events) {
+	assert(!events.empty() && events.back().type == INPUT_EVENT_TYPE::END_TICK);
+	for (const InputEvent& event : events) {
+		world_system.handle_input_event(event);
+	}
+	tick_simulation(registry, world_system, render_system, physics_system, ai_system, frame, events.back().elapsed_ms);
+}
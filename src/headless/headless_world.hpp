@@ -0,0 +1,31 @@
+#pragma once
+
+// internal
+#include "simulation_tick.hpp"
+
+// stlib
+#include <vector>
+
+// One world without window, GPU or audio: the registry, the systems running it, stepped by the same
+// tick_simulation as main.cpp. Worlds share no state, so the batch runner steps one per thread.
+class HeadlessWorld
+{
+public:
+	HeadlessWorld();
+
+	// Creates the null window and loads the world, false if its data fails to load. Starts a run
+	// right away when skip_menus is set, otherwise the start menu waits for input. Seed and
+	// recorder have to be set before.
+	bool init(bool skip_menus);
+
+	// Advances the world by one tick. events is the input of that tick and ends with its END_TICK,
+	// whose elapsed_ms is the step length.
+	void tick(const std::vector<InputEvent>& events);
+
+	ECSRegistry registry;
+	WorldSystem world_system;
+	RenderSystem render_system;
+	PhysicsSystem physics_system;
+	AISystem ai_system;
+	FrameContext frame;
+};
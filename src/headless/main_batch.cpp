@@ -0,0 +1,269 @@
+// stlib
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <thread>
+
+// internal
+#include "headless_world.hpp"
+#include "autoplay_bot.hpp"
+
+using Clock = std::chrono::high_resolution_clock;
+
+const float BATCH_TICK_MS = 1000.f / 60.f;
+const float DEFAULT_RUN_SECONDS = 600.f;
+
+// One point of the parameter grid
+struct BatchParameters {
+	AUTOPLAY_POLICY policy = AUTOPLAY_POLICY::FULL;
+	int max_green = 0;
+	int max_red = 0;
+	int max_yellow = 0;
+	float health_scale = 1.f;		// Multiplies every entry of the game mode's enemy_health_map
+	float boss_difficulty = 1.f;	// GameMode::FRIEND_BOSS_DIFFICULTY
+};
+
+// What a run reports, times are simulated seconds and -1 when it never happened
+struct BatchResult {
+	uint32_t seed = 0;
+	int ticks = 0;
+	float seconds = 0.f;
+	int deaths = 0;
+	float boss_seconds = -1.f;			// First boss fight started
+	float first_boss_seconds = -1.f;	// First boss defeated
+	float second_boss_seconds = -1.f;	// Second boss defeated, which ends the run
+	float mean_tick_us = 0.f;
+	float p99_tick_us = 0.f;
+	float max_tick_us = 0.f;
+	bool failed = false;				// The world did not load, nothing else of the row is valid
+};
+
+struct BatchJob {
+	BatchParameters parameters;
+	uint32_t seed;
+	BatchResult result;
+};
+
+// Plays one world with the bot for up to run_ms of simulated time
+static void run_job(BatchJob& job, GAME_MODE_ID base_mode, float run_ms) {
+	const BatchParameters& parameters = job.parameters;
+	BatchResult& result = job.result;
+	result.seed = job.seed;
+
+	HeadlessWorld world;
+	ECSRegistry& registry = world.registry;
+	world.world_system.set_seed(job.seed);
+	if (!world.init(false)) {
+		fprintf(stderr, "\nRun with seed %u failed, its world did not load\n", job.seed);
+		result.failed = true;
+		return;
+	}
+
+	GameMode mode = world.world_system.get_game_mode(base_mode);
+	mode.max_green = parameters.max_green;
+	mode.max_red = parameters.max_red;
+	mode.max_yellow = parameters.max_yellow;
+	for (auto& entry : mode.enemy_health_map) {
+		entry.second *= parameters.health_scale;
+	}
+	mode.FRIEND_BOSS_DIFFICULTY = parameters.boss_difficulty;
+	world.world_system.set_game_mode(mode);
+	world.world_system.start_run(false);
+	world.frame.begin(registry, 0.f);
+
+	AutoplayBot bot(run_ms, parameters.policy);
+	std::vector<InputEvent> events;
+	std::vector<float> tick_us;
+	tick_us.reserve((size_t)(run_ms / BATCH_TICK_MS) + 1);
+	bool was_dead = false;
+	while (!bot.is_finished() && !world.world_system.is_over()) {
+		auto start = Clock::now();
+		events.clear();
+		bot.step(registry, world.frame, events);
+		events.push_back(InputEvent::end_tick(BATCH_TICK_MS));
+		world.tick(events);
+		tick_us.push_back((float)(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start)).count() / 1000);
+
+		result.ticks++;
+		result.seconds = result.ticks * BATCH_TICK_MS / 1000.f;
+		bool dead = world.frame.has_player && registry.deathTimers.has(world.frame.player);
+		if (dead && !was_dead) result.deaths++;
+		was_dead = dead;
+		if (result.boss_seconds < 0.f) {
+			for (const Boss& boss : registry.bosses.components) {
+				if (boss.activated) result.boss_seconds = result.seconds;
+			}
+		}
+		if (registry.game.size() > 0) {
+			const Game& game = registry.game.components[0];
+			if (game.isFirstBossDefeated && result.first_boss_seconds < 0.f) result.first_boss_seconds = result.seconds;
+			if (game.isSecondBossDefeated) {
+				result.second_boss_seconds = result.seconds;
+				break;
+			}
+		}
+	}
+
+	if (tick_us.empty()) return;
+	double total_us = 0.0;
+	for (float us : tick_us) total_us += us;
+	result.mean_tick_us = (float)(total_us / tick_us.size());
+	result.max_tick_us = *std::max_element(tick_us.begin(), tick_us.end());
+	size_t p99 = tick_us.size() * 99 / 100;
+	std::nth_element(tick_us.begin(), tick_us.begin() + p99, tick_us.end());
+	result.p99_tick_us = tick_us[p99];
+}
+
+template <typename T>
+static bool parse_list(const char* text, T (*parse)(const char*), std::vector<T>& values) {
+	values.clear();
+	std::stringstream stream(text);
+	std::string item;
+	while (std::getline(stream, item, ',')) {
+		if (item.empty()) return false;
+		values.push_back(parse(item.c_str()));
+	}
+	return !values.empty();
+}
+
+static int parse_int(const char* text) { return atoi(text); }
+static float parse_float(const char* text) { return (float)atof(text); }
+static AUTOPLAY_POLICY parse_policy(const char* text) {
+	for (int i = 0; i < autoplay_policy_count; i++) {
+		if (strcmp(text, autoplay_policy_names[i]) == 0) return (AUTOPLAY_POLICY)i;
+	}
+	return AUTOPLAY_POLICY::AUTOPLAY_POLICY_COUNT;
+}
+
+static void print_usage(const char* program) {
+	fprintf(stderr,
+		"Usage: %s [--out <file.csv>] [--runs <n>] [--seconds <s>] [--seed <s>] [--threads <n>] [--mode easy|regular]\n"
+		"          [--policy full,no_dodge,melee] [--max-green a,b,..] [--max-red a,b,..] [--max-yellow a,b,..]\n"
+		"          [--health-scale a,b,..] [--boss-difficulty a,b,..]\n",
+		program);
+}
+
+// Sweeps game mode parameters with the autoplay bot. Every combination of the listed values (and
+// policies) plays --runs worlds of up to --seconds simulated time each, on all cores. Run i of every
+// combination uses the seed --seed + i, so combinations are compared on the same worlds.
+// Writes one CSV row per run, runs whose world failed to load are marked failed and make the exit code non-zero. The worlds still log to stdout, redirect it to keep the console readable.
+int main(int argc, char* argv[])
+{
+	const char* out_path = "batch.csv";
+	int runs = 10;
+	float run_seconds = DEFAULT_RUN_SECONDS;
+	uint32_t base_seed = std::random_device()();
+	int threads = (int)std::thread::hardware_concurrency();
+	GAME_MODE_ID base_mode = GAME_MODE_ID::REGULAR_MODE;
+	std::vector<AUTOPLAY_POLICY> policies = { AUTOPLAY_POLICY::FULL };
+	std::vector<int> max_greens, max_reds, max_yellows;
+	std::vector<float> health_scales = { 1.f };
+	std::vector<float> boss_difficulties;
+
+	bool valid = true;
+	for (int i = 1; i < argc && valid; i++) {
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) valid = false;
+		else if (strcmp(argv[i], "--out") == 0) out_path = value;
+		else if (strcmp(argv[i], "--runs") == 0) runs = atoi(value);
+		else if (strcmp(argv[i], "--seconds") == 0) run_seconds = (float)atof(value);
+		else if (strcmp(argv[i], "--seed") == 0) base_seed = (uint32_t)strtoul(value, nullptr, 10);
+		else if (strcmp(argv[i], "--threads") == 0) threads = atoi(value);
+		else if (strcmp(argv[i], "--mode") == 0) {
+			if (strcmp(value, "easy") == 0) base_mode = GAME_MODE_ID::EASY_MODE;
+			else if (strcmp(value, "regular") == 0) base_mode = GAME_MODE_ID::REGULAR_MODE;
+			else valid = false;
+		}
+		else if (strcmp(argv[i], "--policy") == 0) {
+			valid = parse_list(value, parse_policy, policies)
+				&& std::find(policies.begin(), policies.end(), AUTOPLAY_POLICY::AUTOPLAY_POLICY_COUNT) == policies.end();
+		}
+		else if (strcmp(argv[i], "--max-green") == 0) valid = parse_list(value, parse_int, max_greens);
+		else if (strcmp(argv[i], "--max-red") == 0) valid = parse_list(value, parse_int, max_reds);
+		else if (strcmp(argv[i], "--max-yellow") == 0) valid = parse_list(value, parse_int, max_yellows);
+		else if (strcmp(argv[i], "--health-scale") == 0) valid = parse_list(value, parse_float, health_scales);
+		else if (strcmp(argv[i], "--boss-difficulty") == 0) valid = parse_list(value, parse_float, boss_difficulties);
+		else valid = false;
+		i++;
+	}
+	if (!valid || runs <= 0 || run_seconds <= 0.f) {
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	threads = std::max(1, threads);
+
+	// Parameters left out keep the value of the base mode
+	const bool easy = base_mode == GAME_MODE_ID::EASY_MODE;
+	if (max_greens.empty()) max_greens = { easy ? max_green_easyMode : max_green_regularMode };
+	if (max_reds.empty()) max_reds = { easy ? max_red_easyMode : max_red_regularMode };
+	if (max_yellows.empty()) max_yellows = { easy ? max_yellow_easyMode : max_yellow_regularMode };
+	if (boss_difficulties.empty()) boss_difficulties = { easy ? FRIEND_BOSS_DIFFICULTY_easy : FRIEND_BOSS_DIFFICULTY };
+
+	std::vector<BatchJob> jobs;
+	for (AUTOPLAY_POLICY policy : policies)
+	for (int max_green : max_greens)
+	for (int max_red : max_reds)
+	for (int max_yellow : max_yellows)
+	for (float health_scale : health_scales)
+	for (float boss_difficulty : boss_difficulties)
+	for (int run = 0; run < runs; run++) {
+		BatchJob job;
+		job.parameters = { policy, max_green, max_red, max_yellow, health_scale, boss_difficulty };
+		job.seed = base_seed + run;
+		jobs.push_back(job);
+	}
+	FILE* out = fopen(out_path, "w");
+	if (!out) {
+		fprintf(stderr, "Failed to open %s\n", out_path);
+		return EXIT_FAILURE;
+	}
+	threads = std::min(threads, (int)jobs.size());
+	fprintf(stderr, "Running %d worlds of %.0f s on %d threads, base seed %u\n", (int)jobs.size(), run_seconds, threads, base_seed);
+
+	// Workers take the next job until none are left, results land in the job itself
+	std::atomic<int> next_job(0);
+	std::atomic<int> jobs_done(0);
+	std::atomic<int> jobs_failed(0);
+	auto start = Clock::now();
+	auto worker = [&]() {
+		for (int i = next_job++; i < (int)jobs.size(); i = next_job++) {
+			run_job(jobs[i], base_mode, run_seconds * 1000.f);
+			if (jobs[i].result.failed) jobs_failed++;
+			fprintf(stderr, "\r%d/%d runs", ++jobs_done, (int)jobs.size());
+		}
+	};
+	std::vector<std::thread> pool;
+	for (int i = 0; i < threads; i++) {
+		pool.emplace_back(worker);
+	}
+	for (std::thread& thread : pool) {
+		thread.join();
+	}
+	float seconds = (float)(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start)).count() / 1000;
+	fprintf(stderr, "\nFinished in %.1f s\n", seconds);
+
+	// In job order, so the file does not depend on the thread count
+	fprintf(out, "policy,max_green,max_red,max_yellow,health_scale,boss_difficulty,seed,ticks,seconds,deaths,"
+		"boss_seconds,first_boss_seconds,second_boss_seconds,mean_tick_us,p99_tick_us,max_tick_us,failed\n");
+	for (const BatchJob& job : jobs) {
+		const BatchParameters& p = job.parameters;
+		const BatchResult& r = job.result;
+		fprintf(out, "%s,%d,%d,%d,%g,%g,%u,%d,%.3f,%d,%.3f,%.3f,%.3f,%.2f,%.2f,%.2f,%d\n",
+			autoplay_policy_names[(int)p.policy], p.max_green, p.max_red, p.max_yellow, p.health_scale, p.boss_difficulty,
+			r.seed, r.ticks, r.seconds, r.deaths, r.boss_seconds, r.first_boss_seconds, r.second_boss_seconds,
+			r.mean_tick_us, r.p99_tick_us, r.max_tick_us, r.failed ? 1 : 0);
+	}
+	fclose(out);
+	fprintf(stderr, "Wrote %d runs to %s\n", (int)jobs.size(), out_path);
+
+	// Failed rows are kept and marked so the file still lines up with the grid
+	if (jobs_failed > 0) {
+		fprintf(stderr, "%d runs failed\n", (int)jobs_failed);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,186 @@
+// stlib
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+// internal
+#include "headless_world.hpp"
+#include "autoplay_bot.hpp"
+#include "world_serializer.hpp"
+
+using Clock = std::chrono::high_resolution_clock;
+
+const int DEFAULT_TICKS = 10000;
+const float DEFAULT_TICK_MS = 1000.f / 60.f;
+
+// Every component of every entity as JSON, plus the bullets which are no entities
+static json world_state(HeadlessWorld& world) {
+	ECSRegistry& registry = world.registry;
+	std::vector<Entity> entities;
+	ECSRegistry::for_each_container([&](auto member) {
+		const auto& container = registry.*member;
+		entities.insert(entities.end(), container.entities.begin(), container.entities.end());
+	});
+	std::sort(entities.begin(), entities.end(), [](Entity a, Entity b) { return (unsigned int)a < (unsigned int)b; });
+	entities.erase(std::unique(entities.begin(), entities.end(), [](Entity a, Entity b) { return (unsigned int)a == (unsigned int)b; }), entities.end());
+	std::vector<char> blob;
+	capture_world(registry, entities, &world.render_system.getMesh((GEOMETRY_BUFFER_ID)0), blob);
+	json state = world_to_json(blob);
+	json& projectiles = state["projectiles"];
+	projectiles = json::array();
+	for (size_t i = 0; i < registry.projectiles.size(); i++) {
+		projectiles.push_back({ registry.projectiles.positions[i].x, registry.projectiles.positions[i].y, registry.projectiles.lifetimes[i] });
+	}
+	state["timers"] = world.world_system.timers.size();
+	return state;
+}
+
+// Pushes a checkpoint, lets the bot play ticks more and goes back to the checkpoint. Replaying the
+// same input from there has to end in the same world, false if the checkpoint or the replay differ.
+static bool check_checkpoint(HeadlessWorld& world, AutoplayBot& bot, int ticks, float tick_ms) {
+	WorldSystem& world_system = world.world_system;
+	// Input is not part of checkpoints, dying in a boss fight keeps what the player holds
+	InputState input = world_system.input;
+	world_system.push_checkpoint();
+	json pushed = world_state(world);
+
+	std::vector<std::vector<InputEvent>> played(ticks);
+	for (std::vector<InputEvent>& events : played) {
+		bot.step(world.registry, world.frame, events);
+		events.push_back(InputEvent::end_tick(tick_ms));
+		world.tick(events);
+	}
+	json after = world_state(world);
+
+	// A restart in between dropped the checkpoint, a boss fight pushed a newer one
+	if (!world_system.restore_checkpoint() || world_state(world) != pushed) {
+		fprintf(stderr, "Checkpoint check: the checkpoint did not come back\n");
+		return false;
+	}
+	world.frame.update_camera(world.registry);
+	world_system.input = input;
+	for (const std::vector<InputEvent>& events : played) {
+		world.tick(events);
+	}
+	if (world_state(world) != after) {
+		fprintf(stderr, "Checkpoint check: the replay from the checkpoint diverged\n");
+		return false;
+	}
+	printf("Checkpoint check: %d ticks replayed the same\n", ticks);
+	return true;
+}
+
+// Runs the simulation without window, GPU or audio as fast as it goes and reports ticks per second.
+// Usage: game_headless [ticks] [tick_ms] [--seed <n>] [--record <file>] [--replay <file>] [--autoplay <seconds>]
+//        [--checkpoint-check <ticks>]
+// Every tick advances the world by tick_ms, or by the measured wall time when tick_ms is 0.
+// A replay uses the recorded step lengths instead and runs until the recording ends.
+// --autoplay lets a bot play for the given simulated time (0 for no limit) instead of ticks.
+// --checkpoint-check has the bot play on after the run, see
+// check_checkpoint, and fails the run when the checkpoint does not replay the same.
+int main(int argc, char* argv[])
+{
+	HeadlessWorld world;
+	ECSRegistry& registry = world.registry;
+	WorldSystem& world_system = world.world_system;
+
+	int ticks = -1;
+	float tick_ms = DEFAULT_TICK_MS;
+	const char* record_path = nullptr;
+	InputRecorder recorder;
+	InputReplay replay;
+	AutoplayBot bot;
+	bool autoplay = false;
+	int checkpoint_ticks = 0;
+	std::vector<InputEvent> scripted_events;
+	int positional = 0;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			world_system.set_seed((uint32_t)strtoul(argv[++i], nullptr, 10));
+		}
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+			record_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+			if (!replay.open(argv[++i])) return EXIT_FAILURE;
+			world_system.set_seed(replay.get_seed());
+			world_system.live_input = false;
+		}
+		else if (strcmp(argv[i], "--autoplay") == 0 && i + 1 < argc) {
+			bot = AutoplayBot((float)atof(argv[++i]) * 1000.f);
+			autoplay = true;
+		}
+		else if (strcmp(argv[i], "--checkpoint-check") == 0 && i + 1 < argc) {
+			checkpoint_ticks = atoi(argv[++i]);
+		}
+		else if (positional == 0) {
+			ticks = atoi(argv[i]);
+			positional++;
+		}
+		else if (positional == 1) {
+			tick_ms = (float)atof(argv[i]);
+			positional++;
+		}
+		else {
+			ticks = 0;
+			break;
+		}
+	}
+	if (ticks < 0) {
+		ticks = (replay.is_open() || autoplay) ? INT_MAX : DEFAULT_TICKS;
+	}
+	if (ticks <= 0 || tick_ms < 0.f || checkpoint_ticks < 0 || (checkpoint_ticks > 0 && tick_ms == 0.f)) {
+		fprintf(stderr, "Usage: %s [ticks] [tick_ms] [--seed <n>] [--record <file>] [--replay <file>] [--autoplay <seconds>] [--checkpoint-check <ticks>]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	// Opened once the seed is final, wherever --seed came
+	if (record_path) {
+		if (!recorder.open(record_path, registry.random.get_seed(), INPUT_RECORDING_SKIP_MENUS)) return EXIT_FAILURE;
+		world_system.recorder = &recorder;
+	}
+
+	// Nobody is there to click through the menus, unless a replay does it
+	if (!world.init(!replay.is_open() || (replay.get_flags() & INPUT_RECORDING_SKIP_MENUS))) {
+		return EXIT_FAILURE;
+	}
+
+	auto start = Clock::now();
+	auto t = start;
+	int ticks_run = 0;
+	while (ticks_run < ticks && !world_system.is_over()) {
+		float elapsed_ms = tick_ms;
+		if (tick_ms == 0.f) {
+			auto now = Clock::now();
+			elapsed_ms = (float)(std::chrono::duration_cast<std::chrono::microseconds>(now - t)).count() / 1000;
+			t = now;
+		}
+
+		// A replay brings its own step lengths
+		if (replay.is_open()) {
+			if (!replay.next_tick(scripted_events)) break;
+		}
+		else {
+			scripted_events.clear();
+			if (autoplay) {
+				if (bot.is_finished()) break;
+				bot.step(registry, world.frame, scripted_events);
+			}
+			scripted_events.push_back(InputEvent::end_tick(elapsed_ms));
+		}
+		world.tick(scripted_events);
+		ticks_run++;
+	}
+	float seconds = (float)(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start)).count() / 1000000;
+
+	printf("\n=========================\n|\tHeadless\t|\n=========================\n");
+	registry.list_all_components();
+	printf("ticks: %d\nseconds: %f\nticks/sec: %f\n", ticks_run, seconds, seconds > 0.f ? ticks_run / seconds : 0.f);
+
+	if (checkpoint_ticks > 0 && !check_checkpoint(world, bot, checkpoint_ticks, tick_ms)) {
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
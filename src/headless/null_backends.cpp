@@ -0,0 +1,78 @@
+// Null window, input and audio backends of the headless build. They stand in for the GLFW, SDL and
+// SDL_mixer functions the simulation calls, so game_headless links without any of those libraries.
+
+// internal
+#include "common.hpp"
+
+// stlib
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+#include <SDL_mixer.h>
+
+// gl3w, only referenced by gl_has_errors()
+static GLenum null_gl_get_error() { return GL_NO_ERROR; }
+PFNGLGETERRORPROC gl3wGetError = (PFNGLGETERRORPROC)null_gl_get_error;
+
+// Opaque handles only need to be distinct from nullptr
+static char null_handle;
+
+// Every world creates its own window, which carries that world's user pointer
+struct NullWindow {
+	void* user_pointer = nullptr;
+};
+
+/////////////////////////////////////////
+// GLFW: windows that are never closed, no monitor modes and no joysticks
+
+int glfwInit(void) { return GLFW_TRUE; }
+void glfwWindowHint(int, int) {}
+GLFWerrorfun glfwSetErrorCallback(GLFWerrorfun) { return nullptr; }
+
+GLFWmonitor* glfwGetPrimaryMonitor(void) { return (GLFWmonitor*)&null_handle; }
+const GLFWvidmode* glfwGetVideoMode(GLFWmonitor*) {
+	static const GLFWvidmode mode = { CONTENT_WIDTH_PX, CONTENT_HEIGHT_PX, 8, 8, 8, TARGET_REFRESH_RATE };
+	return &mode;
+}
+
+GLFWwindow* glfwCreateWindow(int, int, const char*, GLFWmonitor*, GLFWwindow*) { return (GLFWwindow*)new NullWindow(); }
+void glfwDestroyWindow(GLFWwindow* window) { delete (NullWindow*)window; }
+void glfwSetWindowMonitor(GLFWwindow*, GLFWmonitor*, int, int, int, int, int) {}
+GLFWwindow* glfwGetCurrentContext(void) { return nullptr; }
+int glfwWindowShouldClose(GLFWwindow*) { return GLFW_FALSE; }
+void glfwSetWindowUserPointer(GLFWwindow* window, void* pointer) { ((NullWindow*)window)->user_pointer = pointer; }
+void* glfwGetWindowUserPointer(GLFWwindow* window) { return ((NullWindow*)window)->user_pointer; }
+void glfwSetInputMode(GLFWwindow*, int, int) {}
+
+GLFWkeyfun glfwSetKeyCallback(GLFWwindow*, GLFWkeyfun) { return nullptr; }
+GLFWcursorposfun glfwSetCursorPosCallback(GLFWwindow*, GLFWcursorposfun) { return nullptr; }
+GLFWmousebuttonfun glfwSetMouseButtonCallback(GLFWwindow*, GLFWmousebuttonfun) { return nullptr; }
+GLFWjoystickfun glfwSetJoystickCallback(GLFWjoystickfun) { return nullptr; }
+
+int glfwJoystickPresent(int) { return GLFW_FALSE; }
+const float* glfwGetJoystickAxes(int, int* count) { *count = 0; return nullptr; }
+const unsigned char* glfwGetJoystickButtons(int, int* count) { *count = 0; return nullptr; }
+
+/////////////////////////////////////////
+// SDL and SDL_mixer: loading always succeeds and nothing is ever playing
+
+int SDL_Init(Uint32) { return 0; }
+SDL_RWops* SDL_RWFromFile(const char*, const char*) { return nullptr; }
+
+int Mix_OpenAudio(int, Uint16, int, int) { return 0; }
+void Mix_CloseAudio(void) {}
+int Mix_AllocateChannels(int numchans) { return numchans; }
+
+Mix_Music* Mix_LoadMUS(const char*) { return (Mix_Music*)&null_handle; }
+void Mix_FreeMusic(Mix_Music*) {}
+int Mix_FadeInMusic(Mix_Music*, int, int) { return 0; }
+int Mix_VolumeMusic(int) { return 0; }
+
+Mix_Chunk* Mix_LoadWAV_RW(SDL_RWops*, int) {
+	static Mix_Chunk chunk = {};
+	return &chunk;
+}
+void Mix_FreeChunk(Mix_Chunk*) {}
+int Mix_VolumeChunk(Mix_Chunk*, int) { return 0; }
+int Mix_PlayChannelTimed(int channel, Mix_Chunk*, int, int) { return channel; }
+int Mix_Playing(int) { return 0; }
+int Mix_Volume(int, int) { return 0; }
@@ -0,0 +1,46 @@
+// internal
+#include "render_system.hpp"
+
+// Renderer of the headless build. Nothing is drawn, but the meshes are still loaded since
+// collisions use their vertices.
+
+bool RenderSystem::init(GLFWwindow* window_arg)
+{
+	this->window = window_arg;
+	initializeGlMeshes();
+	// The systems read and write the screen state, e.g. the FOV effect
+	screen_state_entity = registry.create_entity();
+	registry.screenStates.emplace(screen_state_entity);
+	return true;
+}
+
+void RenderSystem::initializeGlMeshes()
+{
+	for (uint i = 0; i < mesh_paths.size(); i++)
+	{
+		Mesh& mesh = meshes[(int)mesh_paths[i].first];
+		Mesh::loadFromOBJFile(mesh_paths[i].second,
+			mesh.texture_vertices, mesh.vertex_indices, mesh.original_size, mesh.color_vertices, false);
+	}
+	for (uint i = 0; i < mesh_paths_color_vector.size(); i++)
+	{
+		Mesh& mesh = meshes[(int)mesh_paths_color_vector[i].first];
+		Mesh::loadFromOBJFile(mesh_paths_color_vector[i].second,
+			mesh.texture_vertices, mesh.vertex_indices, mesh.original_size, mesh.color_vertices, true);
+	}
+}
+
+template <class T>
+void RenderSystem::bindVBOandIBO(GEOMETRY_BUFFER_ID, std::vector<T>, std::vector<uint16_t>)
+{
+}
+template void RenderSystem::bindVBOandIBO<TexturedVertex>(GEOMETRY_BUFFER_ID, std::vector<TexturedVertex>, std::vector<uint16_t>);
+template void RenderSystem::bindVBOandIBO<ColoredVertex>(GEOMETRY_BUFFER_ID, std::vector<ColoredVertex>, std::vector<uint16_t>);
+
+RenderSystem::~RenderSystem()
+{
+}
+
+void RenderSystem::draw(const FrameContext&)
+{
+}
@@ -0,0 +1,187 @@
+// internal
+#include "input_recording.hpp"
+
+// stlib
+#include <cassert>
+#include <cstring>
+
+static const char INPUT_RECORDING_MAGIC[4] = { 'C', 'C', 'I', 'R' };
+
+InputEvent InputEvent::key(int key, int action, int mods) {
+	InputEvent event;
+	event.type = INPUT_EVENT_TYPE::KEY;
+	event.code = key;
+	event.action = action;
+	event.mods = mods;
+	return event;
+}
+
+InputEvent InputEvent::mouse_button(int button, int action, int mods) {
+	InputEvent event = key(button, action, mods);
+	event.type = INPUT_EVENT_TYPE::MOUSE_BUTTON;
+	return event;
+}
+
+InputEvent InputEvent::cursor_move(vec2 position) {
+	InputEvent event;
+	event.type = INPUT_EVENT_TYPE::CURSOR;
+	event.cursor = position;
+	return event;
+}
+
+InputEvent InputEvent::gamepad_change(const GamepadState& state) {
+	InputEvent event;
+	event.type = INPUT_EVENT_TYPE::GAMEPAD;
+	event.gamepad = state;
+	return event;
+}
+
+InputEvent InputEvent::end_tick(float elapsed_ms) {
+	InputEvent event;
+	event.type = INPUT_EVENT_TYPE::END_TICK;
+	event.elapsed_ms = elapsed_ms;
+	return event;
+}
+
+template <typename T>
+static void write_value(FILE* file, T value) {
+	fwrite(&value, sizeof(T), 1, file);
+}
+
+template <typename T>
+static bool read_value(FILE* file, T& value) {
+	return fread(&value, sizeof(T), 1, file) == 1;
+}
+
+InputRecorder::~InputRecorder() {
+	close();
+}
+
+bool InputRecorder::open(const std::string& path, uint32_t seed, uint8_t flags) {
+	close();
+	file = fopen(path.c_str(), "wb");
+	if (file == nullptr) {
+		fprintf(stderr, "Failed to open input recording %s\n", path.c_str());
+		return false;
+	}
+	fwrite(INPUT_RECORDING_MAGIC, 1, sizeof(INPUT_RECORDING_MAGIC), file);
+	write_value(file, INPUT_RECORDING_VERSION);
+	write_value(file, seed);
+	write_value(file, flags);
+	printf("Recording input to %s\n", path.c_str());
+	return true;
+}
+
+void InputRecorder::write(const InputEvent& event) {
+	if (file == nullptr) return;
+	write_value(file, (uint8_t)event.type);
+	switch (event.type) {
+	case INPUT_EVENT_TYPE::KEY:
+	case INPUT_EVENT_TYPE::MOUSE_BUTTON:
+		write_value(file, (int16_t)event.code);
+		write_value(file, (uint8_t)event.action);
+		write_value(file, (uint8_t)event.mods);
+		break;
+	case INPUT_EVENT_TYPE::CURSOR:
+		write_value(file, event.cursor.x);
+		write_value(file, event.cursor.y);
+		break;
+	case INPUT_EVENT_TYPE::GAMEPAD:
+		write_value(file, (uint8_t)event.gamepad.present);
+		write_value(file, event.gamepad.buttons);
+		fwrite(event.gamepad.axes, sizeof(float), GAMEPAD_AXIS_COUNT, file);
+		break;
+	case INPUT_EVENT_TYPE::END_TICK:
+		write_value(file, event.elapsed_ms);
+		break;
+	default:
+		assert(false && "Unknown input event type");
+		break;
+	}
+}
+
+void InputRecorder::close() {
+	if (file != nullptr) {
+		fclose(file);
+		file = nullptr;
+	}
+}
+
+InputReplay::~InputReplay() {
+	close();
+}
+
+bool InputReplay::open(const std::string& path) {
+	close();
+	file = fopen(path.c_str(), "rb");
+	if (file == nullptr) {
+		fprintf(stderr, "Failed to open input recording %s\n", path.c_str());
+		return false;
+	}
+	char magic[sizeof(INPUT_RECORDING_MAGIC)];
+	uint16_t version = 0;
+	if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, INPUT_RECORDING_MAGIC, sizeof(magic)) != 0
+		|| !read_value(file, version) || !read_value(file, seed) || !read_value(file, flags)) {
+		fprintf(stderr, "%s is not an input recording\n", path.c_str());
+		close();
+		return false;
+	}
+	if (version != INPUT_RECORDING_VERSION) {
+		fprintf(stderr, "Input recording %s has version %d, expected %d\n", path.c_str(), version, INPUT_RECORDING_VERSION);
+		close();
+		return false;
+	}
+	printf("Replaying input from %s, seed %u\n", path.c_str(), seed);
+	return true;
+}
+
+bool InputReplay::next_tick(std::vector<InputEvent>& events) {
+	events.clear();
+	if (file == nullptr) return false;
+	InputEvent event;
+	while (read_event(event)) {
+		events.push_back(event);
+		if (event.type == INPUT_EVENT_TYPE::END_TICK) return true;
+	}
+	// A recording cut off mid-tick (e.g. the game was killed) ends at its last full tick
+	return false;
+}
+
+bool InputReplay::read_event(InputEvent& event) {
+	uint8_t type;
+	if (!read_value(file, type)) return false;
+	event = InputEvent();
+	event.type = (INPUT_EVENT_TYPE)type;
+	switch (event.type) {
+	case INPUT_EVENT_TYPE::KEY:
+	case INPUT_EVENT_TYPE::MOUSE_BUTTON: {
+		int16_t code;
+		uint8_t action, mods;
+		if (!read_value(file, code) || !read_value(file, action) || !read_value(file, mods)) return false;
+		event.code = code;
+		event.action = action;
+		event.mods = mods;
+		return true;
+	}
+	case INPUT_EVENT_TYPE::CURSOR:
+		return read_value(file, event.cursor.x) && read_value(file, event.cursor.y);
+	case INPUT_EVENT_TYPE::GAMEPAD: {
+		uint8_t present;
+		if (!read_value(file, present) || !read_value(file, event.gamepad.buttons)) return false;
+		event.gamepad.present = present != 0;
+		return fread(event.gamepad.axes, sizeof(float), GAMEPAD_AXIS_COUNT, file) == GAMEPAD_AXIS_COUNT;
+	}
+	case INPUT_EVENT_TYPE::END_TICK:
+		return read_value(file, event.elapsed_ms);
+	default:
+		fprintf(stderr, "Unknown input event type %d in recording\n", type);
+		return false;
+	}
+}
+
+void InputReplay::close() {
+	if (file != nullptr) {
+		fclose(file);
+		file = nullptr;
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "input_state.hpp"
+
+// stlib
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class INPUT_EVENT_TYPE {
+	KEY = 0,
+	MOUSE_BUTTON = KEY + 1,
+	CURSOR = MOUSE_BUTTON + 1,
+	GAMEPAD = CURSOR + 1,
+	END_TICK = GAMEPAD + 1,
+	INPUT_EVENT_TYPE_COUNT = END_TICK + 1
+};
+const int input_event_type_count = (int)INPUT_EVENT_TYPE::INPUT_EVENT_TYPE_COUNT;
+
+// One input callback as delivered by GLFW, a gamepad change, or the end of a simulation tick.
+// Everything the simulation reads from the player goes through WorldSystem::handle_input_event as one of these.
+struct InputEvent {
+	INPUT_EVENT_TYPE type = INPUT_EVENT_TYPE::END_TICK;
+	int code = 0;				// KEY, MOUSE_BUTTON: GLFW key or button
+	int action = 0;				// KEY, MOUSE_BUTTON
+	int mods = 0;				// KEY, MOUSE_BUTTON
+	vec2 cursor = { 0.f, 0.f };	// CURSOR: window coordinates
+	GamepadState gamepad;		// GAMEPAD
+	float elapsed_ms = 0.f;		// END_TICK: step length of the tick that just ended
+
+	static InputEvent key(int key, int action, int mods);
+	static InputEvent mouse_button(int button, int action, int mods);
+	static InputEvent cursor_move(vec2 position);
+	static InputEvent gamepad_change(const GamepadState& state);
+	static InputEvent end_tick(float elapsed_ms);
+};
+
+// Recording file layout, native byte order:
+//   header: "CCIR", uint16 version, uint32 seed, uint8 flags
+//   events: uint8 type, then KEY/MOUSE_BUTTON: int16 code, uint8 action, uint8 mods
+//                            CURSOR: 2 x float
+//                            GAMEPAD: uint8 present, uint32 buttons, GAMEPAD_AXIS_COUNT x float
+//                            END_TICK: float elapsed_ms
+const uint16_t INPUT_RECORDING_VERSION = 1;
+// Header flags
+const uint8_t INPUT_RECORDING_SKIP_MENUS = 1;	// The run was started with WorldSystem::start_run(false)
+
+// Writes the seed and the input stream of a run
+class InputRecorder
+{
+public:
+	~InputRecorder();
+
+	bool open(const std::string& path, uint32_t seed, uint8_t flags = 0);
+	bool is_open() const { return file != nullptr; }
+	void write(const InputEvent& event);
+	void close();
+
+private:
+	FILE* file = nullptr;
+};
+
+// Reads a recording back one tick at a time
+class InputReplay
+{
+public:
+	~InputReplay();
+
+	bool open(const std::string& path);
+	bool is_open() const { return file != nullptr; }
+	uint32_t get_seed() const { return seed; }
+	uint8_t get_flags() const { return flags; }
+	// Fills events with the input of the next tick, ending with its END_TICK.
+	// Returns false once the recording is exhausted or damaged.
+	bool next_tick(std::vector<InputEvent>& events);
+	void close();
+
+private:
+	bool read_event(InputEvent& event);
+
+	FILE* file = nullptr;
+	uint32_t seed = 0;
+	uint8_t flags = 0;
+};
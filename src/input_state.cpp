@@ -0,0 +1,161 @@
+// internal
+#include "input_state.hpp"
+
+// stlib
+#include <algorithm>
+
+const int InputState::KEY_COUNT;
+const int InputState::MOUSE_BUTTON_COUNT;
+const int InputState::GAMEPAD_BUTTON_COUNT;
+const int InputState::AXIS_COUNT;
+const int InputState::MAX_BINDINGS;
+
+static void add_binding(int (&slots)[InputState::MAX_BINDINGS], int code) {
+	for (int& slot : slots) {
+		if (slot == code) return;
+		if (slot < 0) {
+			slot = code;
+			return;
+		}
+	}
+	fprintf(stderr, "Too many bindings for one input action, ignoring %d\n", code);
+}
+
+InputState::InputState() {
+	bind_key(INPUT_ACTION::MOVE_UP, GLFW_KEY_W);
+	bind_key(INPUT_ACTION::MOVE_DOWN, GLFW_KEY_S);
+	bind_key(INPUT_ACTION::MOVE_LEFT, GLFW_KEY_A);
+	bind_key(INPUT_ACTION::MOVE_RIGHT, GLFW_KEY_D);
+	bind_mouse_button(INPUT_ACTION::SHOOT, GLFW_MOUSE_BUTTON_LEFT);
+	bind_axis(INPUT_ACTION::SHOOT, 4, 0.1f);		// Right trigger
+	bind_mouse_button(INPUT_ACTION::SLASH, GLFW_MOUSE_BUTTON_RIGHT);
+	bind_axis(INPUT_ACTION::SLASH, 3, 0.1f);		// Left trigger
+	bind_key(INPUT_ACTION::DASH, GLFW_KEY_LEFT_SHIFT);
+	bind_gamepad_button(INPUT_ACTION::DASH, 4);
+	bind_key(INPUT_ACTION::INTERACT, GLFW_KEY_SPACE);
+	bind_gamepad_button(INPUT_ACTION::INTERACT, 2);
+}
+
+void InputState::on_key(int key, int action) {
+	if (!in_range(key, KEY_COUNT)) return;
+	if (action == GLFW_PRESS) {
+		keys[key] = true;
+		keys_pressed[key] = true;
+	}
+	else if (action == GLFW_RELEASE) {
+		keys[key] = false;
+		keys_released[key] = true;
+	}
+}
+
+void InputState::on_mouse_button(int button, int action) {
+	if (!in_range(button, MOUSE_BUTTON_COUNT)) return;
+	if (action == GLFW_PRESS) {
+		mouse_buttons[button] = true;
+		mouse_pressed[button] = true;
+	}
+	else if (action == GLFW_RELEASE) {
+		mouse_buttons[button] = false;
+		mouse_released[button] = true;
+	}
+}
+
+GamepadState GamepadState::poll() {
+	GamepadState state;
+	state.present = glfwJoystickPresent(GLFW_JOYSTICK_1);
+	if (!state.present) return state;
+
+	int count = 0;
+	const unsigned char* buttons = glfwGetJoystickButtons(GLFW_JOYSTICK_1, &count);
+	for (int i = 0; i < std::min(count, InputState::GAMEPAD_BUTTON_COUNT); i++) {
+		if (buttons[i] == GLFW_PRESS) state.buttons |= 1u << i;
+	}
+	const float* axes = glfwGetJoystickAxes(GLFW_JOYSTICK_1, &count);
+	for (int i = 0; i < std::min(count, GAMEPAD_AXIS_COUNT); i++) {
+		state.axes[i] = axes[i];
+	}
+	return state;
+}
+
+bool GamepadState::operator==(const GamepadState& other) const {
+	return present == other.present && buttons == other.buttons && std::equal(axes, axes + GAMEPAD_AXIS_COUNT, other.axes);
+}
+
+void InputState::set_gamepad(const GamepadState& state) {
+	std::bitset<GAMEPAD_BUTTON_COUNT> previous = gamepad_buttons;
+	gamepad_state = state;
+	if (!gamepad_state.present) gamepad_state = GamepadState();
+	gamepad_buttons = std::bitset<GAMEPAD_BUTTON_COUNT>(gamepad_state.buttons);
+	gamepad_pressed |= gamepad_buttons & ~previous;
+	gamepad_released |= previous & ~gamepad_buttons;
+}
+
+void InputState::end_frame() {
+	keys_pressed.reset();
+	keys_released.reset();
+	mouse_pressed.reset();
+	mouse_released.reset();
+	gamepad_pressed.reset();
+	gamepad_released.reset();
+}
+
+void InputState::release_all() {
+	keys.reset();
+	mouse_buttons.reset();
+	end_frame();
+}
+
+void InputState::bind_key(INPUT_ACTION action, int key) {
+	add_binding(bindings[(int)action].keys, key);
+}
+
+void InputState::bind_mouse_button(INPUT_ACTION action, int button) {
+	add_binding(bindings[(int)action].mouse_buttons, button);
+}
+
+void InputState::bind_gamepad_button(INPUT_ACTION action, int button) {
+	add_binding(bindings[(int)action].gamepad_buttons, button);
+}
+
+void InputState::bind_axis(INPUT_ACTION action, int axis, float threshold) {
+	bindings[(int)action].axis = axis;
+	bindings[(int)action].axis_threshold = threshold;
+}
+
+void InputState::clear_bindings(INPUT_ACTION action) {
+	bindings[(int)action] = Bindings();
+}
+
+bool InputState::action(INPUT_ACTION action) const {
+	const Bindings& binding = bindings[(int)action];
+	for (int i = 0; i < MAX_BINDINGS; i++) {
+		if (key(binding.keys[i]) || mouse_button(binding.mouse_buttons[i]) || gamepad_button(binding.gamepad_buttons[i])) {
+			return true;
+		}
+	}
+	return binding.axis >= 0 && axis(binding.axis) > binding.axis_threshold;
+}
+
+bool InputState::action_pressed(INPUT_ACTION action) const {
+	const Bindings& binding = bindings[(int)action];
+	for (int i = 0; i < MAX_BINDINGS; i++) {
+		if (key_pressed(binding.keys[i])
+			|| mouse_button_pressed(binding.mouse_buttons[i])
+			|| gamepad_button_pressed(binding.gamepad_buttons[i])) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool InputState::action_released(INPUT_ACTION action) const {
+	const Bindings& binding = bindings[(int)action];
+	for (int i = 0; i < MAX_BINDINGS; i++) {
+		if (key_released(binding.keys[i])
+			|| mouse_button_released(binding.mouse_buttons[i])
+			|| gamepad_button_released(binding.gamepad_buttons[i])) {
+			return true;
+		}
+	}
+	return false;
+}
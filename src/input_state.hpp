@@ -0,0 +1,106 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+
+// stlib
+#include <bitset>
+#include <cstdint>
+
+// What the player wants to do, independent of the device
+enum class INPUT_ACTION {
+	MOVE_UP = 0,
+	MOVE_DOWN = MOVE_UP + 1,
+	MOVE_LEFT = MOVE_DOWN + 1,
+	MOVE_RIGHT = MOVE_LEFT + 1,
+	SHOOT = MOVE_RIGHT + 1,
+	SLASH = SHOOT + 1,
+	DASH = SLASH + 1,
+	INTERACT = DASH + 1,
+	INPUT_ACTION_COUNT = INTERACT + 1
+};
+const int input_action_count = (int)INPUT_ACTION::INPUT_ACTION_COUNT;
+
+const int GAMEPAD_AXIS_COUNT = 6;
+
+// Snapshot of the first joystick
+struct GamepadState {
+	bool present = false;
+	uint32_t buttons = 0;		// Bit i set while button i is held
+	float axes[GAMEPAD_AXIS_COUNT] = {};
+
+	// Reads the joystick through GLFW
+	static GamepadState poll();
+	bool operator==(const GamepadState& other) const;
+	bool operator!=(const GamepadState& other) const { return !(*this == other); }
+};
+
+// Keyboard, mouse and gamepad state in fixed tables indexed by the GLFW codes, so polling never
+// allocates. Keys and mouse buttons are fed by the GLFW callbacks, the gamepad is polled once per frame.
+// pressed/released report the edges since the last end_frame(), so a tap shorter than a frame is not lost.
+class InputState
+{
+public:
+	static const int KEY_COUNT = GLFW_KEY_LAST + 1;
+	static const int MOUSE_BUTTON_COUNT = GLFW_MOUSE_BUTTON_LAST + 1;
+	static const int GAMEPAD_BUTTON_COUNT = 32;
+	static const int AXIS_COUNT = GAMEPAD_AXIS_COUNT;
+	static const int MAX_BINDINGS = 3;
+
+	InputState();
+
+	void on_key(int key, int action);
+	void on_mouse_button(int button, int action);
+	// Takes over a gamepad snapshot, everything reads as released when it is not present
+	void set_gamepad(const GamepadState& state);
+	const GamepadState& gamepad() const { return gamepad_state; }
+	// Forgets this frame's edges, call once all systems have read the input
+	void end_frame();
+	// Treats every key and mouse button as released until pressed again, e.g. when a dialog opens
+	void release_all();
+
+	bool key(int key) const { return in_range(key, KEY_COUNT) && keys[key]; }
+	bool key_pressed(int key) const { return in_range(key, KEY_COUNT) && keys_pressed[key]; }
+	bool key_released(int key) const { return in_range(key, KEY_COUNT) && keys_released[key]; }
+	bool mouse_button(int button) const { return in_range(button, MOUSE_BUTTON_COUNT) && mouse_buttons[button]; }
+	bool mouse_button_pressed(int button) const { return in_range(button, MOUSE_BUTTON_COUNT) && mouse_pressed[button]; }
+	bool mouse_button_released(int button) const { return in_range(button, MOUSE_BUTTON_COUNT) && mouse_released[button]; }
+	bool gamepad_present() const { return gamepad_state.present; }
+	bool gamepad_button(int button) const { return in_range(button, GAMEPAD_BUTTON_COUNT) && gamepad_buttons[button]; }
+	bool gamepad_button_pressed(int button) const { return in_range(button, GAMEPAD_BUTTON_COUNT) && gamepad_pressed[button]; }
+	bool gamepad_button_released(int button) const { return in_range(button, GAMEPAD_BUTTON_COUNT) && gamepad_released[button]; }
+	float axis(int axis) const { return in_range(axis, AXIS_COUNT) ? gamepad_state.axes[axis] : 0.f; }
+	// Any key, mouse button or gamepad button held down
+	bool any() const { return keys.any() || mouse_buttons.any() || gamepad_buttons.any(); }
+
+	// Action mapping. Every action has up to MAX_BINDINGS keys or mouse buttons, gamepad buttons and
+	// gamepad axes (held when past a threshold) bound to it.
+	void bind_key(INPUT_ACTION action, int key);
+	void bind_mouse_button(INPUT_ACTION action, int button);
+	void bind_gamepad_button(INPUT_ACTION action, int button);
+	void bind_axis(INPUT_ACTION action, int axis, float threshold);
+	void clear_bindings(INPUT_ACTION action);
+
+	bool action(INPUT_ACTION action) const;
+	bool action_pressed(INPUT_ACTION action) const;
+	// A bound key or button went up, axes have no edges
+	bool action_released(INPUT_ACTION action) const;
+
+private:
+	static bool in_range(int code, int count) { return code >= 0 && code < count; }
+
+	std::bitset<KEY_COUNT> keys, keys_pressed, keys_released;
+	std::bitset<MOUSE_BUTTON_COUNT> mouse_buttons, mouse_pressed, mouse_released;
+	std::bitset<GAMEPAD_BUTTON_COUNT> gamepad_buttons, gamepad_pressed, gamepad_released;
+	GamepadState gamepad_state;
+
+	// -1 marks an unused slot
+	struct Bindings {
+		int keys[MAX_BINDINGS] = { -1, -1, -1 };
+		int mouse_buttons[MAX_BINDINGS] = { -1, -1, -1 };
+		int gamepad_buttons[MAX_BINDINGS] = { -1, -1, -1 };
+		int axis = -1;
+		float axis_threshold = 0.f;
+	};
+	Bindings bindings[input_action_count];
+};
@@ -4,29 +4,54 @@
 
 // stlib
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
 
 // internal
-#include "physics_system.hpp"
-#include "render_system.hpp"
-#include "world_system.hpp"
-#include "ai_system.hpp"
+#include "simulation_tick.hpp"
+#include "autoplay_bot.hpp"
 
 using Clock = std::chrono::high_resolution_clock;
 
-void reset_forces() {
-	for (Motion& m : registry.motions.components) {
-		m.force = { 0.f, 0.f };
-	}
-}
-
 // Entry point
-int main()
+// Usage: game [--record <file>] [--replay <file>] [--autoplay <seconds>]
+// --autoplay lets a bot play for the given simulated time, 0 for no limit
+int main(int argc, char* argv[])
 {
-	// Global systems
-	WorldSystem world_system;
-	RenderSystem render_system;
-	PhysicsSystem physics_system;
-	AISystem ai_system;
+	// The game world and the systems running it
+	ECSRegistry registry;
+	WorldSystem world_system(registry);
+	RenderSystem render_system(registry);
+	PhysicsSystem physics_system(registry);
+	AISystem ai_system(registry);
+	FrameContext frame;
+
+	// Input sources besides the player: a recording or the autoplay bot
+	const char* record_path = nullptr;
+	InputRecorder recorder;
+	InputReplay replay;
+	AutoplayBot bot;
+	bool autoplay = false;
+	std::vector<InputEvent> scripted_events;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--record") == 0) {
+			record_path = argv[i + 1];
+		}
+		else if (strcmp(argv[i], "--replay") == 0 && replay.open(argv[i + 1])) {
+			world_system.set_seed(replay.get_seed());
+			world_system.live_input = false;
+		}
+		else if (strcmp(argv[i], "--autoplay") == 0) {
+			bot = AutoplayBot((float)atof(argv[i + 1]) * 1000.f);
+			autoplay = true;
+			world_system.live_input = false;
+		}
+	}
+	// Both the bot and the recording it replays start right in the game
+	bool skip_menus = autoplay || (replay.get_flags() & INPUT_RECORDING_SKIP_MENUS);
+	if (record_path && recorder.open(record_path, registry.random.get_seed(), autoplay ? INPUT_RECORDING_SKIP_MENUS : 0)) {
+		world_system.recorder = &recorder;
+	}
 
 	// Initializing window
 	GLFWwindow* window = world_system.create_window();
@@ -40,8 +65,14 @@ int main()
 
 	// initialize the main systems
 	render_system.init(window);
-	world_system.init(&render_system);
+	if (!world_system.init(&render_system, &frame) || !ai_system.init()) {
+		return EXIT_FAILURE;
+	}
 	render_system.animationSys_init();
+	if (skip_menus) {
+		world_system.start_run(false);
+	}
+	frame.begin(registry, 0.f);
 
 	// variable timestep loop
 	auto t = Clock::now();
@@ -51,21 +82,34 @@ int main()
 
 		// Calculating elapsed times in milliseconds from the previous iteration
 		auto now = Clock::now();
-		float elapsed_ms =
-			(float)(std::chrono::duration_cast<std::chrono::microseconds>(now - t)).count() / 1000;
+		float elapsed_ms = (float)(std::chrono::duration_cast<std::chrono::microseconds>(now - t)).count() / 1000;
 		t = now;
 
-		reset_forces();
-		bool isRunning = world_system.step(elapsed_ms);
-		if (isRunning) {
-			ai_system.step(elapsed_ms);
-			physics_system.step(elapsed_ms);
-			world_system.resolve_collisions();
-			render_system.animationSys_step(elapsed_ms);
-			world_system.update_camera(elapsed_ms);
+		if (replay.is_open()) {
+			// Replay the recorded input and step length, regardless of how long rendering takes
+			if (!replay.next_tick(scripted_events)) break;
+			for (const InputEvent& event : scripted_events) {
+				world_system.handle_input_event(event);
+			}
+			elapsed_ms = scripted_events.back().elapsed_ms;
+		}
+		else {
+			if (autoplay) {
+				if (bot.is_finished()) break;
+				scripted_events.clear();
+				bot.step(registry, frame, scripted_events);
+				for (const InputEvent& event : scripted_events) {
+					world_system.handle_input_event(event);
+				}
+			}
+			else {
+				world_system.poll_gamepad();
+			}
+			world_system.handle_input_event(InputEvent::end_tick(elapsed_ms));
 		}
-		
-		render_system.draw();
+
+		tick_simulation(registry, world_system, render_system, physics_system, ai_system, frame, elapsed_ms);
+		render_system.draw(frame);
 	}
 
 	// Debugging for memory/component leaks
@@ -126,7 +126,7 @@ bool line_interesect_with_circle(vec2 point_1, vec2 point_2, CollisionCircle cir
 }
 
 // Returns the knockback direction if collides. Otherwise returns {0, 0}
-vec2 collides_with_region_boundary(const Transform& transform, const Motion& motion) {
+vec2 collides_with_region_boundary(ECSRegistry& registry, const Transform& transform, const Motion& motion) {
 	float target_angle = atan2f(transform.position.y, transform.position.x);
 	float min_region_angle = 0.f, max_region_angle = 0.f;
 	float region_spread = M_PI * 2 / NUM_REGIONS;
@@ -207,26 +207,17 @@ bool line_line_intersect(vec2 a, vec2 b, vec2 c, vec2 p1, vec2 p2, vec2 p3) {
 }
 
 bool collides_mesh_with_mesh(Mesh* mesh1, Transform transform_1, Mesh* mesh2, Transform transform_2) {
-	Transformation t_matrix1;
-	t_matrix1.translate(transform_1.position);
-	t_matrix1.rotate(transform_1.angle);
-	t_matrix1.scale(transform_1.scale);
 	std::vector<vec2> vertex_pos1;
-
-	Transformation t_matrix2;
-	t_matrix2.translate(transform_2.position);
-	t_matrix2.rotate(transform_2.angle);
-	t_matrix2.scale(transform_2.scale);
 	std::vector<vec2> vertex_pos2;
 	
 	// Convert all vertex position to world coordinate
 	for (TexturedVertex v1 : mesh1->texture_vertices) {
-		vec3 world_pos1 = t_matrix1.mat * vec3(v1.position.x, v1.position.y, 1.f);
+		vec3 world_pos1 = transform_1.world * vec3(v1.position.x, v1.position.y, 1.f);
 		vertex_pos1.push_back(vec2(world_pos1.x, world_pos1.y));
 	}
 
 	for (TexturedVertex v2 : mesh2->texture_vertices) {
-		vec3 world_pos2 = t_matrix2.mat * vec3(v2.position.x, v2.position.y, 1.f);
+		vec3 world_pos2 = transform_2.world * vec3(v2.position.x, v2.position.y, 1.f);
 		vertex_pos2.push_back(vec2(world_pos2.x, world_pos2.y));
 	}
 
@@ -248,14 +239,10 @@ bool collides_mesh_with_mesh(Mesh* mesh1, Transform transform_1, Mesh* mesh2, Tr
 // Check if mesh collides with circles. Mesh is associated with transform_1
 bool collides_with_mesh(Mesh *mesh, Transform transform_1, Transform transform_2) {
 	std::vector<CollisionCircle> circles = get_collision_circles(transform_2);
-	Transformation t_matrix;
-	t_matrix.translate(transform_1.position);
-	t_matrix.rotate(transform_1.angle);
-	t_matrix.scale(transform_1.scale);
 	std::vector<vec2> vertex_pos;
 	// Convert all vertex position to world coordinate
 	for (TexturedVertex v : mesh->texture_vertices) {
-		vec3 world_pos = t_matrix.mat * vec3(v.position.x, v.position.y, 1.f);
+		vec3 world_pos = transform_1.world * vec3(v.position.x, v.position.y, 1.f);
 		vertex_pos.push_back(vec2(world_pos.x, world_pos.y));
 	}
 	// For each triangle, check if any of the three edges collides with any of the circles
@@ -283,46 +270,69 @@ bool collides_with_mesh(Mesh *mesh, Transform transform_1, Transform transform_2
 	return false;
 }
 
-// Adds collision events to be handled in world_system's resolve_collisions()
-void collisionhelper(Entity entity_1, Entity entity_2) {
-	// Bullet Collisions
-	if (registry.projectiles.has(entity_1)) {
-		if (registry.projectiles.has(entity_2)) {
-			registry.collisions.emplace_with_duplicates(entity_1, COLLISION_TYPE::BULLET_WITH_BULLET, entity_2);
-		}
-		else if (registry.players.has(entity_2) && registry.collidePlayers.has(entity_1)) {
-			registry.collisions.emplace_with_duplicates(entity_1, COLLISION_TYPE::BULLET_WITH_PLAYER, entity_2);
-		}
-		else if (registry.enemies.has(entity_2) && registry.collideEnemies.has(entity_1) && registry.collidePlayers.has(entity_2)) {
-			registry.collisions.emplace_with_duplicates(entity_1, COLLISION_TYPE::BULLET_WITH_ENEMY, entity_2);
-		}
-		else if (registry.cysts.has(entity_2) && registry.collideEnemies.has(entity_1)) {
-			registry.collisions.emplace_with_duplicates(entity_1, COLLISION_TYPE::BULLET_WITH_CYST, entity_2);
-		}
-	// Player Collisions
-	} else if (registry.players.has(entity_1) && registry.collidePlayers.has(entity_2)) {
+// Finds the collision type of entity_1 touching entity_2, false if gameplay does not care about it
+bool collisionhelper(ECSRegistry& registry, Entity entity_1, Entity entity_2, COLLISION_TYPE& type) {
+	// Player Collisions (bullets are handled in check_projectile_collision)
+	if (registry.players.has(entity_1) && registry.collidePlayers.has(entity_2)) {
 		if (registry.enemies.has(entity_2)) {
-			registry.collisions.emplace_with_duplicates(entity_1, COLLISION_TYPE::PLAYER_WITH_ENEMY, entity_2);
+			type = COLLISION_TYPE::PLAYER_WITH_ENEMY;
 		} else if (registry.cysts.has(entity_2)) {
-			registry.collisions.emplace_with_duplicates(entity_1, COLLISION_TYPE::PLAYER_WITH_CYST, entity_2);
+			type = COLLISION_TYPE::PLAYER_WITH_CYST;
 		} else if (registry.chests.has(entity_2)) {
-			registry.collisions.emplace_with_duplicates(entity_1, COLLISION_TYPE::PLAYER_WITH_CHEST, entity_2);
+			type = COLLISION_TYPE::PLAYER_WITH_CHEST;
 		} else if (registry.cure.has(entity_2)) {
-			registry.collisions.emplace_with_duplicates(entity_1, COLLISION_TYPE::PLAYER_WITH_CURE, entity_2);
+			type = COLLISION_TYPE::PLAYER_WITH_CURE;
+		} else {
+			return false;
 		}
+		return true;
 	// Enemy Collisions
 	} else if (registry.enemies.has(entity_1)) {
 		if (registry.enemies.has(entity_2)) {
-			registry.collisions.emplace_with_duplicates(entity_1, COLLISION_TYPE::ENEMY_WITH_ENEMY, entity_2);
+			type = COLLISION_TYPE::ENEMY_WITH_ENEMY;
+			return true;
 		}
 	// Sword collisions
 	} else if (registry.attachments.has(entity_1) && registry.attachments.get(entity_1).type == ATTACHMENT_ID::SWORD) {
 		if (registry.enemies.has(entity_2) && registry.collideEnemies.has(entity_1) && registry.collidePlayers.has(entity_2)) {
-			registry.collisions.emplace_with_duplicates(entity_1, COLLISION_TYPE::SWORD_WITH_ENEMY, entity_2);
+			type = COLLISION_TYPE::SWORD_WITH_ENEMY;
+			return true;
 		} else if (registry.cysts.has(entity_2) && registry.collideEnemies.has(entity_1) && registry.collidePlayers.has(entity_2)) {
-			registry.collisions.emplace_with_duplicates(entity_1, COLLISION_TYPE::SWORD_WITH_CYST, entity_2);
+			type = COLLISION_TYPE::SWORD_WITH_CYST;
+			return true;
 		}
 	}
+	return false;
+}
+
+// Records that two entities overlap this step and, when they entered, publishes the collision event
+// to be handled in world_system's resolve_collisions(). The pair is classified when it starts
+// touching and keeps its type until it separates.
+void report_contact(ECSRegistry& registry, Entity entity_i, Entity entity_j) {
+	bool entered;
+	Contact& contact = registry.contacts.touch(entity_i, entity_j, entered);
+	// Untyped pairs are checked again, e.g. the boss only becomes hittable once it is activated
+	if (!contact.has_type) {
+		if (collisionhelper(registry, entity_i, entity_j, contact.type)) {
+			contact.entity = entity_i;
+			contact.other_entity = entity_j;
+			contact.has_type = true;
+			entered = true;
+		}
+		else if (collisionhelper(registry, entity_j, entity_i, contact.type)) {
+			contact.entity = entity_j;
+			contact.other_entity = entity_i;
+			contact.has_type = true;
+			entered = true;
+		}
+		else {
+			return;
+		}
+	}
+	// Handlers act once per contact, pairs they want to hear from again are rearmed
+	if (entered) {
+		registry.collisionEvents.publish(contact.type, contact.entity, contact.other_entity);
+	}
 }
 
 // Calculates angle of the entity based on result of all the forces acting on it
@@ -341,7 +351,7 @@ float get_angle_velocity(Transform& transform, Motion& motion, float elapsed_sec
 }
 
 // Step movement for all entities with Motion component
-void step_movement(float elapsed_ms) {
+void step_movement(ECSRegistry& registry, float elapsed_ms) {
 	// Move NPC based on how much time has passed, this is to (partially) avoid
 	// having entities move at different speed based on the machine.
 	float elapsed_seconds = elapsed_ms / 1000.f;	// Since velocities are in units per second
@@ -380,29 +390,32 @@ void step_movement(float elapsed_ms) {
 			bool speed_above_threshold = (abs(length(motion.velocity)) - play_animation_threshold) > 0.0f;
 			Animation& animation = registry.animations.get(entity);
 			if (!speed_above_threshold && animation.total_frame != (int)ANIMATION_FRAME_COUNT::IMMUNITY_BLINKING) {
-				RenderSystem::animationSys_switchAnimation(entity, ANIMATION_FRAME_COUNT::IMMUNITY_BLINKING, 120);
+				RenderSystem::animationSys_switchAnimation(registry, entity, ANIMATION_FRAME_COUNT::IMMUNITY_BLINKING, 120);
 			}
 			else if (speed_above_threshold && animation.total_frame != (int)ANIMATION_FRAME_COUNT::IMMUNITY_MOVING && animation.total_frame != (int)ANIMATION_FRAME_COUNT::IMMUNITY_DYING) {
-				RenderSystem::animationSys_switchAnimation(entity, ANIMATION_FRAME_COUNT::IMMUNITY_MOVING, 30);
+				RenderSystem::animationSys_switchAnimation(registry, entity, ANIMATION_FRAME_COUNT::IMMUNITY_MOVING, 30);
 			}
 		}		
 	}
 }
 
-void PhysicsSystem::update_attachment_orientation(Entity entity, float elapsed_ms) {
+void PhysicsSystem::update_attachment_orientation(ECSRegistry& registry, Entity entity, float elapsed_ms) {
+	Entity parent = registry.attachments.get(entity).parent;
+	assert(registry.transforms.has(parent));
+	update_attachment_orientation(registry, entity, registry.transforms.get(parent), elapsed_ms);
+}
+
+void PhysicsSystem::update_attachment_orientation(ECSRegistry& registry, Entity entity, const Transform& parent_transform, float elapsed_ms) {
 	float elapsed_seconds = elapsed_ms / 1000.f;	// Since velocities are in units per second
 	if (registry.transforms.has(entity) && registry.motions.has(entity)) {
 		Transform& transform = registry.transforms.get(entity);
 		Motion& motion = registry.motions.get(entity);
 		Attachment& attachment = registry.attachments.get(entity);
 		Entity parent = attachment.parent;
-		assert(registry.transforms.has(parent));
-		Transform& parent_transform = registry.transforms.get(parent);
 
 		// 1st part of relative transformation
 		Transformation pos_calculator;
-		pos_calculator.translate(parent_transform.position);
-		pos_calculator.rotate(parent_transform.angle);
+		pos_calculator.mat = model_matrix(parent_transform.position, parent_transform.angle, { 1.f, 1.f });
 		pos_calculator.mat = pos_calculator.mat * attachment.relative_transform_1.mat;
 
 		float new_moved_angle = attachment.moved_angle;
@@ -416,7 +429,7 @@ void PhysicsSystem::update_attachment_orientation(Entity entity, float elapsed_m
 		}
 		if (fabs(new_moved_angle - attachment.angle_offset) > ANGLE_PRECISION) {
 			float rotate_direction = sign(new_moved_angle);
-			attachment.moved_angle = rotate_direction * min(attachment.angle_freedom, fabs(new_moved_angle));
+			attachment.moved_angle = rotate_direction * min(attachment.angle_freedom, fabsf(new_moved_angle));
 		}
 		else {
 			attachment.moved_angle = attachment.angle_offset;
@@ -426,55 +439,92 @@ void PhysicsSystem::update_attachment_orientation(Entity entity, float elapsed_m
 		// 2nd part of relative transformation
 		pos_calculator.mat = pos_calculator.mat * attachment.relative_transform_2.mat;
 
-		// Decompose the result matrix to position + angle + scale
-		bool flipped = glm::determinant(glm::mat2(pos_calculator.mat)) < 0;
-		if (flipped) {
-			pos_calculator.mat[0][0] = -pos_calculator.mat[0][0];
-			pos_calculator.mat[1][1] = -pos_calculator.mat[1][1];
-		}
-		float angle = atan2f(pos_calculator.mat[0][1], pos_calculator.mat[0][0]);
-		vec2 scale = { 1.f, 1.f };
-		scale.x = length(pos_calculator.mat[0]);
-		scale.y = length(pos_calculator.mat[1]);
-		if (flipped) {
-			// The only possible flipping at the moment is horizontal
-			scale.x = -scale.x;
-			angle = -angle;
-		}
+		// The result is used as is for rendering, the position is cheap so it is always kept up to date
+		transform.world = pos_calculator.mat;
+		transform.position = { pos_calculator.mat[2] };
+
 		// Special case for dashing effect attachment
 		if (attachment.type == ATTACHMENT_ID::DASHING) {
 			vec2 parent_velocity = registry.motions.get(parent).velocity;
-			angle = atan2f(parent_velocity.y, parent_velocity.x);
+			decompose_world_matrix(transform);
+			transform.angle = atan2f(parent_velocity.y, parent_velocity.x);
+			transform.world = model_matrix(transform.position, transform.angle, transform.scale);
+		}
+		// Angle and scale are only read by collisions, enemy steering and child attachments
+		else if (registry.collidePlayers.has(entity) || registry.collideEnemies.has(entity)
+			|| registry.enemies.has(entity) || !registry.attachments.children_of(entity).empty()) {
+			decompose_world_matrix(transform);
 		}
-
-		// Update transform
-		transform.position = { pos_calculator.mat[2] };
-		transform.angle = angle;
-		transform.scale = scale;
 	}
 }
 
-void step_attachment_movement(float elapsed_ms) {
-	auto& attachment_container = registry.attachments;
-	for (uint i = 0; i < attachment_container.size(); i++)
-	{
-		Entity entity = attachment_container.entities[i];
-		PhysicsSystem::update_attachment_orientation(entity, elapsed_ms);
+void PhysicsSystem::decompose_world_matrix(Transform& transform) {
+	mat3 mat = transform.world;
+	bool flipped = glm::determinant(glm::mat2(mat)) < 0;
+	if (flipped) {
+		mat[0][0] = -mat[0][0];
+		mat[1][1] = -mat[1][1];
+	}
+	float angle = atan2f(mat[0][1], mat[0][0]);
+	vec2 scale = { 1.f, 1.f };
+	scale.x = length(mat[0]);
+	scale.y = length(mat[1]);
+	if (flipped) {
+		// The only possible flipping at the moment is horizontal
+		scale.x = -scale.x;
+		angle = -angle;
 	}
+	transform.position = { mat[2] };
+	transform.angle = angle;
+	transform.scale = scale;
 }
 
+void PhysicsSystem::update_world_matrices() {
+	// Runs after the physics step and again before drawing, the second time only the camera, UI
+	// and whatever gameplay moved in between need a new matrix
+	if (built_restores != registry.restores) {
+		built_from.clear();
+		built_restores = registry.restores;
+	}
+	built_from.resize(registry.transforms.size());
+	for (uint i = 0; i < registry.transforms.size(); i++) {
+		Entity entity = registry.transforms.entities[i];
+		// Attachments get theirs from their parent in step_attachment_movement
+		if (registry.attachments.has(entity)) continue;
+		Transform& transform = registry.transforms.components[i];
+		WorldMatrixInput& built = built_from[i];
+		if (built.entity == (unsigned int)entity && built.position == transform.position
+			&& built.angle == transform.angle && built.scale == transform.scale) continue;
+		transform.world = model_matrix(transform.position, transform.angle, transform.scale);
+		built = { (unsigned int)entity, transform.position, transform.angle, transform.scale };
+	}
+}
 
-// duplicate of the one in render_system.cpp
-bool is_outside_screen(vec2 entityPos) {
-	assert(registry.camera.size() == 1);
-	vec2 camPos = registry.camera.components[0].position;
+// Updates the attachments below parent, each one after its own parent so chains never lag a frame
+void step_attachment_subtree(ECSRegistry& registry, Entity parent, const Transform& parent_transform, float elapsed_ms) {
+	for (Entity child : registry.attachments.children_of(parent)) {
+		PhysicsSystem::update_attachment_orientation(registry, child, parent_transform, elapsed_ms);
+		if (registry.transforms.has(child)) {
+			step_attachment_subtree(registry, child, registry.transforms.get(child), elapsed_ms);
+		}
+	}
+}
 
-	return length(entityPos - camPos) > SCREEN_RADIUS * 1;
+void step_attachment_movement(ECSRegistry& registry, float elapsed_ms) {
+	static thread_local std::vector<Entity> roots;
+	roots.clear();
+	registry.attachments.collect_roots(roots);
+	for (Entity root : roots) {
+		assert(registry.transforms.has(root));
+		step_attachment_subtree(registry, root, registry.transforms.get(root), elapsed_ms);
+	}
 }
 
+
 // Check collision for all entities with Motion component
-void check_collision() {
+void check_collision(ECSRegistry& registry, const FrameContext& frame) {
 	auto& motion_container = registry.motions;
+	registry.contacts.begin_step();
 	// Check for collisions between all moving entities
 	for (uint i = 0; i < motion_container.components.size(); i++)
 	{
@@ -482,26 +532,22 @@ void check_collision() {
 		assert(registry.transforms.has(entity_i));
 		Transform transform_i = registry.transforms.get(entity_i);
 
-		// Check for collisions with the map boundary
-		if (!registry.cysts.has(entity_i) && collides_with_boundary(transform_i)) {
-			if (registry.projectiles.has(entity_i)) {
-				registry.collisions.emplace_with_duplicates(entity_i, COLLISION_TYPE::BULLET_WITH_BOUNDARY);
-			}
-			else {
-				registry.collisions.emplace_with_duplicates(entity_i, COLLISION_TYPE::WITH_BOUNDARY);
-			}
+		// Check for collisions with the map boundary, only while moving out so a bounce is reported once
+		if (!registry.cysts.has(entity_i) && collides_with_boundary(transform_i)
+			&& dot(motion_container.components[i].velocity, transform_i.position) > 0.f) {
+			registry.collisionEvents.publish(COLLISION_TYPE::WITH_BOUNDARY, entity_i, entity_i);
 		}
 
 		// Check for collisions with the region boundary in boss fight
 		if (registry.players.has(entity_i) && registry.bosses.size() > 0 && registry.bosses.components.front().activated) {
-			vec2 knockback_dir = collides_with_region_boundary(transform_i, motion_container.components[i]);
+			vec2 knockback_dir = collides_with_region_boundary(registry, transform_i, motion_container.components[i]);
 			if (knockback_dir.x != 0.f && knockback_dir.y != 0.f) {
-				registry.collisions.emplace_with_duplicates(entity_i, COLLISION_TYPE::PLAYER_WITH_REGION_BOUNDARY, knockback_dir);
+				registry.collisionEvents.publish(COLLISION_TYPE::PLAYER_WITH_REGION_BOUNDARY, entity_i, entity_i, knockback_dir);
 			} 
 		}
 
 		// skip if outside screen after checking boundary
-		if (is_outside_screen(transform_i.position)) {
+		if (frame.is_outside_screen(transform_i.position)) {
 			continue;
 		}
 
@@ -513,7 +559,7 @@ void check_collision() {
 			Transform transform_j = registry.transforms.get(entity_j);
 
 			// skip if outside screen
-			if (is_outside_screen(transform_j.position)) {
+			if (frame.is_outside_screen(transform_j.position)) {
 				continue;
 			}
 
@@ -523,44 +569,113 @@ void check_collision() {
 			}
 
 			// ignore collision between an attachment (ie. dashing, sword) and its owner
-			if ((registry.attachments.has(entity_i) && registry.attachments.get(entity_i).parent == entity_j)
-				|| (registry.attachments.has(entity_j) && registry.attachments.get(entity_j).parent == entity_i)) {
+			if (registry.attachments.is_attached_to(entity_i, entity_j)
+				|| registry.attachments.is_attached_to(entity_j, entity_i)) {
 				continue;
 			}
 
 
 			if (registry.meshPtrs.has(entity_i) && registry.meshPtrs.has(entity_j)) {//mesh-mesh collision
 				if ( collides_mesh_with_mesh(registry.meshPtrs.get(entity_i), transform_i, registry.meshPtrs.get(entity_j), transform_j) ) {
-					collisionhelper(entity_i, entity_j);
-					collisionhelper(entity_j, entity_i);
+					report_contact(registry, entity_i, entity_j);
 				}
 			} else if (registry.meshPtrs.has(entity_i)) {
 				if (collides_with_mesh(registry.meshPtrs.get(entity_i), transform_i, transform_j)) {
-					collisionhelper(entity_i, entity_j);
-					collisionhelper(entity_j, entity_i);
+					report_contact(registry, entity_i, entity_j);
 				}
 			} else if (registry.meshPtrs.has(entity_j)) {
 				if (collides_with_mesh(registry.meshPtrs.get(entity_j), transform_j, transform_i)) {
-					collisionhelper(entity_i, entity_j);
-					collisionhelper(entity_j, entity_i);
+					report_contact(registry, entity_i, entity_j);
 				}
 			} else {
 				if (collides(transform_i, transform_j))
 				{
-					// Create a collisions event
-					// We are abusing the ECS system a bit in that we potentially insert muliple collisions for the same entity
-					// If collision between player and enemy, always add the collision component under player entity
-					collisionhelper(entity_i, entity_j);
-					collisionhelper(entity_j, entity_i);
+					report_contact(registry, entity_i, entity_j);
 				}
 			}
 		}
 	}
+
+	// Pairs that were not touched again have separated
+	registry.contacts.end_step();
+}
+
+// Bullets are circles, so instead of joining the pairwise test above each on-screen bullet is
+// only tested against the on-screen entities it can hit. Hits are queued in the projectile pool.
+void check_projectile_collision(ECSRegistry& registry, const FrameContext& frame) {
+	ProjectilePool& projectiles = registry.projectiles;
+
+	// Gather the targets once per step
+	std::vector<Entity> enemy_targets;
+	std::vector<Entity> cyst_targets;
+	std::vector<Entity> player_targets;
+	for (Entity entity : registry.collidePlayers.entities) {
+		if (!registry.transforms.has(entity) || frame.is_outside_screen(registry.transforms.get(entity).position)) continue;
+		if (registry.enemies.has(entity)) {
+			// Dying enemies have lost their motion and no longer take bullets
+			if (!registry.deathTimers.has(entity)) enemy_targets.push_back(entity);
+		} else if (registry.cysts.has(entity)) {
+			cyst_targets.push_back(entity);
+		}
+	}
+	for (Entity entity : registry.players.entities) {
+		if (registry.transforms.has(entity) && !frame.is_outside_screen(registry.transforms.get(entity).position)) {
+			player_targets.push_back(entity);
+		}
+	}
+
+	auto hits_target = [&registry](const Transform& bullet_transform, Entity target) {
+		const Transform& target_transform = registry.transforms.get(target);
+		if (!collides_bounding_box(bullet_transform, target_transform)) return false;
+		if (registry.meshPtrs.has(target)) {
+			return collides_with_mesh(registry.meshPtrs.get(target), target_transform, bullet_transform);
+		}
+		return collides(bullet_transform, target_transform);
+	};
+	auto find_hit = [&](const Transform& bullet_transform, const std::vector<Entity>& targets, Entity& hit) {
+		for (Entity target : targets) {
+			if (hits_target(bullet_transform, target)) {
+				hit = target;
+				return true;
+			}
+		}
+		return false;
+	};
+
+	for (uint i = 0; i < projectiles.size(); i++) {
+		if (frame.is_outside_screen(projectiles.positions[i])) continue;
+
+		Transform bullet_transform;
+		bullet_transform.position = projectiles.positions[i];
+		bullet_transform.scale = vec2(projectiles.radii[i] * 2.f);
+
+		// A bullet reports at most one hit per step
+		Entity target;
+		if (projectiles.teams[i] & PROJECTILE_HITS_ENEMIES) {
+			if (find_hit(bullet_transform, enemy_targets, target)) {
+				projectiles.hits.push_back({ COLLISION_TYPE::BULLET_WITH_ENEMY, i, target });
+				continue;
+			}
+			if (find_hit(bullet_transform, cyst_targets, target)) {
+				projectiles.hits.push_back({ COLLISION_TYPE::BULLET_WITH_CYST, i, target });
+				continue;
+			}
+		}
+		if (projectiles.teams[i] & PROJECTILE_HITS_PLAYERS) {
+			if (find_hit(bullet_transform, player_targets, target)) {
+				projectiles.hits.push_back({ COLLISION_TYPE::BULLET_WITH_PLAYER, i, target });
+			}
+		}
+	}
 }
 
-void PhysicsSystem::step(float elapsed_ms)
+void PhysicsSystem::step(const FrameContext& frame)
 {
-	step_movement(elapsed_ms);
-	step_attachment_movement(elapsed_ms);	// Should handle these after setting all the positions
-	check_collision();
+	float elapsed_ms = frame.elapsed_ms;
+	step_movement(registry, elapsed_ms);
+	update_world_matrices();
+	step_attachment_movement(registry, elapsed_ms);	// Should handle these after setting all the positions
+	registry.projectiles.step(elapsed_ms);
+	check_collision(registry, frame);
+	check_projectile_collision(registry, frame);
 }
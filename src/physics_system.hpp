@@ -4,15 +4,36 @@
 #include "tiny_ecs.hpp"
 #include "components.hpp"
 #include "tiny_ecs_registry.hpp"
+#include "frame_context.hpp"
 
 // A simple physics system that moves rigid bodies and checks for collision
 class PhysicsSystem
 {
 public:
-	void step(float elapsed_ms);
-	static void update_attachment_orientation(Entity entity, float elapsed_ms);
+	void step(const FrameContext& frame);
+	static void update_attachment_orientation(ECSRegistry& registry, Entity entity, float elapsed_ms);
+	static void update_attachment_orientation(ECSRegistry& registry, Entity entity, const Transform& parent_transform, float elapsed_ms);
+	// Rebuilds the world matrix of every entity that is not an attachment and whose position,
+	// angle or scale changed since its matrix was last built
+	void update_world_matrices();
+	// Refreshes position, angle and scale from the world matrix
+	static void decompose_world_matrix(Transform& transform);
 
-	PhysicsSystem()
+	PhysicsSystem(ECSRegistry& registry)
+		: registry(registry)
 	{
 	}
+
+private:
+	ECSRegistry& registry;
+
+	// What the world matrix at the same index of registry.transforms was built from
+	struct WorldMatrixInput {
+		unsigned int entity = 0;
+		vec2 position;
+		float angle;
+		vec2 scale;
+	};
+	std::vector<WorldMatrixInput> built_from;
+	unsigned int built_restores = 0;	// A snapshot restore brings back matrices of another time
 };
\ No newline at end of file
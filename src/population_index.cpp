@@ -0,0 +1,47 @@
+// internal
+#include "population_index.hpp"
+
+// stlib
+#include <cassert>
+#include <cstring>
+
+int region_index(vec2 position) {
+	float angle = atan2f(position.y, position.x);
+	if (angle < 0.f) angle += 2 * M_PI;
+	int region = (int)(angle / (2 * M_PI / NUM_REGIONS));
+	return region < (int)NUM_REGIONS ? region : (int)NUM_REGIONS - 1;	// angle == 2 PI after rounding
+}
+
+PopulationIndex::PopulationIndex() {
+	memset(counts, 0, sizeof(counts));
+	memset(type_counts, 0, sizeof(type_counts));
+	memset(region_counts, 0, sizeof(region_counts));
+}
+
+void PopulationIndex::track(ComponentContainer<Enemy>& enemies, ComponentContainer<Transform>& transforms) {
+	enemies.on_insert = [this, &transforms](Entity entity, Enemy& enemy) {
+		// Enemies are created after their transform, see spawnPrefab
+		enemy.region = transforms.has(entity) ? region_index(transforms.get(entity).position) : 0;
+		add(enemy, 1);
+	};
+	enemies.on_remove = [this](Entity, Enemy& enemy) {
+		add(enemy, -1);
+	};
+}
+
+void PopulationIndex::rebuild(const ComponentContainer<Enemy>& enemies) {
+	memset(counts, 0, sizeof(counts));
+	memset(type_counts, 0, sizeof(type_counts));
+	memset(region_counts, 0, sizeof(region_counts));
+	for (const Enemy& enemy : enemies.components) {
+		add(enemy, 1);
+	}
+}
+
+void PopulationIndex::add(const Enemy& enemy, int delta) {
+	assert((int)enemy.type >= 0 && (int)enemy.type < enemy_type_count && enemy.region >= 0 && enemy.region < (int)NUM_REGIONS && "Enemy outside the index");
+	counts[(int)enemy.type][enemy.region] += delta;
+	type_counts[(int)enemy.type] += delta;
+	region_counts[enemy.region] += delta;
+	assert(type_counts[(int)enemy.type] >= 0 && "Enemy population out of sync");
+}
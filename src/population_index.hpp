@@ -0,0 +1,35 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "tiny_ecs.hpp"
+#include "components.hpp"
+
+// The map is split into NUM_REGIONS equal slices starting at angle 0, in the order createRandomRegions
+// creates them. Returns the slice a position falls into.
+int region_index(vec2 position);
+
+// Live enemy counts by ENEMY_ID and by region, updated by the insert/remove hooks of the enemy container
+// so they always match registry.enemies. An enemy is counted in the region it spawned in.
+class PopulationIndex
+{
+public:
+	PopulationIndex();
+
+	// Installs the hooks, the containers must outlive the index. Enemies are counted in the
+	// region of their transform.
+	void track(ComponentContainer<Enemy>& enemies, ComponentContainer<Transform>& transforms);
+	// Recounts all enemies by their stored region, e.g. after loading them
+	void rebuild(const ComponentContainer<Enemy>& enemies);
+
+	int count(ENEMY_ID type) const { return type_counts[(int)type]; }
+	int count(ENEMY_ID type, int region) const { return counts[(int)type][region]; }
+	int count_in_region(int region) const { return region_counts[region]; }
+
+private:
+	void add(const Enemy& enemy, int delta);
+
+	int counts[enemy_type_count][NUM_REGIONS];
+	int type_counts[enemy_type_count];
+	int region_counts[NUM_REGIONS];
+};
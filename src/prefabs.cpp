@@ -0,0 +1,216 @@
+// internal
+#include "prefabs.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// stlib
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+static const std::unordered_map<std::string, ENEMY_ID> enemy_names = {
+	{ "red", ENEMY_ID::RED },
+	{ "green", ENEMY_ID::GREEN },
+	{ "yellow", ENEMY_ID::YELLOW },
+	{ "friend_boss_clone", ENEMY_ID::FRIENDBOSSCLONE }
+};
+
+// Only the assets used by prefabs so far, extend as needed
+static const std::unordered_map<std::string, TEXTURE_ASSET_ID> texture_names = {
+	{ "RED_ENEMY", TEXTURE_ASSET_ID::RED_ENEMY },
+	{ "GREEN_ENEMY", TEXTURE_ASSET_ID::GREEN_ENEMY },
+	{ "GREEN_ENEMY_MOVING", TEXTURE_ASSET_ID::GREEN_ENEMY_MOVING },
+	{ "YELLOW_ENEMY", TEXTURE_ASSET_ID::YELLOW_ENEMY },
+	{ "FRIEND", TEXTURE_ASSET_ID::FRIEND }
+};
+
+static const std::unordered_map<std::string, EFFECT_ASSET_ID> effect_names = {
+	{ "COLOURED", EFFECT_ASSET_ID::COLOURED },
+	{ "TEXTURED", EFFECT_ASSET_ID::TEXTURED }
+};
+
+static const std::unordered_map<std::string, GEOMETRY_BUFFER_ID> geometry_names = {
+	{ "SPRITE", GEOMETRY_BUFFER_ID::SPRITE },
+	{ "SPRITESHEET_GREEN_ENEMY_MOVING", GEOMETRY_BUFFER_ID::SPRITESHEET_GREEN_ENEMY_MOVING }
+};
+
+static const std::unordered_map<std::string, RENDER_ORDER> order_names = {
+	{ "OBJECTS", RENDER_ORDER::OBJECTS },
+	{ "ENEMIES_BK", RENDER_ORDER::ENEMIES_BK },
+	{ "ENEMIES_FR", RENDER_ORDER::ENEMIES_FR },
+	{ "BOSS", RENDER_ORDER::BOSS }
+};
+
+template <typename T>
+static bool lookup(const std::unordered_map<std::string, T>& names, const json& value, T& out, const std::string& prefab_name) {
+	auto it = names.find(value.get<std::string>());
+	if (it == names.end()) {
+		fprintf(stderr, "Prefab %s: unknown name %s\n", prefab_name.c_str(), value.get<std::string>().c_str());
+		return false;
+	}
+	out = it->second;
+	return true;
+}
+
+static vec2 read_vec2(const json& value) {
+	return { value[0].get<float>(), value[1].get<float>() };
+}
+
+static vec4 read_vec4(const json& value) {
+	return { value[0].get<float>(), value[1].get<float>(), value[2].get<float>(), value[3].get<float>() };
+}
+
+bool PrefabLibrary::load(const std::string& path) {
+	std::ifstream file(path);
+	if (!file) {
+		fprintf(stderr, "Failed to open prefab file %s\n", path.c_str());
+		return false;
+	}
+
+	// Parsed aside, so a failed load keeps the prefabs it had
+	Prefab parsed[enemy_type_count];
+	try {
+		json data;
+		file >> data;
+		if (!parse(data, parsed)) return false;
+	}
+	catch (const json::exception& e) {
+		fprintf(stderr, "Prefab file %s: %s\n", path.c_str(), e.what());
+		return false;
+	}
+	for (auto& name : enemy_names) {
+		if (!parsed[(int)name.second].loaded) {
+			fprintf(stderr, "Prefab file %s: no prefab for %s\n", path.c_str(), name.first.c_str());
+			return false;
+		}
+	}
+	for (int i = 0; i < enemy_type_count; i++) {
+		prefabs[i] = parsed[i];
+	}
+	std::cout << "Loaded " << enemy_names.size() << " prefabs" << std::endl;
+	return true;
+}
+
+bool PrefabLibrary::parse(const json& data, Prefab (&parsed)[enemy_type_count]) {
+	for (auto& item : data.items()) {
+		const std::string& name = item.key();
+		const json& desc = item.value();
+		ENEMY_ID type;
+		if (!lookup(enemy_names, json(name), type, name)) return false;
+
+		Prefab prefab;
+		prefab.has_enemy = true;
+		prefab.enemy.type = type;
+		prefab.collide_players = desc.value("collide_players", false);
+		prefab.collide_enemies = desc.value("collide_enemies", false);
+
+		if (desc.contains("transform")) {
+			const json& t = desc["transform"];
+			if (t.contains("scale")) prefab.transform.scale = read_vec2(t["scale"]);
+			prefab.transform.angle_offset = t.value("angle_offset_deg", 0.f) * M_PI / 180.f;
+			prefab.transform.angle = prefab.transform.angle_offset;
+		}
+		if (desc.contains("motion")) {
+			const json& m = desc["motion"];
+			prefab.has_motion = true;
+			prefab.motion.max_velocity = m.value("max_velocity", prefab.motion.max_velocity);
+			if (m.contains("max_angular_velocity_deg")) {
+				prefab.motion.max_angular_velocity = m["max_angular_velocity_deg"].get<float>() * M_PI / 180.f;
+			}
+		}
+		if (desc.contains("health")) {
+			const json& h = desc["health"];
+			prefab.has_health = true;
+			if (h.is_string() && h.get<std::string>() == "game_mode") {
+				prefab.health_from_game_mode = true;
+			} else {
+				prefab.health.health = h.get<float>();
+			}
+		}
+		if (desc.contains("render")) {
+			const json& r = desc["render"];
+			prefab.has_render_request = true;
+			if (!lookup(texture_names, r["texture"], prefab.render_request.used_texture, name)
+				|| !lookup(effect_names, r["effect"], prefab.render_request.used_effect, name)
+				|| !lookup(geometry_names, r["geometry"], prefab.render_request.used_geometry, name)
+				|| !lookup(order_names, r["order"], prefab.render_request.order, name)) {
+				return false;
+			}
+		}
+		if (desc.contains("animation")) {
+			const json& a = desc["animation"];
+			prefab.has_animation = true;
+			prefab.animation.total_frame = a.value("total_frame", prefab.animation.total_frame);
+			prefab.animation.update_period_ms = a.value("update_period_ms", prefab.animation.update_period_ms);
+			prefab.animation.pause_animation = a.value("paused", false);
+		}
+		if (desc.contains("gun")) {
+			const json& g = desc["gun"];
+			prefab.has_gun = true;
+			prefab.gun.damage = g.value("damage", prefab.gun.damage);
+			prefab.gun.attack_delay = g.value("attack_delay", prefab.gun.attack_delay);
+			prefab.gun.bullet_speed = g.value("bullet_speed", prefab.gun.bullet_speed);
+			if (g.contains("bullet_size")) prefab.gun.bullet_size = read_vec2(g["bullet_size"]);
+			if (g.contains("bullet_color")) prefab.gun.bullet_color = read_vec4(g["bullet_color"]);
+		}
+
+		prefab.loaded = true;
+		parsed[(int)type] = prefab;
+	}
+	return true;
+}
+
+bool PrefabLibrary::acquire(ENEMY_ID id, Entity& entity) {
+	std::vector<Entity>& pool = pools.free_entities[(int)id];
+	if (pool.empty()) return false;
+	entity = pool.back();
+	pool.pop_back();
+	return true;
+}
+
+std::vector<Entity> spawnPrefab(ECSRegistry& registry, const Prefab& prefab, size_t n, const vec2* positions, const float* healths) {
+	assert(prefab.loaded && "Prefab not loaded");
+
+	// Grow every container once for the whole batch
+	registry.transforms.reserve_additional(n);
+	if (prefab.has_enemy) registry.enemies.reserve_additional(n);
+	if (prefab.has_motion) registry.motions.reserve_additional(n);
+	if (prefab.has_health) registry.healthValues.reserve_additional(n);
+	if (prefab.has_render_request) registry.renderRequests.reserve_additional(n);
+	if (prefab.has_animation) registry.animations.reserve_additional(n);
+	if (prefab.has_gun) registry.guns.reserve_additional(n);
+	if (prefab.collide_players) registry.collidePlayers.reserve_additional(n);
+	if (prefab.collide_enemies) registry.collideEnemies.reserve_additional(n);
+
+	Health health = prefab.health;
+	if (prefab.health_from_game_mode) {
+		health.health = registry.gameMode.components.back().enemy_health_map[prefab.enemy.type];
+	}
+
+	std::vector<Entity> entities;
+	entities.reserve(n);
+	for (size_t i = 0; i < n; i++) {
+		Entity entity;
+		if (!prefab.has_enemy || !registry.prefabs.acquire(prefab.enemy.type, entity)) {
+			entity = registry.create_entity();
+		}
+		entities.push_back(entity);
+
+		Transform transform = prefab.transform;
+		transform.position = positions[i];
+		registry.transforms.insert(entity, transform);
+
+		if (prefab.has_enemy) registry.enemies.insert(entity, prefab.enemy);
+		if (prefab.has_motion) registry.motions.insert(entity, prefab.motion);
+		if (prefab.has_health) {
+			Health instance_health = health;
+			if (healths) instance_health.health = healths[i];
+			registry.healthValues.insert(entity, instance_health);
+		}
+		if (prefab.has_render_request) registry.renderRequests.insert(entity, prefab.render_request);
+		if (prefab.has_animation) registry.animations.insert(entity, prefab.animation);
+		if (prefab.has_gun) registry.guns.insert(entity, prefab.gun);
+		if (prefab.collide_players) registry.collidePlayers.emplace(entity);
+		if (prefab.collide_enemies) registry.collideEnemies.emplace(entity);
+	}
+	return entities;
+}
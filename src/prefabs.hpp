@@ -0,0 +1,68 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "components.hpp"
+
+// stlib
+#include <string>
+#include <vector>
+
+// An entity template loaded from data/prefabs/*.json. Components are built once at load
+// time and copied into the registry on spawn; the has_* flags say which ones the prefab uses.
+struct Prefab {
+	bool loaded = false;
+
+	bool has_enemy = false;
+	Enemy enemy;
+	Transform transform;		// Position is set per instance
+	bool has_motion = false;
+	Motion motion;
+	bool has_health = false;
+	Health health;
+	bool health_from_game_mode = false;	// Use the current GameMode's enemy_health_map instead of health
+	bool has_render_request = false;
+	RenderRequest render_request;
+	bool has_animation = false;
+	Animation animation;
+	bool has_gun = false;
+	Gun gun;
+	bool collide_players = false;
+	bool collide_enemies = false;
+};
+
+// Prefabs for every ENEMY_ID that is spawned from data
+class PrefabLibrary
+{
+public:
+	// Parses the prefab file. Returns false on any error, including malformed JSON and enemy types
+	// without a prefab, and keeps the prefabs it had in that case.
+	bool load(const std::string& path);
+	const Prefab& get(ENEMY_ID id) const { return prefabs[(int)id]; }
+
+	// Hands a despawned instance back to the pool. The entity must have no components left, its
+	// number is reused by the next spawn of that type, one generation later so that handles still
+	// held to the old instance don't reach the new one.
+	void recycle(ENEMY_ID id, Entity entity) { pools.free_entities[(int)id].push_back(entity.next_generation()); }
+	// Takes a recycled entity of that type, false if there is none
+	bool acquire(ENEMY_ID id, Entity& entity);
+
+	// The recycled entities of every type, saved with registry snapshots
+	struct Pools {
+		std::vector<Entity> free_entities[enemy_type_count];
+	};
+	const Pools& get_pools() const { return pools; }
+	void set_pools(const Pools& saved) { pools = saved; }
+
+private:
+	bool parse(const json& data, Prefab (&parsed)[enemy_type_count]);
+
+	Prefab prefabs[enemy_type_count];
+	Pools pools;
+};
+
+class ECSRegistry;
+
+// Instantiates n copies of a prefab at the given positions. Every container involved is grown
+// once for the whole batch. healths is optional and overrides the prefab's health per instance.
+std::vector<Entity> spawnPrefab(ECSRegistry& registry, const Prefab& prefab, size_t n, const vec2* positions, const float* healths = nullptr);
@@ -0,0 +1,95 @@
+// internal
+#include "projectile_pool.hpp"
+
+// stlib
+#include <algorithm>
+
+void ProjectilePool::spawn(vec2 position, vec2 velocity, float radius, float damage, vec4 color, uint8_t team, float lifetime_ms) {
+	positions.push_back(position);
+	velocities.push_back(velocity);
+	radii.push_back(radius);
+	damages.push_back(damage);
+	colors.push_back(color);
+	teams.push_back(team);
+	lifetimes.push_back(lifetime_ms);
+}
+
+void ProjectilePool::reserve_additional(size_t n) {
+	size_t required = size() + n;
+	if (positions.capacity() >= required) return;
+	// Keep the geometric growth of the vectors
+	size_t grown = std::max(required, positions.capacity() * 2);
+	positions.reserve(grown);
+	velocities.reserve(grown);
+	radii.reserve(grown);
+	damages.reserve(grown);
+	colors.reserve(grown);
+	teams.reserve(grown);
+	lifetimes.reserve(grown);
+}
+
+void ProjectilePool::step(float elapsed_ms) {
+	remove_dead();
+
+	float elapsed_seconds = elapsed_ms / 1000.f;
+	for (uint i = 0; i < size(); i++) {
+		positions[i] += velocities[i] * elapsed_seconds;
+		lifetimes[i] -= elapsed_ms;
+		// Bullets do not bounce off the map boundary
+		if (length(positions[i]) > MAP_RADIUS - radii[i]) {
+			lifetimes[i] = 0.f;
+		}
+	}
+
+	remove_dead();
+}
+
+void ProjectilePool::cull_outside(vec2 center, float max_distance) {
+	float max_distance_squared = max_distance * max_distance;
+	for (uint i = 0; i < size(); i++) {
+		vec2 offset = positions[i] - center;
+		if (dot(offset, offset) > max_distance_squared) {
+			lifetimes[i] = 0.f;
+		}
+	}
+	remove_dead();
+}
+
+void ProjectilePool::clear() {
+	positions.clear();
+	velocities.clear();
+	radii.clear();
+	damages.clear();
+	colors.clear();
+	teams.clear();
+	lifetimes.clear();
+	hits.clear();
+}
+
+void ProjectilePool::remove(uint i) {
+	uint last = (uint)size() - 1;
+	positions[i] = positions[last];
+	velocities[i] = velocities[last];
+	radii[i] = radii[last];
+	damages[i] = damages[last];
+	colors[i] = colors[last];
+	teams[i] = teams[last];
+	lifetimes[i] = lifetimes[last];
+
+	positions.pop_back();
+	velocities.pop_back();
+	radii.pop_back();
+	damages.pop_back();
+	colors.pop_back();
+	teams.pop_back();
+	lifetimes.pop_back();
+}
+
+void ProjectilePool::remove_dead() {
+	// Iterate backwards so the bullet swapped in has already been checked
+	for (int i = (int)size() - 1; i >= 0; i--) {
+		if (lifetimes[i] <= 0.f) {
+			remove(i);
+		}
+	}
+}
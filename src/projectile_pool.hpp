@@ -0,0 +1,59 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "components.hpp"
+
+// stlib
+#include <vector>
+
+// Which side a bullet can hurt. A bullet inherits these from its shooter's CollideEnemy/CollidePlayer.
+const uint8_t PROJECTILE_HITS_ENEMIES = 1 << 0;
+const uint8_t PROJECTILE_HITS_PLAYERS = 1 << 1;
+
+// Bullets live outside the generic component containers: they are the most numerous and
+// shortest-lived objects, so they are kept as parallel arrays (structure of arrays) that
+// are integrated, culled, collided and drawn in tight loops. Removal swaps the last bullet
+// into the freed slot, so indices are only stable until the next removal.
+struct ProjectileHit {
+	COLLISION_TYPE type;	// BULLET_WITH_ENEMY, BULLET_WITH_CYST or BULLET_WITH_PLAYER
+	uint projectile;		// Index into the pool
+	Entity target;
+};
+
+class ProjectilePool
+{
+public:
+	std::vector<vec2> positions;
+	std::vector<vec2> velocities;	// Pixels per second
+	std::vector<float> radii;
+	std::vector<float> damages;
+	std::vector<vec4> colors;
+	std::vector<uint8_t> teams;		// PROJECTILE_HITS_* flags
+	std::vector<float> lifetimes;	// Remaining milliseconds, bullets at 0 are removed
+
+	// Filled by the physics system, consumed by WorldSystem::resolve_collisions
+	std::vector<ProjectileHit> hits;
+
+	void spawn(vec2 position, vec2 velocity, float radius, float damage, vec4 color, uint8_t team, float lifetime_ms = PROJECTILE_LIFETIME_MS);
+	// Make room for n more bullets, e.g. before emitting a pattern
+	void reserve_additional(size_t n);
+
+	// Moves every bullet and ages it; bullets past the map boundary or out of time are removed
+	void step(float elapsed_ms);
+	// Removes bullets further than max_distance from center
+	void cull_outside(vec2 center, float max_distance);
+
+	// Marks a bullet for removal at the next step, e.g. after it hit something
+	void kill(uint i) { lifetimes[i] = 0.f; }
+	bool is_alive(uint i) const { return lifetimes[i] > 0.f; }
+
+	size_t size() const { return positions.size(); }
+	void clear();
+
+	static constexpr float PROJECTILE_LIFETIME_MS = 10000.f;
+
+private:
+	void remove(uint i);
+	void remove_dead();
+};
@@ -0,0 +1,84 @@
+// internal
+#include "random_service.hpp"
+
+// stlib
+#include <assert.h>
+
+// Philox4x32 round constants
+static const uint32_t PHILOX_M0 = 0xD2511F53;
+static const uint32_t PHILOX_M1 = 0xCD9E8D57;
+static const uint32_t PHILOX_W0 = 0x9E3779B9;	// golden ratio
+static const uint32_t PHILOX_W1 = 0xBB67AE85;	// sqrt(3) - 1
+static const int PHILOX_ROUNDS = 10;
+
+// Tick value reserved for persistent streams so they never alias a per-tick stream
+static const uint64_t PERSISTENT_TICK = ~0ull;
+
+static void philox_round(uint32_t ctr[4], const uint32_t key[2]) {
+	uint64_t prod0 = (uint64_t)PHILOX_M0 * ctr[0];
+	uint64_t prod1 = (uint64_t)PHILOX_M1 * ctr[2];
+	uint32_t hi0 = (uint32_t)(prod0 >> 32), lo0 = (uint32_t)prod0;
+	uint32_t hi1 = (uint32_t)(prod1 >> 32), lo1 = (uint32_t)prod1;
+	uint32_t c1 = ctr[1], c3 = ctr[3];
+	ctr[0] = hi1 ^ c1 ^ key[0];
+	ctr[1] = lo1;
+	ctr[2] = hi0 ^ c3 ^ key[1];
+	ctr[3] = lo0;
+}
+
+RandomStream::RandomStream(uint32_t seed, uint32_t stream, uint32_t entity, uint64_t tick) {
+	key[0] = seed;
+	key[1] = stream;
+	counter[0] = 0;		// block index within the stream
+	counter[1] = entity;
+	counter[2] = (uint32_t)tick;
+	counter[3] = (uint32_t)(tick >> 32);
+	block_index = 4;	// empty, refill on first draw
+}
+
+void RandomStream::refill() {
+	uint32_t k[2] = { key[0], key[1] };
+	for (int i = 0; i < 4; i++) block[i] = counter[i];
+	for (int r = 0; r < PHILOX_ROUNDS; r++) {
+		if (r > 0) {
+			k[0] += PHILOX_W0;
+			k[1] += PHILOX_W1;
+		}
+		philox_round(block, k);
+	}
+	counter[0]++;
+	block_index = 0;
+}
+
+RandomStream::result_type RandomStream::operator()() {
+	if (block_index >= 4) refill();
+	return block[block_index++];
+}
+
+float RandomStream::uniform() {
+	// top 24 bits fill the float mantissa exactly, so the result is strictly below 1
+	return (float)((*this)() >> 8) * (1.f / 16777216.f);
+}
+
+float RandomStream::uniform(float lo, float hi) {
+	return lo + (hi - lo) * uniform();
+}
+
+int RandomStream::uniform_int(int n) {
+	assert(n > 0);
+	// Lemire's multiply-shift; bias is negligible for the small ranges used in game code
+	return (int)(((uint64_t)(*this)() * (uint64_t)n) >> 32);
+}
+
+void RandomService::reseed(uint32_t seed) {
+	this->seed = seed;
+	tick = 0;
+}
+
+RandomStream RandomService::stream(RNG_STREAM_ID id, unsigned int entity) const {
+	return RandomStream(seed, (uint32_t)id, entity, tick);
+}
+
+RandomStream RandomService::persistent_stream(RNG_STREAM_ID id) const {
+	return RandomStream(seed, (uint32_t)id, 0, PERSISTENT_TICK);
+}
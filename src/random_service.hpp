@@ -0,0 +1,70 @@
+#pragma once
+
+// stlib
+#include <cstdint>
+#include <limits>
+
+// Independent random streams. Every call site that draws random numbers owns one id so
+// that adding draws in one place never shifts the sequence seen by another.
+enum class RNG_STREAM_ID {
+	WORLD = 0,
+	EFFECTS = WORLD + 1,
+	AI_BEHAVIOUR = EFFECTS + 1,
+	MENU = AI_BEHAVIOUR + 1,
+	AUTOPLAY = MENU + 1,
+	RNG_STREAM_COUNT = AUTOPLAY + 1
+};
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+// The output is a pure function of (key, counter), so a stream needs no shared state and
+// gives the same numbers no matter which thread evaluates it or in which order.
+// Satisfies UniformRandomBitGenerator, so it works with std distributions and std::shuffle.
+class RandomStream
+{
+public:
+	using result_type = uint32_t;
+
+	RandomStream(uint32_t seed = 0, uint32_t stream = 0, uint32_t entity = 0, uint64_t tick = 0);
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+	result_type operator()();
+
+	// float in [0, 1)
+	float uniform();
+	// float in [lo, hi)
+	float uniform(float lo, float hi);
+	// int in [0, n)
+	int uniform_int(int n);
+
+private:
+	uint32_t key[2];
+	uint32_t counter[4];
+	uint32_t block[4];
+	int block_index;
+
+	void refill();
+};
+
+// Owns the game seed and the simulation tick. Streams handed out for the same
+// (stream id, entity) during the same tick are identical, which is what makes
+// AI decisions reproducible from the seed alone.
+class RandomService
+{
+public:
+	void reseed(uint32_t seed);
+	uint32_t get_seed() const { return seed; }
+
+	// Called once per simulated step
+	void advance_tick() { tick++; }
+	uint64_t get_tick() const { return tick; }
+
+	// Stream keyed by seed + id + entity + current tick. Cheap to create; make one on the stack per use.
+	RandomStream stream(RNG_STREAM_ID id, unsigned int entity = 0) const;
+	// Long-lived stream independent of the tick, for systems that draw sequentially (e.g. world generation)
+	RandomStream persistent_stream(RNG_STREAM_ID id) const;
+
+private:
+	uint32_t seed = 0;
+	uint64_t tick = 0;
+};
@@ -0,0 +1,238 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+
+// stlib
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Compile time field lists of components. A component is registered once with
+//   REFLECT_COMPONENT(Motion, "motions", velocity, angular_velocity, ...)
+// which specializes Reflection<Motion>. Reflection<T>::visit(component, visitor) then calls
+// visitor(name, field) for every listed field, which is all the JSON and binary codecs below
+// need to serialize any registered component. Components without fields use REFLECT_TAG.
+template <typename Component>
+struct Reflection;
+
+// Applies M to every argument, up to 16 of them
+#define REFLECT_EXPAND(x) x
+#define REFLECT_FE_1(M, x) M(x)
+#define REFLECT_FE_2(M, x, ...) M(x) REFLECT_EXPAND(REFLECT_FE_1(M, __VA_ARGS__))
+#define REFLECT_FE_3(M, x, ...) M(x) REFLECT_EXPAND(REFLECT_FE_2(M, __VA_ARGS__))
+#define REFLECT_FE_4(M, x, ...) M(x) REFLECT_EXPAND(REFLECT_FE_3(M, __VA_ARGS__))
+#define REFLECT_FE_5(M, x, ...) M(x) REFLECT_EXPAND(REFLECT_FE_4(M, __VA_ARGS__))
+#define REFLECT_FE_6(M, x, ...) M(x) REFLECT_EXPAND(REFLECT_FE_5(M, __VA_ARGS__))
+#define REFLECT_FE_7(M, x, ...) M(x) REFLECT_EXPAND(REFLECT_FE_6(M, __VA_ARGS__))
+#define REFLECT_FE_8(M, x, ...) M(x) REFLECT_EXPAND(REFLECT_FE_7(M, __VA_ARGS__))
+#define REFLECT_FE_9(M, x, ...) M(x) REFLECT_EXPAND(REFLECT_FE_8(M, __VA_ARGS__))
+#define REFLECT_FE_10(M, x, ...) M(x) REFLECT_EXPAND(REFLECT_FE_9(M, __VA_ARGS__))
+#define REFLECT_FE_11(M, x, ...) M(x) REFLECT_EXPAND(REFLECT_FE_10(M, __VA_ARGS__))
+#define REFLECT_FE_12(M, x, ...) M(x) REFLECT_EXPAND(REFLECT_FE_11(M, __VA_ARGS__))
+#define REFLECT_FE_13(M, x, ...) M(x) REFLECT_EXPAND(REFLECT_FE_12(M, __VA_ARGS__))
+#define REFLECT_FE_14(M, x, ...) M(x) REFLECT_EXPAND(REFLECT_FE_13(M, __VA_ARGS__))
+#define REFLECT_FE_15(M, x, ...) M(x) REFLECT_EXPAND(REFLECT_FE_14(M, __VA_ARGS__))
+#define REFLECT_FE_16(M, x, ...) M(x) REFLECT_EXPAND(REFLECT_FE_15(M, __VA_ARGS__))
+#define REFLECT_FE_PICK(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, NAME, ...) NAME
+#define REFLECT_FOR_EACH(M, ...) REFLECT_EXPAND(REFLECT_FE_PICK(__VA_ARGS__, \
+	REFLECT_FE_16, REFLECT_FE_15, REFLECT_FE_14, REFLECT_FE_13, REFLECT_FE_12, REFLECT_FE_11, REFLECT_FE_10, REFLECT_FE_9, \
+	REFLECT_FE_8, REFLECT_FE_7, REFLECT_FE_6, REFLECT_FE_5, REFLECT_FE_4, REFLECT_FE_3, REFLECT_FE_2, REFLECT_FE_1)(M, __VA_ARGS__))
+
+#define REFLECT_VISIT_FIELD(field) visitor(#field, component.field);
+
+#define REFLECT_COMPONENT(Type, Name, ...) \
+	template <> \
+	struct Reflection<Type> { \
+		static const char* name() { return Name; } \
+		template <typename C, typename Visitor> \
+		static void visit(C& component, Visitor& visitor) { REFLECT_FOR_EACH(REFLECT_VISIT_FIELD, __VA_ARGS__) } \
+	};
+
+#define REFLECT_TAG(Type, Name) \
+	template <> \
+	struct Reflection<Type> { \
+		static const char* name() { return Name; } \
+		template <typename C, typename Visitor> \
+		static void visit(C&, Visitor&) {} \
+	};
+
+/////////////////////////////////////////
+// Field values as JSON. Enums are stored as ints, vectors and matrices as arrays of floats.
+
+template <typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0>
+void field_to_json(json& out, const T& value) { out = value; }
+template <typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0>
+void field_from_json(const json& in, T& value) { value = in.get<T>(); }
+
+// JSON has no infinity or NaN (e.g. the timer of a dead boss), those are stored as strings
+inline void field_to_json(json& out, const float& value) {
+	if (std::isnan(value)) out = "nan";
+	else if (std::isinf(value)) out = value > 0.f ? "inf" : "-inf";
+	else out = value;
+}
+inline void field_from_json(const json& in, float& value) {
+	if (!in.is_string()) value = in.get<float>();
+	else if (in == "inf") value = INFINITY;
+	else if (in == "-inf") value = -INFINITY;
+	else value = NAN;
+}
+
+template <typename T, typename std::enable_if<std::is_enum<T>::value, int>::type = 0>
+void field_to_json(json& out, const T& value) { out = (int)value; }
+template <typename T, typename std::enable_if<std::is_enum<T>::value, int>::type = 0>
+void field_from_json(const json& in, T& value) { value = (T)in.get<int>(); }
+
+inline void field_to_json(json& out, const Entity& value) { out = (unsigned int)Entity(value); }
+inline void field_from_json(const json& in, Entity& value) { value = Entity(in.get<unsigned int>()); }
+
+template <int N>
+void field_to_json(json& out, const glm::vec<N, float, glm::defaultp>& value) {
+	out = json::array();
+	for (int i = 0; i < N; i++) field_to_json(out[i], value[i]);
+}
+template <int N>
+void field_from_json(const json& in, glm::vec<N, float, glm::defaultp>& value) {
+	for (int i = 0; i < N; i++) field_from_json(in.at(i), value[i]);
+}
+
+inline void field_to_json(json& out, const mat3& value) {
+	out = json::array();
+	for (int c = 0; c < 3; c++)
+		for (int r = 0; r < 3; r++) field_to_json(out[c * 3 + r], value[c][r]);
+}
+inline void field_from_json(const json& in, mat3& value) {
+	for (int c = 0; c < 3; c++)
+		for (int r = 0; r < 3; r++) field_from_json(in.at(c * 3 + r), value[c][r]);
+}
+
+inline void field_to_json(json& out, const Transformation& value) { field_to_json(out, value.mat); }
+inline void field_from_json(const json& in, Transformation& value) { field_from_json(in, value.mat); }
+
+template <typename T, size_t N>
+void field_to_json(json& out, const T (&values)[N]) {
+	out = json::array();
+	for (size_t i = 0; i < N; i++) {
+		json item;
+		field_to_json(item, values[i]);
+		out.push_back(item);
+	}
+}
+template <typename T, size_t N>
+void field_from_json(const json& in, T (&values)[N]) {
+	for (size_t i = 0; i < N && i < in.size(); i++) field_from_json(in.at(i), values[i]);
+}
+
+// Entries in key order, so equal maps are encoded the same
+template <typename K, typename V>
+std::vector<std::pair<K, V>> sorted_entries(const std::unordered_map<K, V>& values) {
+	std::vector<std::pair<K, V>> entries(values.begin(), values.end());
+	std::sort(entries.begin(), entries.end(), [](const std::pair<K, V>& a, const std::pair<K, V>& b) { return a.first < b.first; });
+	return entries;
+}
+
+// As a list of [key, value] pairs, since keys are not always strings
+template <typename K, typename V>
+void field_to_json(json& out, const std::unordered_map<K, V>& values) {
+	out = json::array();
+	for (const auto& entry : sorted_entries(values)) {
+		json key, value;
+		field_to_json(key, entry.first);
+		field_to_json(value, entry.second);
+		out.push_back({ key, value });
+	}
+}
+template <typename K, typename V>
+void field_from_json(const json& in, std::unordered_map<K, V>& values) {
+	values.clear();
+	for (const json& entry : in) {
+		K key;
+		V value;
+		field_from_json(entry[0], key);
+		field_from_json(entry[1], value);
+		values[key] = value;
+	}
+}
+
+struct JsonFieldWriter {
+	json& out;
+	template <typename T>
+	void operator()(const char* name, const T& value) { field_to_json(out[name], value); }
+};
+
+// Fields missing from the JSON keep their defaults
+struct JsonFieldReader {
+	const json& in;
+	template <typename T>
+	void operator()(const char* name, T& value) {
+		auto it = in.find(name);
+		if (it != in.end()) field_from_json(*it, value);
+	}
+};
+
+/////////////////////////////////////////
+// Field values as packed bytes, for components that can't be copied as a whole
+
+template <typename T, typename std::enable_if<std::is_trivially_copyable<T>::value, int>::type = 0>
+void field_to_bytes(std::vector<char>& out, const T& value) {
+	const char* bytes = (const char*)&value;
+	out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+template <typename T, typename std::enable_if<std::is_trivially_copyable<T>::value, int>::type = 0>
+bool field_from_bytes(const char*& in, const char* end, T& value) {
+	if ((size_t)(end - in) < sizeof(T)) return false;
+	memcpy(&value, in, sizeof(T));
+	in += sizeof(T);
+	return true;
+}
+
+template <typename K, typename V>
+void field_to_bytes(std::vector<char>& out, const std::unordered_map<K, V>& values) {
+	field_to_bytes(out, (uint32_t)values.size());
+	for (const auto& entry : sorted_entries(values)) {
+		field_to_bytes(out, entry.first);
+		field_to_bytes(out, entry.second);
+	}
+}
+template <typename K, typename V>
+bool field_from_bytes(const char*& in, const char* end, std::unordered_map<K, V>& values) {
+	uint32_t count;
+	if (!field_from_bytes(in, end, count)) return false;
+	values.clear();
+	for (uint32_t i = 0; i < count; i++) {
+		K key;
+		V value;
+		if (!field_from_bytes(in, end, key) || !field_from_bytes(in, end, value)) return false;
+		values[key] = value;
+	}
+	return true;
+}
+
+struct BinaryFieldWriter {
+	std::vector<char>& out;
+	template <typename T>
+	void operator()(const char*, const T& value) { field_to_bytes(out, value); }
+};
+
+struct BinaryFieldReader {
+	const char*& in;
+	const char* end;
+	bool ok = true;
+	template <typename T>
+	void operator()(const char*, T& value) { ok = ok && field_from_bytes(in, end, value); }
+};
+
+/////////////////////////////////////////
+// Rewrites the Entity fields of a component, e.g. when entities get new ids on load
+
+template <typename Map>
+struct EntityFieldRemapper {
+	Map& map;
+	template <typename T>
+	void operator()(const char*, T&) {}
+	void operator()(const char*, Entity& entity) { entity = map(entity); }
+};
@@ -0,0 +1,32 @@
+// internal
+#include "registry_snapshot.hpp"
+
+// stlib
+#include <cassert>
+
+SnapshotRing::SnapshotRing(ECSRegistry& registry, size_t capacity) : registry(registry) {
+	assert(capacity > 0);
+	slots.reserve(capacity);
+	for (size_t i = 0; i < capacity; i++) {
+		slots.push_back(registry.create_snapshot());
+	}
+}
+
+void SnapshotRing::push() {
+	registry.save_snapshot(slots[next]);
+	next = (next + 1) % slots.size();
+	if (count < slots.size()) count++;
+}
+
+bool SnapshotRing::restore(size_t back) {
+	if (back >= count) return false;
+	registry.restore_snapshot(slots[slot(back)]);
+	next = (slot(back) + 1) % slots.size();
+	count -= back;
+	return true;
+}
+
+uint64_t SnapshotRing::tick(size_t back) const {
+	assert(back < count);
+	return slots[slot(back)].random.get_tick();
+}
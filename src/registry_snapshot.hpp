@@ -0,0 +1,48 @@
+#pragma once
+
+// internal
+#include "tiny_ecs_registry.hpp"
+
+// stlib
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+// A fixed number of registry snapshots, allocated up front. Pushing a snapshot overwrites the
+// oldest one once the ring is full, e.g. a checkpoint every few seconds to rewind a replay or to
+// retry a fight. Restores are bulk copies, see ECSRegistry::restore_snapshot for what they cover.
+class SnapshotRing
+{
+public:
+	SnapshotRing(ECSRegistry& registry, size_t capacity);
+
+	// Saves the current state of the registry as the latest snapshot
+	void push();
+
+	// Restores the snapshot taken back pushes ago, 0 is the latest. The newer ones are dropped, so
+	// the restored snapshot is the latest afterwards and can be restored again. False if the ring
+	// holds no such snapshot.
+	bool restore(size_t back = 0);
+
+	// Simulation tick the snapshot was taken at, see RandomService::get_tick
+	uint64_t tick(size_t back = 0) const;
+
+	// Slot of the snapshot taken back pushes ago, for state kept next to the ring
+	size_t slot_of(size_t back = 0) const {
+		assert(back < count);
+		return slot(back);
+	}
+
+	size_t size() const { return count; }
+	size_t capacity() const { return slots.size(); }
+	// Forgets all snapshots, their memory is kept
+	void clear() { count = 0; }
+
+private:
+	size_t slot(size_t back) const { return (next + slots.size() - 1 - back) % slots.size(); }
+
+	ECSRegistry& registry;
+	std::vector<RegistrySnapshot> slots;
+	size_t next = 0;	// Slot the next push writes
+	size_t count = 0;
+};
@@ -168,6 +168,47 @@ void RenderSystem::drawEntity(
 	gl_has_errors();
 }
 
+// Draws every bullet of the projectile pool. They all share the same program and geometry,
+// so the GL state is set up once and only the per-bullet uniforms change inside the loop.
+void RenderSystem::drawProjectiles(const FrameContext& frame)
+{
+	const mat3& viewProjection = frame.view_projection;
+	const ProjectilePool& projectiles = registry.projectiles;
+	if (projectiles.size() == 0) return;
+
+	const GLuint program = (GLuint)effects[(GLuint)EFFECT_ASSET_ID::COLOURED];
+	glUseProgram(program);
+	const GLuint vbo = vertex_buffers[(GLuint)GEOMETRY_BUFFER_ID::BULLET];
+	const GLuint ibo = index_buffers[(GLuint)GEOMETRY_BUFFER_ID::BULLET];
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	gl_has_errors();
+
+	GLuint transform_loc = glGetUniformLocation(program, "transform");
+	GLuint viewProjection_loc = glGetUniformLocation(program, "viewProjection");
+	GLint color_uloc = glGetUniformLocation(program, "fcolor");
+	glUniformMatrix3fv(viewProjection_loc, 1, GL_FALSE, (float*)&viewProjection);
+	setColouredShaderVars(frame.player);	// the entity is unused for coloured meshes
+	gl_has_errors();
+
+	GLint size = 0;
+	glGetBufferParameteriv(GL_ELEMENT_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
+	GLsizei num_indices = size / sizeof(uint16_t);
+
+	for (uint i = 0; i < projectiles.size(); i++) {
+		// View frustum culling
+		if (frame.is_outside_screen(projectiles.positions[i], 1.2f)) continue;
+
+		Transformation transformation;
+		transformation.translate(projectiles.positions[i]);
+		transformation.scale(vec2(projectiles.radii[i] * 2.f));
+		glUniformMatrix3fv(transform_loc, 1, GL_FALSE, (float*)&transformation.mat);
+		glUniform4fv(color_uloc, 1, (float*)&projectiles.colors[i]);
+		glDrawElements(GL_TRIANGLES, num_indices, GL_UNSIGNED_SHORT, nullptr);
+	}
+	gl_has_errors();
+}
+
 // draw the intermediate texture to the screen
 void RenderSystem::drawToScreen()
 {
@@ -229,17 +270,9 @@ void RenderSystem::drawToScreen()
 
 }
 
-// helper function for view frustum culling
-bool RenderSystem::is_outside_screen(vec2 entityPos) {
-	assert(registry.camera.size() == 1);
-	vec2 camPos = registry.camera.components[0].position;
-	// check a radius a bit bigger than screen so we don't cull big objects too soon
-	return length(entityPos - camPos) > SCREEN_RADIUS * 1.2;
-}
-
 // Render our game world
 // http://www.opengl-tutorial.org/intermediate-tutorials/tutorial-14-render-to-texture/
-void RenderSystem::draw()
+void RenderSystem::draw(const FrameContext& frame)
 {
 	// Getting size of window
 	int w, h;
@@ -260,15 +293,8 @@ void RenderSystem::draw()
 	// and alpha blending, one would have to sort
 	// sprites back to front
 	gl_has_errors();
-	mat3 projection_2D = createProjectionMatrix();
-	mat3 view = createViewMatrix();
-	mat3 viewProjection = projection_2D * view;
-
-	// update player entity (it might change on death)
-	auto players = registry.players.entities;
-	if (!players.empty()) {
-		player = players.back();
-	}
+	const mat3& projection_2D = frame.projection;
+	const mat3& viewProjection = frame.view_projection;
 
 	// Draw entities based on their renderRequest order
 	/*
@@ -284,28 +310,27 @@ void RenderSystem::draw()
 					Transform& transform = registry.transforms.get(entity);
 
 					// View frustum culling; ie. cull entities before vertex shader
+					// check a radius a bit bigger than screen so we don't cull big objects too soon
 					// exclude on-screen entities, regions, and UI elements from culling
-					if (!registry.regions.has(entity) && !transform.is_screen_coord && is_outside_screen(transform.position)) {
+					if (!registry.regions.has(entity) && !transform.is_screen_coord && frame.is_outside_screen(transform.position, 1.2f)) {
 						continue;
 					}
 
-					// Transformation
-					Transformation transformation;
-					transformation.translate(transform.position);
-					transformation.rotate(transform.angle);
-					transformation.scale(transform.scale);
 					// Note, its not very efficient to access elements indirectly via the entity
 					// albeit iterating through all Sprites in sequence. A good point to optimize
 
 					if (transform.is_screen_coord) {
-						drawEntity(entity, render_request, transformation.mat, projection_2D);
+						drawEntity(entity, render_request, transform.world, projection_2D);
 					}
 					else {
-						drawEntity(entity, render_request, transformation.mat, viewProjection);
+						drawEntity(entity, render_request, transform.world, viewProjection);
 					}
 				}
 			}
 		}
+		if (order == (uint)RENDER_ORDER::OBJECTS) {
+			drawProjectiles(frame);
+		}
 	}
 
 	// Truely render to the screen
@@ -316,24 +341,3 @@ void RenderSystem::draw()
 	gl_has_errors();
 }
 
-// Orthographic Projection
-// basically converts Viewing Coordinate System -> Device Coordinate System
-mat3 RenderSystem::createProjectionMatrix()
-{
-	// Fake projection matrix, scales with respect to window coordinates
-	gl_has_errors();
-	Transformation projection;
-	projection.scale({ 2.f / CONTENT_WIDTH_PX, 2.f / CONTENT_HEIGHT_PX });
-	return projection.mat;
-}
-
-mat3 RenderSystem::createViewMatrix()
-{
-	offset = vec2(0.f, 0.f);
-	
-	assert(registry.camera.size() == 1);
-	vec2 cameraPos = registry.camera.components[0].position;
-	Transformation view;
-	view.translate(-cameraPos);
-	return view.mat;
-}
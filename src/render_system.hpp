@@ -5,6 +5,7 @@
 
 #include "common.hpp"
 #include "components.hpp"
+#include "frame_context.hpp"
 #include "tiny_ecs.hpp"
 
 // System responsible for setting up OpenGL and for rendering all the
@@ -141,6 +142,8 @@ class RenderSystem {
 	std::array<Mesh, geometry_count> meshes;
 
 public:
+	RenderSystem(ECSRegistry& registry) : registry(registry) {}
+
 	// Initialize the window
 	bool init(GLFWwindow* window);
 
@@ -164,28 +167,19 @@ public:
 	~RenderSystem();
 
 	// Draw all entities
-	void draw();
-
-	mat3 createProjectionMatrix();
-
-	mat3 createViewMatrix();
-	vec2 offset;
-
-	bool is_outside_screen(vec2 entityPos);
+	void draw(const FrameContext& frame);
 
 
 	//animation system
 	void initAnimation(GEOMETRY_BUFFER_ID gid, ANIMATION_FRAME_COUNT fcount);
 	void animationSys_step(float elapsed_ms);
 	void animationSys_init();
-	static void animationSys_switchAnimation(Entity& entity, 
+	static void animationSys_switchAnimation(ECSRegistry& registry, Entity& entity, 
 		ANIMATION_FRAME_COUNT animationType, 
 		int update_period_ms);
 	void initAnimation_dashing();
 	
 private:
-	Entity player; // Keep reference to player entity
-
 	// Internal drawing functions for each entity type
 	void drawEntity(
 		Entity entity,
@@ -193,6 +187,7 @@ private:
 		const mat3& transform,
 		const mat3& viewProjection
 	);
+	void drawProjectiles(const FrameContext& frame);
 	// void drawBackground(const mat3& viewProjection);
 	void drawToScreen();
 	void setUniformShaderVars(
@@ -212,6 +207,7 @@ private:
 	GLuint off_screen_render_buffer_color;
 	GLuint off_screen_render_buffer_depth;
 
+	ECSRegistry& registry;
 	Entity screen_state_entity;
 	
 };
@@ -0,0 +1,641 @@
+// internal
+#include "save_game.hpp"
+#include "world_serializer.hpp"
+
+// stlib
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+static const char SAVE_GAME_MAGIC[4] = { 'C', 'C', 'S', 'V' };
+static const size_t SAVE_HEADER_SIZE = 16;
+static const size_t SAVE_SECTION_HEADER_SIZE = 8;
+
+// Records are copied byte for byte, so they must not carry pointers or hidden padding
+static_assert(sizeof(SavedGame) == 8, "SavedGame is packed");
+static_assert(sizeof(SavedPlayer) == 12, "SavedPlayer is packed");
+static_assert(sizeof(SavedRegion) == 28, "SavedRegion is packed");
+static_assert(sizeof(SavedEnemy) == 16, "SavedEnemy is packed");
+static_assert(sizeof(SavedCyst) == 12, "SavedCyst is packed");
+static_assert(sizeof(SavedChest) == 12, "SavedChest is packed");
+static_assert(sizeof(SavedWorldHandles) == 16, "SavedWorldHandles is packed");
+static_assert(sizeof(SavedTimedEvent) == 48, "SavedTimedEvent is packed");
+static_assert(sizeof(SavedProjectile) == 48, "SavedProjectile is packed");
+
+static uint32_t fnv1a(const char* data, size_t size) {
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < size; i++) {
+		hash = (hash ^ (uint8_t)data[i]) * 16777619u;
+	}
+	return hash;
+}
+
+template <typename T>
+static void append_value(std::vector<char>& buffer, T value) {
+	const char* bytes = (const char*)&value;
+	buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static void append_section(std::vector<char>& buffer, SAVE_SECTION_ID id, const T* records, size_t count) {
+	append_value(buffer, (uint16_t)id);
+	append_value(buffer, (uint16_t)sizeof(T));
+	append_value(buffer, (uint32_t)count);
+	const char* bytes = (const char*)records;
+	buffer.insert(buffer.end(), bytes, bytes + sizeof(T) * count);
+}
+
+// Moves from over to, replacing to in one step
+static bool replace_file(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+	return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	return rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+bool write_save_binary(const std::string& path, const SaveState& state) {
+	std::vector<char> payload;
+	append_section(payload, SAVE_SECTION_ID::GAME, &state.game, 1);
+	append_section(payload, SAVE_SECTION_ID::PLAYER, &state.player, 1);
+	append_section(payload, SAVE_SECTION_ID::PLAYER_ABILITIES, state.player_abilities.data(), state.player_abilities.size());
+	append_section(payload, SAVE_SECTION_ID::REGIONS, state.regions.data(), state.regions.size());
+	append_section(payload, SAVE_SECTION_ID::ENEMIES, state.enemies.data(), state.enemies.size());
+	append_section(payload, SAVE_SECTION_ID::CYSTS, state.cysts.data(), state.cysts.size());
+	append_section(payload, SAVE_SECTION_ID::CHESTS, state.chests.data(), state.chests.size());
+	append_section(payload, SAVE_SECTION_ID::CURE, &state.cure_position, state.has_cure ? 1 : 0);
+	append_section(payload, SAVE_SECTION_ID::WORLD, state.world.data(), state.world.size());
+	append_section(payload, SAVE_SECTION_ID::WORLD_HANDLES, &state.world_handles, 1);
+	append_section(payload, SAVE_SECTION_ID::TIMED_EVENTS, state.timed_events.data(), state.timed_events.size());
+	append_section(payload, SAVE_SECTION_ID::PROJECTILES, state.projectiles.data(), state.projectiles.size());
+
+	std::vector<char> header;
+	header.insert(header.end(), SAVE_GAME_MAGIC, SAVE_GAME_MAGIC + sizeof(SAVE_GAME_MAGIC));
+	append_value(header, SAVE_FORMAT_VERSION);
+	append_value(header, (uint16_t)save_section_count);
+	append_value(header, (uint32_t)payload.size());
+	append_value(header, fnv1a(payload.data(), payload.size()));
+	assert(header.size() == SAVE_HEADER_SIZE);
+
+	std::string temp_path = path + ".tmp";
+	FILE* file = fopen(temp_path.c_str(), "wb");
+	if (file == nullptr) {
+		fprintf(stderr, "Failed to open save game %s for writing\n", temp_path.c_str());
+		return false;
+	}
+	bool written = fwrite(header.data(), 1, header.size(), file) == header.size()
+		&& fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+	written = fclose(file) == 0 && written;
+	if (!written || !replace_file(temp_path, path)) {
+		fprintf(stderr, "Failed to write save game %s\n", path.c_str());
+		remove(temp_path.c_str());
+		return false;
+	}
+	return true;
+}
+
+// Copies a section's records into values. Records shorter than T keep the defaults of the
+// missing fields, longer ones (from a newer build) lose their extra fields.
+template <typename T>
+static void read_records(const char* data, uint16_t record_size, uint32_t count, std::vector<T>& values) {
+	values.assign(count, T());
+	size_t copied = std::min((size_t)record_size, sizeof(T));
+	for (uint32_t i = 0; i < count; i++) {
+		memcpy(&values[i], data + (size_t)i * record_size, copied);
+	}
+}
+
+template <typename T>
+static void read_record(const char* data, uint16_t record_size, uint32_t count, T& value) {
+	if (count == 0) return;
+	memcpy(&value, data, std::min((size_t)record_size, sizeof(T)));
+}
+
+bool read_save_binary(const std::string& path, SaveState& state) {
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == nullptr) {
+		return false;
+	}
+	std::vector<char> contents;
+	char chunk[4096];
+	size_t read;
+	while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+		contents.insert(contents.end(), chunk, chunk + read);
+	}
+	fclose(file);
+
+	uint16_t version, section_count;
+	uint32_t payload_size, checksum;
+	if (contents.size() < SAVE_HEADER_SIZE || memcmp(contents.data(), SAVE_GAME_MAGIC, sizeof(SAVE_GAME_MAGIC)) != 0) {
+		fprintf(stderr, "%s is not a save game\n", path.c_str());
+		return false;
+	}
+	memcpy(&version, &contents[4], sizeof(version));
+	memcpy(&section_count, &contents[6], sizeof(section_count));
+	memcpy(&payload_size, &contents[8], sizeof(payload_size));
+	memcpy(&checksum, &contents[12], sizeof(checksum));
+	if (version > SAVE_FORMAT_VERSION) {
+		fprintf(stderr, "Save game %s has version %d, this build reads up to %d\n", path.c_str(), version, SAVE_FORMAT_VERSION);
+		return false;
+	}
+	const char* payload = contents.data() + SAVE_HEADER_SIZE;
+	if (contents.size() - SAVE_HEADER_SIZE != payload_size || fnv1a(payload, payload_size) != checksum) {
+		fprintf(stderr, "Save game %s is damaged\n", path.c_str());
+		return false;
+	}
+
+	state = SaveState();
+	size_t offset = 0;
+	for (int i = 0; i < section_count; i++) {
+		uint16_t id, record_size;
+		uint32_t count;
+		if (payload_size - offset < SAVE_SECTION_HEADER_SIZE) return false;
+		memcpy(&id, payload + offset, sizeof(id));
+		memcpy(&record_size, payload + offset + 2, sizeof(record_size));
+		memcpy(&count, payload + offset + 4, sizeof(count));
+		offset += SAVE_SECTION_HEADER_SIZE;
+		if ((payload_size - offset) / std::max((size_t)record_size, (size_t)1) < count) return false;
+		const char* records = payload + offset;
+		offset += (size_t)record_size * count;
+
+		switch ((SAVE_SECTION_ID)id) {
+		case SAVE_SECTION_ID::GAME: read_record(records, record_size, count, state.game); break;
+		case SAVE_SECTION_ID::PLAYER: read_record(records, record_size, count, state.player); break;
+		case SAVE_SECTION_ID::PLAYER_ABILITIES: read_records(records, record_size, count, state.player_abilities); break;
+		case SAVE_SECTION_ID::REGIONS: read_records(records, record_size, count, state.regions); break;
+		case SAVE_SECTION_ID::ENEMIES: read_records(records, record_size, count, state.enemies); break;
+		case SAVE_SECTION_ID::CYSTS: read_records(records, record_size, count, state.cysts); break;
+		case SAVE_SECTION_ID::CHESTS: read_records(records, record_size, count, state.chests); break;
+		case SAVE_SECTION_ID::CURE:
+			state.has_cure = count > 0;
+			read_record(records, record_size, count, state.cure_position);
+			break;
+		case SAVE_SECTION_ID::WORLD: read_records(records, record_size, count, state.world); break;
+		case SAVE_SECTION_ID::WORLD_HANDLES: read_record(records, record_size, count, state.world_handles); break;
+		case SAVE_SECTION_ID::TIMED_EVENTS: read_records(records, record_size, count, state.timed_events); break;
+		case SAVE_SECTION_ID::PROJECTILES: read_records(records, record_size, count, state.projectiles); break;
+		default:
+			break;
+		}
+	}
+	return true;
+}
+
+static json vec2_to_json(vec2 value) {
+	return { value.x, value.y };
+}
+
+static vec2 vec2_from_json(const json& value) {
+	return { value.at(0).get<float>(), value.at(1).get<float>() };
+}
+
+static json vec4_to_json(vec4 value) {
+	return { value.x, value.y, value.z, value.w };
+}
+
+static vec4 vec4_from_json(const json& value) {
+	return { value.at(0).get<float>(), value.at(1).get<float>(), value.at(2).get<float>(), value.at(3).get<float>() };
+}
+
+json save_state_to_json(const SaveState& state) {
+	json data;
+
+	for (const SavedRegion& region : state.regions) {
+		json regionData;
+		regionData["theme"] = region.theme;
+		regionData["goal"] = region.goal;
+		regionData["enemy"] = region.enemy;
+		regionData["boss"] = region.boss;
+		regionData["is_cleared"] = region.is_cleared != 0;
+		regionData["interest_point"] = vec2_to_json(region.interest_point);
+		data["regions"].push_back(regionData);
+	}
+
+	data["player"]["position"] = vec2_to_json(state.player.position);
+	data["player"]["health"] = state.player.health;
+
+	data["game"]["isFirstBossDefeated"] = state.game.is_first_boss_defeated != 0;
+	data["game"]["isCureObtained"] = state.game.is_cure_obtained != 0;
+	data["game"]["isSecondBossDefeated"] = state.game.is_second_boss_defeated != 0;
+	data["game"]["isCystTutorialDisplayed"] = state.game.is_cyst_tutorial_displayed != 0;
+
+	for (int32_t ability : state.player_abilities) {
+		data["playerAbilities"].push_back(ability);
+	}
+
+	for (const SavedEnemy& enemy : state.enemies) {
+		json enemyData;
+		enemyData["position"] = vec2_to_json(enemy.position);
+		enemyData["health"] = enemy.health;
+		enemyData["type"] = enemy.type;
+		data["enemies"].push_back(enemyData);
+	}
+
+	for (const SavedCyst& cyst : state.cysts) {
+		json cystData;
+		cystData["position"] = vec2_to_json(cyst.position);
+		cystData["health"] = cyst.health;
+		data["cysts"].push_back(cystData);
+	}
+
+	for (const SavedChest& chest : state.chests) {
+		json chestData;
+		chestData["position"] = vec2_to_json(chest.position);
+		chestData["ability"] = chest.ability;
+		data["chests"].push_back(chestData);
+	}
+
+	if (state.has_cure) {
+		data["cure"]["position"] = vec2_to_json(state.cure_position);
+	}
+	else {
+		data["cure"] = nullptr;
+	}
+
+	json gameModeData;
+	gameModeData["id"] = state.game.game_mode;
+	data["gameMode"].push_back(gameModeData);
+
+	if (!state.world.empty()) {
+		data["world"] = world_to_json(state.world);
+		data["worldHandles"]["player"] = state.world_handles.player;
+		data["worldHandles"]["game"] = state.world_handles.game;
+		data["worldHandles"]["gameMode"] = state.world_handles.game_mode;
+		data["worldHandles"]["deathScreen"] = state.world_handles.death_screen;
+
+		for (const SavedTimedEvent& event : state.timed_events) {
+			json eventData;
+			eventData["type"] = event.type;
+			eventData["effect"] = event.effect;
+			eventData["entity"] = event.entity;
+			eventData["remainingMs"] = event.remaining_ms;
+			eventData["values"] = event.values;
+			data["timedEvents"].push_back(eventData);
+		}
+
+		for (const SavedProjectile& projectile : state.projectiles) {
+			json projectileData;
+			projectileData["position"] = vec2_to_json(projectile.position);
+			projectileData["velocity"] = vec2_to_json(projectile.velocity);
+			projectileData["radius"] = projectile.radius;
+			projectileData["damage"] = projectile.damage;
+			projectileData["color"] = vec4_to_json(projectile.color);
+			projectileData["lifetimeMs"] = projectile.lifetime_ms;
+			projectileData["team"] = projectile.team;
+			data["projectiles"].push_back(projectileData);
+		}
+	}
+
+	return data;
+}
+
+static SavedRegion region_from_json(const json& regionData) {
+	SavedRegion region;
+	region.theme = regionData.at("theme");
+	region.goal = regionData.at("goal");
+	region.enemy = regionData.at("enemy");
+	region.boss = regionData.at("boss");
+	region.is_cleared = regionData.at("is_cleared").get<bool>();
+	region.interest_point = vec2_from_json(regionData.at("interest_point"));
+	return region;
+}
+
+static SavedPlayer player_from_json(const json& playerData) {
+	SavedPlayer player;
+	player.position = vec2_from_json(playerData.at("position"));
+	player.health = playerData.at("health");
+	return player;
+}
+
+// Keeps the game mode, it comes from its own list
+static void game_from_json(const json& gameData, SavedGame& game) {
+	game.is_first_boss_defeated = gameData.at("isFirstBossDefeated").get<bool>();
+	game.is_cure_obtained = gameData.at("isCureObtained").get<bool>();
+	game.is_second_boss_defeated = gameData.at("isSecondBossDefeated").get<bool>();
+	game.is_cyst_tutorial_displayed = gameData.at("isCystTutorialDisplayed").get<bool>();
+}
+
+static SavedEnemy enemy_from_json(const json& enemyData) {
+	SavedEnemy enemy;
+	enemy.type = enemyData.at("type");
+	enemy.position = vec2_from_json(enemyData.at("position"));
+	enemy.health = enemyData.at("health");
+	return enemy;
+}
+
+static SavedCyst cyst_from_json(const json& cystData) {
+	SavedCyst cyst;
+	cyst.position = vec2_from_json(cystData.at("position"));
+	cyst.health = cystData.at("health");
+	return cyst;
+}
+
+static SavedChest chest_from_json(const json& chestData) {
+	SavedChest chest;
+	chest.position = vec2_from_json(chestData.at("position"));
+	chest.ability = chestData.at("ability");
+	return chest;
+}
+
+static SavedWorldHandles world_handles_from_json(const json& handles) {
+	SavedWorldHandles world_handles;
+	world_handles.player = handles.at("player");
+	world_handles.game = handles.at("game");
+	world_handles.game_mode = handles.at("gameMode");
+	world_handles.death_screen = handles.value("deathScreen", 0u);
+	return world_handles;
+}
+
+static SavedTimedEvent timed_event_from_json(const json& eventData) {
+	SavedTimedEvent event;
+	event.type = eventData.at("type");
+	event.effect = eventData.at("effect");
+	event.entity = eventData.at("entity");
+	event.remaining_ms = eventData.at("remainingMs");
+	const json& values = eventData.at("values");
+	for (size_t i = 0; i < values.size() && i < timed_event_value_count; i++) {
+		event.values[i] = values[i];
+	}
+	return event;
+}
+
+static SavedProjectile projectile_from_json(const json& projectileData) {
+	SavedProjectile projectile;
+	projectile.position = vec2_from_json(projectileData.at("position"));
+	projectile.velocity = vec2_from_json(projectileData.at("velocity"));
+	projectile.radius = projectileData.at("radius");
+	projectile.damage = projectileData.at("damage");
+	projectile.color = vec4_from_json(projectileData.at("color"));
+	projectile.lifetime_ms = projectileData.at("lifetimeMs");
+	projectile.team = projectileData.at("team");
+	return projectile;
+}
+
+// Streams a JSON save game into a SaveState. Only the record being read (a region, an enemy, one
+// component of the world, ...) is held as JSON, it goes into the state as soon as it is complete.
+// Records are the elements of the top level lists and of the world's lists, and the top level objects.
+// The world goes into staging when there is one, decoded, otherwise it is encoded into the state's blob.
+// A record missing a field or of the wrong type rejects the file.
+class SaveJsonReader : public nlohmann::json_sax<json>
+{
+public:
+	SaveJsonReader(SaveState& state, WorldStaging* staging) : state(state), staging(staging) {}
+
+	bool null() override { return value(nullptr); }
+	bool boolean(bool val) override { return value(val); }
+	bool number_integer(number_integer_t val) override { return value(val); }
+	bool number_unsigned(number_unsigned_t val) override { return value(val); }
+	bool number_float(number_float_t val, const string_t&) override { return value(val); }
+	bool string(string_t& val) override { return value(std::move(val)); }
+	bool binary(binary_t&) override { return false; }	// JSON text has none
+
+	bool start_object(std::size_t) override { return start(json::object(), false); }
+	bool start_array(std::size_t) override { return start(json::array(), true); }
+	bool end_object() override { return end(); }
+	bool end_array() override { return end(); }
+
+	bool key(string_t& val) override {
+		if (!open.empty()) record_key = val;
+		else frames.back().key = val;
+		return true;
+	}
+
+	bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& error) override {
+		fprintf(stderr, "Save game is not valid JSON at byte %d: %s\n", (int)position, error.what());
+		return false;
+	}
+
+	// Checks that everything a save needs was there
+	bool finish() {
+		for (const char* section : { "player", "game", "gameMode" }) {
+			if (!seen(section)) {
+				fprintf(stderr, "Save game is missing \"%s\"\n", section);
+				return false;
+			}
+		}
+		bool world_read = staging ? staging->finish() : world.finish(state.world);
+		if (seen("world") && (!seen("worldHandles") || !world_read)) {
+			fprintf(stderr, "Save game has a damaged \"world\"\n");
+			return false;
+		}
+		return true;
+	}
+
+private:
+	// A container around the current position, outside of records
+	struct Frame {
+		bool is_array;
+		std::string key;	// Current key of an object
+	};
+
+	bool at_record() const {
+		if (frames.size() == 1) {
+			const std::string& section = frames[0].key;
+			return section == "player" || section == "game" || section == "cure" || section == "worldHandles";
+		}
+		if (frames.size() == 2) {
+			const std::string& section = frames[0].key;
+			return frames[1].is_array && (section == "regions" || section == "playerAbilities" || section == "enemies"
+				|| section == "cysts" || section == "chests" || section == "gameMode" || section == "timedEvents"
+				|| section == "projectiles");
+		}
+		return frames.size() == 4 && frames[0].key == "world" && frames[3].is_array
+			&& (frames[2].key == "entities" || frames[2].key == "components");
+	}
+
+	// Adds a value to the innermost open container of the record
+	json* add(json&& val) {
+		json& container = *open.back();
+		if (container.is_array()) {
+			container.push_back(std::move(val));
+			return &container.back();
+		}
+		json& slot = container[record_key];
+		slot = std::move(val);
+		return &slot;
+	}
+
+	template <typename T>
+	bool value(T&& val) {
+		if (!open.empty()) add(json(std::forward<T>(val)));
+		else if (at_record()) return take(json(std::forward<T>(val)));
+		return true;
+	}
+
+	bool start(json&& container, bool is_array) {
+		if (!open.empty()) {
+			open.push_back(add(std::move(container)));
+		}
+		else if (at_record()) {
+			record = std::move(container);
+			open.push_back(&record);
+		}
+		else {
+			if (frames.size() == 1) sections.push_back(frames[0].key);
+			frames.push_back({ is_array, "" });
+		}
+		return true;
+	}
+
+	bool end() {
+		if (open.empty()) {
+			frames.pop_back();
+		}
+		else {
+			open.pop_back();
+			if (open.empty()) return take(record);
+		}
+		return true;
+	}
+
+	bool seen(const char* section) const {
+		return std::find(sections.begin(), sections.end(), section) != sections.end();
+	}
+
+	// False stops the parse
+	bool take(const json& data) {
+		const std::string& section = frames[0].key;
+		if (frames.size() == 1) sections.push_back(section);
+		try {
+			take_record(section, data);
+		}
+		catch (const json::exception& error) {
+			fprintf(stderr, "Save game has a damaged \"%s\": %s\n", section.c_str(), error.what());
+			return false;
+		}
+		return true;
+	}
+
+	void take_record(const std::string& section, const json& data) {
+		if (frames.size() == 4) {
+			// Types of newer builds are skipped
+			const std::string& type = frames[1].key;
+			if (frames[2].key == "entities") {
+				if (staging) staging->add_entity(type, data.get<uint32_t>());
+				else world.add_entity(type, data.get<uint32_t>());
+			}
+			else if (staging) staging->add_component(type, data);
+			else world.add_component(type, data);
+		}
+		else if (section == "regions") state.regions.push_back(region_from_json(data));
+		else if (section == "player") state.player = player_from_json(data);
+		else if (section == "game") game_from_json(data, state.game);
+		else if (section == "gameMode") {
+			if (!game_mode_read) state.game.game_mode = data.at("id");
+			game_mode_read = true;
+		}
+		else if (section == "playerAbilities") state.player_abilities.push_back(data.get<int32_t>());
+		else if (section == "enemies") state.enemies.push_back(enemy_from_json(data));
+		else if (section == "cysts") state.cysts.push_back(cyst_from_json(data));
+		else if (section == "chests") state.chests.push_back(chest_from_json(data));
+		else if (section == "cure") {
+			state.has_cure = !data.is_null();
+			if (state.has_cure) state.cure_position = vec2_from_json(data.at("position"));
+		}
+		else if (section == "worldHandles") state.world_handles = world_handles_from_json(data);
+		else if (section == "timedEvents") state.timed_events.push_back(timed_event_from_json(data));
+		else if (section == "projectiles") state.projectiles.push_back(projectile_from_json(data));
+	}
+
+	SaveState& state;
+	WorldStaging* staging;
+	WorldJsonReader world;
+	std::vector<Frame> frames;
+	std::vector<std::string> sections;	// Top level keys read so far
+	bool game_mode_read = false;
+
+	json record;
+	std::vector<json*> open;	// Containers of the record that are not closed yet
+	std::string record_key;		// Key of the next value in the innermost open object
+};
+
+bool write_save_json(const std::string& path, const SaveState& state) {
+	std::ofstream outFile(path);
+	if (!outFile) {
+		std::cerr << "Error opening file for writing." << std::endl;
+		return false;
+	}
+	outFile << save_state_to_json(state).dump(4);
+	return bool(outFile);
+}
+
+bool read_save_json(const std::string& path, SaveState& state, WorldStaging* staging) {
+	std::ifstream inFile(path);
+	if (!inFile) {
+		return false;
+	}
+	state = SaveState();
+	SaveJsonReader reader(state, staging);
+	if (!json::sax_parse(inFile, &reader) || !reader.finish()) {
+		fprintf(stderr, "Failed to read %s\n", path.c_str());
+		return false;
+	}
+	return true;
+}
+
+SaveWriter::~SaveWriter() {
+	if (!thread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	thread.join();
+}
+
+void SaveWriter::submit(ECSRegistry& registry, SaveCapture&& capture, bool with_json) {
+	if (!thread.joinable()) {
+		staging.reset(new ECSRegistry());
+		pending_world = staging->create_snapshot();
+		building_world = staging->create_snapshot();
+		thread = std::thread(&SaveWriter::run, this);
+	}
+	{
+		// The thread only holds the lock to take the pending copy
+		std::lock_guard<std::mutex> lock(mutex);
+		registry.save_snapshot(pending_world);
+		pending = std::move(capture);
+		pending_json = with_json;
+		has_pending = true;
+	}
+	wake.notify_one();
+}
+
+void SaveWriter::flush() {
+	std::unique_lock<std::mutex> lock(mutex);
+	idle.wait(lock, [this]() { return !has_pending && !writing; });
+}
+
+void SaveWriter::run() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		wake.wait(lock, [this]() { return has_pending || stopping; });
+		// Stopping still writes what was submitted last
+		if (!has_pending) break;
+
+		std::swap(pending_world, building_world);
+		std::swap(pending, building);
+		bool with_json = pending_json;
+		has_pending = false;
+		writing = true;
+		lock.unlock();
+
+		staging->restore_snapshot(building_world);
+		SaveState state;
+		build(*staging, building, state);
+		if (write_save_binary(SAVE_GAME_PATH, state)) {
+			if (with_json) write_save_json(SAVE_GAME_JSON_PATH, state);
+			printf("Game state saved.\n");
+		}
+
+		lock.lock();
+		writing = false;
+		idle.notify_all();
+	}
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "components.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// stlib
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Everything a save game holds, in plain records. WorldSystem fills it from the registry and
+// recreates the world from it; the binary and JSON files are two encodings of the same state.
+// Enums are stored as their int values.
+struct SavedGame {
+	int32_t game_mode = 0;
+	uint8_t is_first_boss_defeated = 0;
+	uint8_t is_cure_obtained = 0;
+	uint8_t is_second_boss_defeated = 0;
+	uint8_t is_cyst_tutorial_displayed = 0;
+};
+
+struct SavedPlayer {
+	vec2 position = { 0.f, 0.f };
+	float health = 0.f;
+};
+
+struct SavedRegion {
+	int32_t theme = 0;
+	int32_t goal = 0;
+	int32_t enemy = 0;
+	int32_t boss = 0;
+	vec2 interest_point = { 0.f, 0.f };
+	uint8_t is_cleared = 0;
+	uint8_t padding[3] = {};
+};
+
+struct SavedEnemy {
+	int32_t type = 0;
+	vec2 position = { 0.f, 0.f };
+	float health = 0.f;
+};
+
+struct SavedCyst {
+	vec2 position = { 0.f, 0.f };
+	float health = 0.f;
+};
+
+struct SavedChest {
+	vec2 position = { 0.f, 0.f };
+	int32_t ability = 0;
+};
+
+// Entities the game keeps handles to, as ids of the saved world
+struct SavedWorldHandles {
+	uint32_t player = 0;
+	uint32_t game = 0;
+	uint32_t game_mode = 0;
+	uint32_t death_screen = 0;	// Only while the player dies
+};
+
+// A pending TimedEvent, the entity as an id of the saved world
+struct SavedTimedEvent {
+	int32_t type = 0;
+	int32_t effect = 0;
+	uint32_t entity = 0;
+	float remaining_ms = 0.f;
+	float values[timed_event_value_count] = {};
+};
+
+struct SavedProjectile {
+	vec2 position = { 0.f, 0.f };
+	vec2 velocity = { 0.f, 0.f };
+	float radius = 0.f;
+	float damage = 0.f;
+	vec4 color = { 0.f, 0.f, 0.f, 0.f };
+	float lifetime_ms = 0.f;
+	uint8_t team = 0;
+	uint8_t padding[3] = {};
+};
+
+struct SaveState {
+	SavedGame game;
+	SavedPlayer player;
+	std::vector<int32_t> player_abilities;
+	std::vector<SavedRegion> regions;	// In creation order
+	std::vector<SavedEnemy> enemies;
+	std::vector<SavedCyst> cysts;
+	std::vector<SavedChest> chests;		// Unopened ones only
+	bool has_cure = false;
+	vec2 cure_position = { 0.f, 0.f };
+	// Every component of the run's entities, see world_serializer.hpp. Loading restores the world
+	// from it exactly and only falls back to the records above when it is empty.
+	std::vector<char> world;
+	SavedWorldHandles world_handles;
+	// Only restored with the world
+	std::vector<SavedTimedEvent> timed_events;
+	std::vector<SavedProjectile> projectiles;
+};
+
+// Binary save file layout, native byte order:
+//   header: "CCSV", uint16 version, uint16 section count, uint32 payload size, uint32 FNV-1a checksum of the payload
+//   payload: sections of uint16 SAVE_SECTION_ID, uint16 record size, uint32 record count, then the packed records
+// Readers skip sections they don't know and keep the defaults of fields missing from shorter records, so
+// new state goes into new sections or at the end of a record without breaking older saves.
+const uint16_t SAVE_FORMAT_VERSION = 1;
+
+enum class SAVE_SECTION_ID {
+	GAME = 0,
+	PLAYER = GAME + 1,
+	PLAYER_ABILITIES = PLAYER + 1,
+	REGIONS = PLAYER_ABILITIES + 1,
+	ENEMIES = REGIONS + 1,
+	CYSTS = ENEMIES + 1,
+	CHESTS = CYSTS + 1,
+	CURE = CHESTS + 1,
+	WORLD = CURE + 1,			// Record size 1, the world blob
+	WORLD_HANDLES = WORLD + 1,
+	TIMED_EVENTS = WORLD_HANDLES + 1,
+	PROJECTILES = TIMED_EVENTS + 1,
+	SAVE_SECTION_COUNT = PROJECTILES + 1
+};
+const int save_section_count = (int)SAVE_SECTION_ID::SAVE_SECTION_COUNT;
+
+const std::string SAVE_GAME_PATH = "savegame.bin";
+const std::string SAVE_GAME_JSON_PATH = "savegame.json";	// Readable copy, written in debug mode
+
+// Writes to path.tmp first and renames it over path, so a crash never leaves a half written save
+bool write_save_binary(const std::string& path, const SaveState& state);
+bool read_save_binary(const std::string& path, SaveState& state);
+
+class WorldStaging;
+
+// The JSON layout of the original save games, kept for debugging and converting. Reading streams the
+// file record by record instead of parsing it into one json value first. With staging the world is
+// decoded into it instead of the state's blob, so loading holds it once (see WorldStaging); the other
+// records are small next to it. Records missing fields or of the wrong type fail the read.
+json save_state_to_json(const SaveState& state);
+bool write_save_json(const std::string& path, const SaveState& state);
+bool read_save_json(const std::string& path, SaveState& state, WorldStaging* staging = nullptr);
+
+// What a save needs besides the registry, kept by the world system outside of it
+struct SaveCapture {
+	SavedWorldHandles handles;
+	std::vector<SavedTimedEvent> timed_events;
+	const Mesh* meshes = nullptr;	// The renderer's meshes, see capture_world
+};
+
+// Builds, encodes and writes save games on a background thread. submit() only copies the registry in
+// bulk (see ECSRegistry::save_snapshot), the thread restores the copy into a registry of its own and
+// reads the SaveState from there, so the game never waits for the world blob or the disk. When saves
+// come in faster than the disk keeps up, an unwritten one is replaced by the newer one. The thread
+// starts with the first save, the destructor finishes the pending write.
+class SaveWriter
+{
+public:
+	// Reads the save out of registry, the copy submitted with capture. Runs on the writer thread.
+	using Builder = std::function<void(ECSRegistry& registry, const SaveCapture& capture, SaveState& state)>;
+
+	explicit SaveWriter(Builder build) : build(build) {}
+	~SaveWriter();
+
+	// Copies registry, which must not be in the middle of a tick, and takes over capture. Also writes
+	// the JSON copy when with_json is set.
+	void submit(ECSRegistry& registry, SaveCapture&& capture, bool with_json = false);
+	// Blocks until everything submitted is on disk
+	void flush();
+
+private:
+	void run();
+
+	Builder build;
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable idle;
+	// Made with the thread. submit() fills the pending copy while the thread builds from the other,
+	// both keep their memory from one save to the next.
+	std::unique_ptr<ECSRegistry> staging;
+	RegistrySnapshot pending_world, building_world;
+	SaveCapture pending, building;
+	bool has_pending = false;
+	bool pending_json = false;
+	bool writing = false;
+	bool stopping = false;
+};
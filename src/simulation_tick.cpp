@@ -0,0 +1,29 @@
+// internal
+#include "simulation_tick.hpp"
+
+static void reset_forces(ECSRegistry& registry) {
+	for (Motion& m : registry.motions.components) {
+		m.force = { 0.f, 0.f };
+	}
+}
+
+void tick_simulation(ECSRegistry& registry, WorldSystem& world_system, RenderSystem& render_system,
+	PhysicsSystem& physics_system, AISystem& ai_system, FrameContext& frame, float elapsed_ms)
+{
+	reset_forces(registry);
+	bool isRunning = world_system.step(elapsed_ms);
+	frame.begin(registry, elapsed_ms);
+	if (isRunning) {
+		ai_system.step(frame);
+		physics_system.step(frame);
+		world_system.resolve_collisions();
+		render_system.animationSys_step(elapsed_ms);
+		world_system.update_camera(elapsed_ms);
+		registry.random.advance_tick();
+	}
+	world_system.input.end_frame();
+
+	// Pick up whatever moved after the physics step (camera, UI, menus)
+	physics_system.update_world_matrices();
+	frame.update_camera(registry);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+// internal
+#include "physics_system.hpp"
+#include "render_system.hpp"
+#include "world_system.hpp"
+#include "ai_system.hpp"
+
+// Advances the world by one step of elapsed_ms once the input of the tick was handed to the world
+// system. The tick order shared by the game and the headless worlds, drawing is up to the caller.
+void tick_simulation(ECSRegistry& registry, WorldSystem& world_system, RenderSystem& render_system,
+	PhysicsSystem& physics_system, AISystem& ai_system, FrameContext& frame, float elapsed_ms);
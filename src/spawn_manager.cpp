@@ -0,0 +1,131 @@
+// internal
+#include "spawn_manager.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// stlib
+#include <algorithm>
+
+const int SpawnManager::RING_COUNT;
+constexpr float SpawnManager::RING_WIDTH;
+constexpr float SpawnManager::MAX_RELATIVE_SPEED;
+
+void SpawnManager::init() {
+	// Keep the ring lists in sync with the DistanceRing components, so removed enemies leave their ring
+	registry.distanceRings.on_insert = [this](Entity entity, DistanceRing& ring) {
+		ring.slot = (uint)rings[ring.ring].size();
+		rings[ring.ring].push_back(entity);
+	};
+	registry.distanceRings.on_remove = [this](Entity entity, DistanceRing& ring) {
+		std::vector<Entity>& members = rings[ring.ring];
+		Entity last = members.back();
+		members[ring.slot] = last;
+		members.pop_back();
+		if ((unsigned int)last != (unsigned int)entity) {
+			registry.distanceRings.get(last).slot = ring.slot;
+		}
+	};
+}
+
+void SpawnManager::track(Entity enemy) {
+	// Start in the outer ring, the next step puts it where it belongs
+	registry.distanceRings.insert(enemy, { 0 });
+}
+
+void SpawnManager::rebuild() {
+	// Every ring remembers its slot, so the lists come back in the same order
+	for (std::vector<Entity>& members : rings) {
+		members.clear();
+	}
+	ComponentContainer<DistanceRing>& container = registry.distanceRings;
+	for (uint i = 0; i < container.size(); i++) {
+		const DistanceRing& ring = container.components[i];
+		std::vector<Entity>& members = rings[ring.ring];
+		if (members.size() <= ring.slot) members.resize(ring.slot + 1);
+		members[ring.slot] = container.entities[i];
+	}
+}
+
+void SpawnManager::step(vec2 center, float elapsed_ms, std::vector<Entity>& despawned) {
+	// Inner rings first, so enemies that moved out to ring 0 are checked in this step too
+	for (int ring = RING_COUNT - 1; ring > 0; ring--) {
+		since_scan_ms[ring] += elapsed_ms;
+		if (since_scan_ms[ring] >= ring * RING_WIDTH / MAX_RELATIVE_SPEED * 1000.f) {
+			since_scan_ms[ring] = 0.f;
+			scan_ring(ring, center, despawned);
+		}
+	}
+	scan_ring(0, center, despawned);
+}
+
+int SpawnManager::ring_of(float distance_squared) const {
+	for (int ring = 0; ring < RING_COUNT - 1; ring++) {
+		float inner = std::max(0.f, DESPAWN_RADIUS - (ring + 1) * RING_WIDTH);
+		if (distance_squared >= inner * inner) return ring;
+	}
+	return RING_COUNT - 1;
+}
+
+void SpawnManager::scan_ring(int ring, vec2 center, std::vector<Entity>& despawned) {
+	std::vector<Entity>& members = rings[ring];
+	// Backwards, moving an enemy to another ring swaps the last member into its slot
+	for (int i = (int)members.size() - 1; i >= 0; i--) {
+		Entity entity = members[i];
+		vec2 offset = registry.transforms.get(entity).position - center;
+		float distance_squared = dot(offset, offset);
+		if (distance_squared > DESPAWN_RADIUS * DESPAWN_RADIUS) {
+			despawned.push_back(entity);
+			continue;
+		}
+		int new_ring = ring_of(distance_squared);
+		if (new_ring != ring) {
+			registry.distanceRings.update(entity, { new_ring });
+		}
+	}
+}
+
+static float wrap_angle(float angle) {
+	angle = fmodf(angle + M_PI, 2 * M_PI);
+	if (angle < 0.f) angle += 2 * M_PI;
+	return angle - M_PI;
+}
+
+bool SpawnManager::sample_spawn_point(vec2 center, float distance, vec2 scale, float preferred_angle, float spread, float u, vec2& out) {
+	// The entity fits if its center is within max_radius of the map center
+	float max_radius = MAP_RADIUS - length(scale) / 2.f;
+	if (max_radius <= 0.f) return false;
+
+	// |center + distance * dir(a)| <= max_radius  <=>  cos(a - center_angle) <= limit,
+	// so the valid angles form one arc around the direction pointing back to the map center
+	float center_distance = length(center);
+	float arc_middle = 0.f;
+	float arc_half_width = M_PI;
+	if (center_distance > 0.001f) {
+		float limit = (max_radius * max_radius - center_distance * center_distance - distance * distance) / (2.f * distance * center_distance);
+		if (limit < -1.f) return false;		// The whole circle is outside the map
+		arc_middle = atan2f(center.y, center.x) + M_PI;
+		if (limit < 1.f) arc_half_width = M_PI - acosf(limit);
+	}
+	else if (distance > max_radius) {
+		return false;
+	}
+
+	// Intersect the preferred window with the arc, relative to the arc middle. The window may wrap
+	// around, so try it shifted by a full turn both ways and keep the largest overlap.
+	float low = -arc_half_width;
+	float high = arc_half_width;
+	float relative = wrap_angle(preferred_angle - arc_middle);
+	float best_length = 0.f;
+	for (float shift : { 0.f, (float)(2 * M_PI), (float)(-2 * M_PI) }) {
+		float window_low = std::max(relative + shift - spread, -arc_half_width);
+		float window_high = std::min(relative + shift + spread, arc_half_width);
+		if (window_high - window_low > best_length) {
+			best_length = window_high - window_low;
+			low = window_low;
+			high = window_high;
+		}
+	}
+
+	float angle = arc_middle + low + u * (high - low);
+	out = center + distance * vec2(cosf(angle), sinf(angle));
+	return true;
+}
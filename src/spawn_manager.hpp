@@ -0,0 +1,59 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "tiny_ecs.hpp"
+#include "components.hpp"
+
+// stlib
+#include <array>
+#include <vector>
+
+class ECSRegistry;
+
+// Regular enemies further than this from the player are despawned
+const float DESPAWN_RADIUS = SCREEN_RADIUS + 200.f;
+
+// Spawns regular enemies just off-screen and despawns them once they fall behind.
+//
+// Tracked enemies are bucketed into distance rings around the player by their DistanceRing component.
+// Ring 0 is the band just inside DESPAWN_RADIUS and is checked every step. Ring k is at least
+// k * RING_WIDTH away from being despawned, so it only has to be re-bucketed every
+// k * RING_WIDTH / MAX_RELATIVE_SPEED seconds.
+class SpawnManager
+{
+public:
+	static const int RING_COUNT = 4;
+	static constexpr float RING_WIDTH = 250.f;
+	static constexpr float MAX_RELATIVE_SPEED = 2000.f;	// Upper bound of player plus enemy speed, in px/s
+
+	SpawnManager(ECSRegistry& registry) : registry(registry) {}
+
+	// Installs the hooks on registry.distanceRings
+	void init();
+
+	// Starts tracking a regular enemy for despawning
+	void track(Entity enemy);
+	// Rebuilds the ring lists from the DistanceRing components, after they were restored without hooks
+	void rebuild();
+	// Time since each ring was last scanned, a restored world keeps scanning on the same steps
+	using ScanTimes = std::array<float, RING_COUNT>;
+	ScanTimes get_scan_times() const { return since_scan_ms; }
+	void set_scan_times(const ScanTimes& times) { since_scan_ms = times; }
+	// Re-buckets the rings that are due and appends the enemies beyond DESPAWN_RADIUS to despawned.
+	// Removing them is up to the caller.
+	void step(vec2 center, float elapsed_ms, std::vector<Entity>& despawned);
+
+	// Picks a point at distance `distance` from center where an entity of the given scale lies fully
+	// inside the map. Prefers the window of +-spread radians around preferred_angle and falls back to
+	// the whole valid arc. u in [0, 1) selects the point. Returns false only if no such point exists.
+	static bool sample_spawn_point(vec2 center, float distance, vec2 scale, float preferred_angle, float spread, float u, vec2& out);
+
+private:
+	int ring_of(float distance_squared) const;
+	void scan_ring(int ring, vec2 center, std::vector<Entity>& despawned);
+
+	ECSRegistry& registry;
+	std::vector<Entity> rings[RING_COUNT];
+	ScanTimes since_scan_ms = {};
+};
@@ -2,33 +2,26 @@
 #include "dialog_system.hpp"
 #include "world_init.hpp"
 
-DialogSystem::DialogSystem(std::unordered_map<int, int>& keys_pressed, const vec2& mouse, const unsigned char*& controller_buttons)
-	: keys_pressed(keys_pressed), mouse(mouse), controller_buttons(controller_buttons){
-	rendered_entity = Entity();
+DialogSystem::DialogSystem(ECSRegistry& registry, InputState& input, const vec2& mouse)
+	: registry(registry), input(input), mouse(mouse) {
+	rendered_entity = registry.create_entity();
 	current_status = DIALOG_STATUS::DISPLAY;
 }
 
 // NOTE: A dialog mid-game should be given a higher delay to avoid accidental skips.
 void DialogSystem::add_dialog(TEXTURE_ASSET_ID asset, float skip_delay_duration) {
+	if (!enabled) return;
 	dialogs.push({
 		asset, skip_delay_duration, {0,0},
 		[this]() {
 			if (this->skip_timer > 0) return false;
-			auto keys = (std::unordered_map<int, int>&) this->keys_pressed;
-			for (auto keyVal = keys.begin(); keyVal != keys.end(); ++keyVal) {
-				if (keyVal->second) return true;
-			}
-			if (this->controller_buttons != nullptr) {
-				for (uint i = 0; i < 19; i++) {
-					if (this->controller_buttons[i]) return true;
-				}
-			}
-			return false;
+			return this->input.any();
 		},
 		false});
 }
 
 void DialogSystem::add_camera_movement(vec2 start_pos, vec2 end_pos, float duration) {
+	if (!enabled) return;
 	Stage new_cam_movement;
 	new_cam_movement.camera_movement = true;
 	new_cam_movement.start_pos = start_pos;
@@ -79,7 +72,7 @@ bool DialogSystem::step(float elapsed_ms) {
 					GEOMETRY_BUFFER_ID::SPRITE,
 					RENDER_ORDER::DIALOG });
 
-			keys_pressed.clear();
+			input.release_all();
 			skip_timer = current_stage.skip_delay_duration;
 			current_status = DIALOG_STATUS::AWAIT_ACTION;
 			return false;
@@ -105,7 +98,7 @@ bool DialogSystem::step(float elapsed_ms) {
 		//		dialogs.pop();
 		//	}
 		//	break;
-		case DIALOG_STATUS::MOVING_CAMERA:
+		case DIALOG_STATUS::MOVING_CAMERA: {
 			current_stage.camera_timer -= elapsed_ms;
 			vec2 current_pos = current_stage.start_pos * (max(0.f, current_stage.camera_timer) / current_stage.camera_duration) + 
 							   current_stage.end_pos * (1.f - (max(0.f, current_stage.camera_timer) / current_stage.camera_duration));
@@ -118,6 +111,7 @@ bool DialogSystem::step(float elapsed_ms) {
 				return false;
 			}
 			break;
+		}
 		default:
 			break;
 		}
@@ -3,6 +3,7 @@
 // internal
 #include "common.hpp"
 #include "components.hpp"
+#include "input_state.hpp"
 #include "tiny_ecs_registry.hpp"
 
 // stlib
@@ -38,7 +39,7 @@ struct Stage {
 
 class DialogSystem {
 public:
-	DialogSystem(std::unordered_map<int, int>& keys_pressed, const vec2& mouse, const unsigned char*& controller_buttons);
+	DialogSystem(ECSRegistry& registry, InputState& input, const vec2& mouse);
 	~DialogSystem();
 	bool has_pending();
 	bool step(float elapsed_ms);
@@ -46,11 +47,14 @@ public:
 	void add_camera_movement(vec2 start_pos, vec2 end_pos, float duration);
 	void clear_pending_dialogs();
 
+	// New dialogs are dropped while disabled, e.g. in headless runs where nobody can skip them
+	bool enabled = true;
+
 private:
 	std::queue<Stage> dialogs;
-	std::unordered_map<int, int>& keys_pressed;
+	ECSRegistry& registry;
+	InputState& input;
 	const vec2& mouse;
-	const unsigned char*& controller_buttons;
 	vec2 previous_mouse = { 0,0 };
 	DIALOG_STATUS current_status;
 	Entity rendered_entity;
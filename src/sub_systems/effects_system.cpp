@@ -9,9 +9,7 @@ EffectsSystem::~EffectsSystem() {
 	//The value of the soundChunks is passed in a an argument, no delete needed
 	//The pointers in the soundChunks are handled in the ~WorldSystem()
 
-	//The created timedEvents are also recycled in WorldSystem::step_timer_with_callback(float elapsed_ms)
-	while (registry.timedEvents.entities.size() > 0)
-		registry.remove_all_components_of(registry.timedEvents.entities.back());
+	//Pending effect ends are timed events of WorldSystem
 }
 
 // Apply effect with timer, play sound, display icon
@@ -106,18 +104,10 @@ void EffectsSystem::handle_damage_effect() {
 	vec4 prev_color = weapon.bullet_color;
 	weapon.bullet_color = DAMAGE_BUFF_PROJECTILE_COLOR;
 
-	Entity entity = Entity();
+	Entity entity = registry.create_entity();
 
-	TimedEvent& effect_timer = registry.timedEvents.emplace(entity);
-	effect_timer.timer_ms = DAMAGE_EFFECT_TIME;
-	effect_timer.callback = [this, prev_damage, prev_speed, prev_size, prev_color]() {
-		Gun& weapon = registry.guns.get(player);
-		weapon.damage = prev_damage;
-		weapon.bullet_speed = prev_speed;
-		weapon.bullet_size = prev_size;
-		weapon.bullet_color = prev_color;
-		getEffect(CYST_EFFECT_ID::DAMAGE).is_active = false;
-		};
+	endAfter(DAMAGE_EFFECT_TIME, CYST_EFFECT_ID::DAMAGE, entity, { prev_damage, prev_speed, prev_size.x, prev_size.y,
+		prev_color.r, prev_color.g, prev_color.b, prev_color.a });
 
 	displayEffect(entity, CYST_EFFECT_ID::DAMAGE);
 }
@@ -149,14 +139,9 @@ void EffectsSystem::handle_clear_screen() {
 void EffectsSystem::handle_triple_bullets() {
 	registry.tripleBullets.emplace(player);
 
-	Entity entity = Entity();
+	Entity entity = registry.create_entity();
 
-	TimedEvent& effect_timer = registry.timedEvents.emplace(entity);
-	effect_timer.timer_ms = DAMAGE_EFFECT_TIME;
-	effect_timer.callback = [this]() {
-		registry.tripleBullets.remove(player);
-		getEffect(CYST_EFFECT_ID::TRIPLE).is_active = false;
-		};
+	endAfter(DAMAGE_EFFECT_TIME, CYST_EFFECT_ID::TRIPLE, entity);
 
 	displayEffect(entity, CYST_EFFECT_ID::TRIPLE);
 }
@@ -164,14 +149,9 @@ void EffectsSystem::handle_triple_bullets() {
 void EffectsSystem::handle_lots_of_bullets() {
 	registry.lotsOfBullets.emplace(player);
 
-	Entity entity = Entity();
+	Entity entity = registry.create_entity();
 
-	TimedEvent& effect_timer = registry.timedEvents.emplace(entity);
-	effect_timer.timer_ms = 2000.f;
-	effect_timer.callback = [this]() {
-		registry.lotsOfBullets.remove(player);
-		getEffect(CYST_EFFECT_ID::LOTS).is_active = false;
-		};
+	endAfter(2000.f, CYST_EFFECT_ID::LOTS, entity);
 
 	displayEffect(entity, CYST_EFFECT_ID::LOTS);
 }
@@ -185,16 +165,9 @@ void EffectsSystem::handle_slow_effect() {
 	motion.acceleration_unit = 0.3f;
 	motion.max_velocity = 220.f;
 
-	Entity entity = Entity();
+	Entity entity = registry.create_entity();
 
-	TimedEvent& effect_timer = registry.timedEvents.emplace(entity);
-	effect_timer.timer_ms = 4000;
-	effect_timer.callback = [this, prev_acceleration, prev_max_velocity]() {
-		Motion& motion = registry.motions.get(player);
-		motion.acceleration_unit = prev_acceleration;
-		motion.max_velocity = prev_max_velocity;
-		getEffect(CYST_EFFECT_ID::SLOW).is_active = false;
-		};
+	endAfter(4000, CYST_EFFECT_ID::SLOW, entity, { prev_acceleration, prev_max_velocity });
 
 	displayEffect(entity, CYST_EFFECT_ID::SLOW);
 }
@@ -205,25 +178,16 @@ void EffectsSystem::handle_fov_effect() {
 	int prev_volume = Mix_Volume(-1, -1);
 	Mix_Volume(-1, prev_volume - 75);
 
-	Entity entity = Entity();
+	Entity entity = registry.create_entity();
 
-	TimedEvent& effect_timer = registry.timedEvents.emplace(entity);
-	effect_timer.timer_ms = 6000;
-	effect_timer.callback = [this, prev_volume]() {
-		registry.screenStates.components[0].limit_fov = false;
-		Mix_Volume(-1, prev_volume);
-		getEffect(CYST_EFFECT_ID::FOV).is_active = false;
-		};
+	endAfter(6000, CYST_EFFECT_ID::FOV, entity, { (float)prev_volume });
 
 	displayEffect(entity, CYST_EFFECT_ID::FOV);
 }
 
 void EffectsSystem::handle_direction_effect() {
 	// TODO
-	TimedEvent& effect_timer = registry.timedEvents.emplace(Entity());
-	effect_timer.callback = [this]() {
-		getEffect(CYST_EFFECT_ID::DIRECTION).is_active = false;
-		};
+	endAfter(DEFAULT_EFFECT_TIME, CYST_EFFECT_ID::DIRECTION, Entity());
 }
 
 void EffectsSystem::handle_no_attack_effect() {
@@ -232,23 +196,90 @@ void EffectsSystem::handle_no_attack_effect() {
 	float prev_delay = weapon.attack_delay;
 	weapon.attack_delay = 99999.f;
 
-	Mix_Chunk* prev_sound = soundChunks["player_shoot_1"];
 	soundChunks["player_shoot_1"] = soundChunks["no_ammo"];
 
-	Entity entity = Entity();
+	Entity entity = registry.create_entity();
 
-	TimedEvent& effect_timer = registry.timedEvents.emplace(entity);
-	effect_timer.timer_ms = NO_ATTACK_TIME;
-	effect_timer.callback = [this, prev_sound, prev_delay]() {
-		registry.guns.get(player).attack_delay = prev_delay;
-		registry.guns.get(player).attack_timer = 0;
-		soundChunks["player_shoot_1"] = prev_sound;
-		getEffect(CYST_EFFECT_ID::NO_ATTACK).is_active = false;
-		};
+	endAfter(NO_ATTACK_TIME, CYST_EFFECT_ID::NO_ATTACK, entity, { prev_delay });
 
 	displayEffect(entity, CYST_EFFECT_ID::NO_ATTACK);
 }
 
+void EffectsSystem::end_effect(const TimedEvent& event) {
+	const float* values = event.values;
+	switch (event.effect) {
+		case CYST_EFFECT_ID::DAMAGE: {
+			Gun& weapon = registry.guns.get(player);
+			weapon.damage = values[0];
+			weapon.bullet_speed = values[1];
+			weapon.bullet_size = { values[2], values[3] };
+			weapon.bullet_color = { values[4], values[5], values[6], values[7] };
+			break;
+		}
+		case CYST_EFFECT_ID::TRIPLE:
+			registry.tripleBullets.remove(player);
+			break;
+		case CYST_EFFECT_ID::LOTS:
+			registry.lotsOfBullets.remove(player);
+			break;
+		case CYST_EFFECT_ID::SLOW: {
+			Motion& motion = registry.motions.get(player);
+			motion.acceleration_unit = values[0];
+			motion.max_velocity = values[1];
+			break;
+		}
+		case CYST_EFFECT_ID::FOV:
+			registry.screenStates.components[0].limit_fov = false;
+			Mix_Volume(-1, (int)values[0]);
+			break;
+		case CYST_EFFECT_ID::NO_ATTACK:
+			registry.guns.get(player).attack_delay = values[0];
+			registry.guns.get(player).attack_timer = 0;
+			soundChunks["player_shoot_1"] = shoot_sound;
+			break;
+		default:
+			break;
+	}
+	getEffect(event.effect).is_active = false;
+	// Also removes the effect icon
+	registry.remove_all_components_of(event.entity);
+}
+
+void EffectsSystem::resume_effect(TimedEvent& event) {
+	getEffect(event.effect).is_active = true;
+	switch (event.effect) {
+		case CYST_EFFECT_ID::FOV:
+			registry.screenStates.components[0].limit_fov = true;
+			Mix_Volume(-1, (int)event.values[0] - 75);
+			break;
+		case CYST_EFFECT_ID::NO_ATTACK:
+			soundChunks["player_shoot_1"] = soundChunks["no_ammo"];
+			break;
+		default:
+			break;
+	}
+
+	event.entity = Entity();
+	if (effect_to_texture.count(event.effect) > 0) {
+		event.entity = registry.create_entity();
+		displayEffect(event.entity, event.effect);
+	}
+}
+
+void EffectsSystem::save_checkpoint(Checkpoint& checkpoint) {
+	checkpoint.rng = rng;
+	checkpoint.effects = effects;
+	checkpoint.player_shoot_sound = soundChunks["player_shoot_1"];
+	checkpoint.volume = Mix_Volume(-1, -1);
+}
+
+void EffectsSystem::restore_checkpoint(const Checkpoint& checkpoint) {
+	rng = checkpoint.rng;
+	effects = checkpoint.effects;
+	soundChunks["player_shoot_1"] = checkpoint.player_shoot_sound;
+	Mix_Volume(-1, checkpoint.volume);
+}
+
 /*************************[ helpers ]*************************/
 
 int EffectsSystem::countActivePositive() {
@@ -315,11 +346,16 @@ void EffectsSystem::displayEffect(Entity effect, CYST_EFFECT_ID id) {
 void EffectsSystem::setActiveTimer(CYST_EFFECT_ID id, float timer) {
 	getEffect(id).is_active = true;
 
-	TimedEvent& effect_timer = registry.timedEvents.emplace(Entity());
-	if (timer >= 0) {
-		effect_timer.timer_ms = timer;
-	}
-	effect_timer.callback = [this, id]() {
-		getEffect(id).is_active = false;
-		};
+	endAfter(timer >= 0 ? timer : DEFAULT_EFFECT_TIME, id, Entity());
+}
+
+// schedules the end of effect id, values as in end_effect
+void EffectsSystem::endAfter(float ms, CYST_EFFECT_ID id, Entity icon, std::initializer_list<float> values) {
+	TimedEvent event;
+	event.type = TIMED_EVENT_ID::EFFECT_END;
+	event.entity = icon;
+	event.effect = id;
+	assert(values.size() <= timed_event_value_count);
+	std::copy(values.begin(), values.end(), event.values);
+	ws.schedule_event(ms, event);
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include "tiny_ecs.hpp"
+#include "tiny_ecs_registry.hpp"
 #include "components.hpp"
+#include "random_service.hpp"
 #include <random>
 
 #define SDL_MAIN_HANDLED
@@ -68,8 +70,8 @@ class EffectsSystem{
 public:
 	Entity player;
 
-	EffectsSystem(Entity player, std::default_random_engine& rng, std::unordered_map<std::string, Mix_Chunk*> soundChunks, WorldSystem& ws)
-		: player(player), rng(rng), soundChunks(soundChunks), ws(ws) {
+	EffectsSystem(ECSRegistry& registry, Entity player, std::unordered_map<std::string, Mix_Chunk*> soundChunks, WorldSystem& ws)
+		: player(player), registry(registry), ws(ws), rng(registry.random.persistent_stream(RNG_STREAM_ID::EFFECTS)), soundChunks(soundChunks) {
 		// keep this in-sync with CYST_EFFECT_ID in components.hpp
 		effects.push_back({ CYST_EFFECT_ID::DAMAGE,       EFFECT_TYPE::POSITIVE});
 		effects.push_back({ CYST_EFFECT_ID::HEAL,         EFFECT_TYPE::POSITIVE});
@@ -87,9 +89,28 @@ public:
 		for (const auto& pair : neg_effect_weights) {
 			negWeights.push_back(pair.second);
 		}
+		shoot_sound = this->soundChunks["player_shoot_1"];
 	};
 	void apply_random_effect();
 
+	// Reverts the effect of an EFFECT_END event and removes its icon. The values hold what the effect
+	// changed: DAMAGE the gun's damage, bullet speed, bullet size (2) and color (4), SLOW the motion's
+	// acceleration and max velocity, FOV the volume, NO_ATTACK the attack delay.
+	void end_effect(const TimedEvent& event);
+	// Turns an effect of a loaded game back on. The world was saved with the effect applied, only
+	// the screen, sound and a new icon (put into event.entity) are left to redo.
+	void resume_effect(TimedEvent& event);
+
+	// What the effects keep outside the registry, see WorldSystem::push_checkpoint
+	struct Checkpoint {
+		RandomStream rng;
+		std::vector<Effect> effects;
+		Mix_Chunk* player_shoot_sound = nullptr;
+		int volume = 0;
+	};
+	void save_checkpoint(Checkpoint& checkpoint);
+	void restore_checkpoint(const Checkpoint& checkpoint);
+
 	~EffectsSystem();
 
 private:
@@ -104,15 +125,20 @@ private:
 	// no attack debuff consts
 	const float NO_ATTACK_TIME = 3500.f;
 
+	// duration of effects that do not set their own
+	const float DEFAULT_EFFECT_TIME = 10000.f;
+
+	ECSRegistry& registry;
 	WorldSystem& ws;
 
-	std::default_random_engine& rng;
+	RandomStream rng;
 
 	std::vector<Effect> effects;
 	std::vector<double> posWeights;
 	std::vector<double> negWeights;
 
 	std::unordered_map<std::string, Mix_Chunk*> soundChunks;
+	Mix_Chunk* shoot_sound;	// player_shoot_1 without NO_ATTACK
 
 	/*************************[ positive effects ]*************************/
 	void handle_damage_effect();
@@ -132,4 +158,5 @@ private:
 	void playSound(CYST_EFFECT_ID id);
 	void displayEffect(Entity effect, CYST_EFFECT_ID id);
 	void setActiveTimer(CYST_EFFECT_ID id, float timer);
+	void endAfter(float ms, CYST_EFFECT_ID id, Entity icon, std::initializer_list<float> values = {});
 };
@@ -1,7 +1,7 @@
 #include "menu_system.hpp"
 
-MenuSystem::MenuSystem(const vec2& mouse)
-    : curr_mouse(mouse) {
+MenuSystem::MenuSystem(ECSRegistry& registry, const vec2& mouse)
+    : registry(registry), curr_mouse(mouse) {
     assets_drawn = false;
     // Initialize with an impossible coordinate
     recent_click_coord = {1.0e9f, 1.0e9f};
@@ -96,7 +96,7 @@ MENU_OPTION MenuSystem::poll_pause_menu() {
 }
 
 Entity MenuSystem::create_menu_button(vec2 pos, TEXTURE_ASSET_ID texture, MENU_OPTION option) {
-    auto entity = Entity();
+    auto entity = registry.create_entity();
     Transform& transform = registry.transforms.emplace(entity);
     transform.position = pos;
     transform.scale = MENU_BUTTON_TEXTURE_SIZE * 0.5f;
@@ -116,15 +116,15 @@ Entity MenuSystem::create_menu_button(vec2 pos, TEXTURE_ASSET_ID texture, MENU_O
 }
 
 Entity MenuSystem::create_menu_bg() {
-    auto bg_entity = Entity();
+    auto bg_entity = registry.create_entity();
     Transform& bg_transform = registry.transforms.emplace(bg_entity);
     bg_transform.position = {0.f, 0.f};
     bg_transform.scale = {CONTENT_WIDTH_PX, CONTENT_HEIGHT_PX};
     bg_transform.is_screen_coord = true;
 
     // Randomly select a bg to use for menu
-    std::srand(std::time(nullptr));
-    TEXTURE_ASSET_ID random_bg = static_cast<TEXTURE_ASSET_ID>(static_cast<int>(TEXTURE_ASSET_ID::NERVOUS_BG) + std::rand() % 6);
+    RandomStream rng = registry.random.stream(RNG_STREAM_ID::MENU, bg_entity);
+    TEXTURE_ASSET_ID random_bg = static_cast<TEXTURE_ASSET_ID>(static_cast<int>(TEXTURE_ASSET_ID::NERVOUS_BG) + rng.uniform_int(6));
 
     registry.renderRequests.insert(
 		bg_entity,
@@ -142,7 +142,7 @@ void MenuSystem::draw_start_menu() {
     create_menu_bg();
 
     // Create title
-    auto title_entity = Entity();
+    auto title_entity = registry.create_entity();
     Transform& title_transform = registry.transforms.emplace(title_entity);
     title_transform.position = {0.f, 320.f};
     title_transform.scale = START_TITLE_TEXTURE_SIZE * 0.4f;
@@ -181,7 +181,7 @@ void MenuSystem::draw_pause_menu() {
     create_menu_bg();
 
     // Create title (Game Paused)
-    auto title_entity = Entity();
+    auto title_entity = registry.create_entity();
     Transform& title_transform = registry.transforms.emplace(title_entity);
     title_transform.position = {0.f, 400.f};
     title_transform.scale = PAUSE_TITLE_TEXTURE_SIZE;
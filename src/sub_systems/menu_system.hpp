@@ -8,13 +8,14 @@
 
 class MenuSystem {
 public:
-    MenuSystem (const vec2& mouse);
+    MenuSystem (ECSRegistry& registry, const vec2& mouse);
     MENU_OPTION poll_start_menu();
     MENU_OPTION poll_pause_menu();
     vec2 recent_click_coord;
     ~MenuSystem();
 
 private:
+    ECSRegistry& registry;
     bool assets_drawn;
     const vec2& curr_mouse;
     bool is_muted;
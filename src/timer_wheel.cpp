@@ -0,0 +1,192 @@
+// internal
+#include "timer_wheel.hpp"
+
+// stlib
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+const uint32_t TimerWheel::NONE;
+const uint64_t TimerWheel::MAX_DELAY_TICKS;
+
+TimerWheel::TimerWheel() {
+	std::fill(heads, heads + SLOT_COUNT, NONE);
+	std::fill(tails, tails + SLOT_COUNT, NONE);
+}
+
+TimerHandle TimerWheel::schedule(float delay_ms, TimerCallback callback) {
+	assert(callback && "Timer without callback");
+	uint32_t index = allocate();
+	Timer& timer = timers[index];
+
+	// At least one tick, so a timer scheduled from a callback never fires in the same tick
+	uint64_t delay = delay_ms > 1.f ? (uint64_t)std::ceil(delay_ms) : 1;
+	timer.expiry = now + std::min(delay, MAX_DELAY_TICKS);
+	timer.sequence = next_sequence++;
+	timer.callback = std::move(callback);
+	link(index);
+	count++;
+	return { index, timer.generation };
+}
+
+bool TimerWheel::cancel(TimerHandle handle) {
+	if (!is_pending(handle)) return false;
+	unlink(handle.index);
+	timers[handle.index].callback.reset();
+	release(handle.index);
+	count--;
+	return true;
+}
+
+bool TimerWheel::is_pending(TimerHandle handle) const {
+	return handle.index < timers.size()
+		&& timers[handle.index].generation == handle.generation
+		&& timers[handle.index].slot != NONE;
+}
+
+float TimerWheel::remaining_ms(TimerHandle handle) const {
+	if (!is_pending(handle)) return 0.f;
+	return std::max(0.f, (float)(timers[handle.index].expiry - now) - fraction_ms);
+}
+
+void TimerWheel::advance(float elapsed_ms) {
+	fraction_ms += elapsed_ms;
+	while (fraction_ms >= 1.f) {
+		fraction_ms -= 1.f;
+		now++;
+
+		uint32_t root_index = (uint32_t)(now & (ROOT_SIZE - 1));
+		if (root_index == 0) cascade(1);
+
+		// Pop one timer at a time: callbacks may schedule or cancel timers, including ones in this slot
+		uint32_t& head = heads[root_index];
+		while (head != NONE) {
+			uint32_t index = head;
+			unlink(index);
+			TimerCallback callback = std::move(timers[index].callback);
+			release(index);
+			count--;
+			callback();
+		}
+	}
+}
+
+void TimerWheel::flush() {
+	// Collect first, the callbacks are free to touch the wheel
+	std::vector<TimerCallback> pending;
+	pending.reserve(count);
+	for (uint32_t slot = 0; slot < SLOT_COUNT; slot++) {
+		while (heads[slot] != NONE) {
+			uint32_t index = heads[slot];
+			unlink(index);
+			pending.push_back(std::move(timers[index].callback));
+			release(index);
+		}
+	}
+	count = 0;
+	for (TimerCallback& callback : pending) {
+		callback();
+	}
+	clear();
+}
+
+void TimerWheel::clear() {
+	for (uint32_t slot = 0; slot < SLOT_COUNT; slot++) {
+		while (heads[slot] != NONE) {
+			uint32_t index = heads[slot];
+			unlink(index);
+			timers[index].callback.reset();
+			release(index);
+		}
+	}
+	count = 0;
+}
+
+void TimerWheel::set_time(Time time) {
+	assert(count == 0 && "Pending timers would be lost in the wheel");
+	now = time.tick;
+	fraction_ms = time.fraction_ms;
+}
+
+uint32_t TimerWheel::allocate() {
+	if (free_head != NONE) {
+		uint32_t index = free_head;
+		free_head = timers[index].next;
+		timers[index].next = NONE;
+		return index;
+	}
+	timers.emplace_back();
+	return (uint32_t)timers.size() - 1;
+}
+
+void TimerWheel::release(uint32_t index) {
+	Timer& timer = timers[index];
+	timer.generation++;	// Invalidates outstanding handles
+	timer.next = free_head;
+	free_head = index;
+}
+
+void TimerWheel::link(uint32_t index) {
+	Timer& timer = timers[index];
+	uint64_t delta = timer.expiry > now ? timer.expiry - now : 0;
+
+	uint32_t slot;
+	if (delta < ROOT_SIZE) {
+		slot = (uint32_t)(timer.expiry & (ROOT_SIZE - 1));
+	}
+	else {
+		uint32_t level = 1;
+		while (level < LEVEL_COUNT && delta >= (1ull << (ROOT_BITS + level * LEVEL_BITS))) {
+			level++;
+		}
+		uint32_t shift = ROOT_BITS + (level - 1) * LEVEL_BITS;
+		slot = ROOT_SIZE + (level - 1) * LEVEL_SIZE + (uint32_t)((timer.expiry >> shift) & (LEVEL_SIZE - 1));
+	}
+
+	// Inserted by sequence, searching from the tail. New timers just go to the end, only cascaded
+	// ones can land before timers that were scheduled later straight into the slot.
+	uint32_t prev = tails[slot];
+	while (prev != NONE && timers[prev].sequence > timer.sequence) {
+		prev = timers[prev].prev;
+	}
+	timer.slot = slot;
+	timer.prev = prev;
+	timer.next = prev != NONE ? timers[prev].next : heads[slot];
+	if (prev != NONE) timers[prev].next = index;
+	else heads[slot] = index;
+	if (timer.next != NONE) timers[timer.next].prev = index;
+	else tails[slot] = index;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+	Timer& timer = timers[index];
+	if (timer.prev != NONE) {
+		timers[timer.prev].next = timer.next;
+	}
+	else {
+		heads[timer.slot] = timer.next;
+	}
+	if (timer.next != NONE) {
+		timers[timer.next].prev = timer.prev;
+	}
+	else {
+		tails[timer.slot] = timer.prev;
+	}
+	timer.prev = NONE;
+	timer.next = NONE;
+	timer.slot = NONE;
+}
+
+void TimerWheel::cascade(uint32_t level) {
+	uint32_t shift = ROOT_BITS + (level - 1) * LEVEL_BITS;
+	uint32_t level_index = (uint32_t)((now >> shift) & (LEVEL_SIZE - 1));
+	// The outer wheel wraps first so its timers land in this one before it is redistributed
+	if (level_index == 0 && level < LEVEL_COUNT) cascade(level + 1);
+
+	uint32_t& head = heads[ROOT_SIZE + (level - 1) * LEVEL_SIZE + level_index];
+	while (head != NONE) {
+		uint32_t index = head;
+		unlink(index);
+		link(index);
+	}
+}
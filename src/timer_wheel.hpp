@@ -0,0 +1,185 @@
+#pragma once
+
+// stlib
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A void() callable stored inline when its captures fit in INLINE_SIZE bytes, on the heap otherwise.
+// Timer callbacks are small lambdas (a few floats and a pointer), so they never allocate.
+class TimerCallback
+{
+public:
+	static const size_t INLINE_SIZE = 48;
+
+	TimerCallback() = default;
+	template <typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, TimerCallback>::value>::type>
+	TimerCallback(F&& f) { assign(std::forward<F>(f)); }
+	TimerCallback(TimerCallback&& other) { move_from(other); }
+	TimerCallback& operator=(TimerCallback&& other) {
+		if (this != &other) {
+			reset();
+			move_from(other);
+		}
+		return *this;
+	}
+	TimerCallback(const TimerCallback&) = delete;
+	TimerCallback& operator=(const TimerCallback&) = delete;
+	~TimerCallback() { reset(); }
+
+	void operator()() { ops->invoke(storage); }
+	explicit operator bool() const { return ops != nullptr; }
+
+	void reset() {
+		if (ops) {
+			ops->destroy(storage);
+			ops = nullptr;
+		}
+	}
+
+private:
+	struct Ops {
+		void (*invoke)(void*);
+		void (*move)(void* dst, void* src);
+		void (*destroy)(void*);
+	};
+
+	template <typename Fn>
+	struct InlineOps {
+		static void invoke(void* p) { (*static_cast<Fn*>(p))(); }
+		static void move(void* dst, void* src) { new (dst) Fn(std::move(*static_cast<Fn*>(src))); }
+		static void destroy(void* p) { static_cast<Fn*>(p)->~Fn(); }
+		static const Ops ops;
+	};
+
+	template <typename Fn>
+	struct HeapOps {
+		static void invoke(void* p) { (**static_cast<Fn**>(p))(); }
+		// Hands the pointer over, the source must not delete it
+		static void move(void* dst, void* src) {
+			*static_cast<Fn**>(dst) = *static_cast<Fn**>(src);
+			*static_cast<Fn**>(src) = nullptr;
+		}
+		static void destroy(void* p) { delete *static_cast<Fn**>(p); }
+		static const Ops ops;
+	};
+
+	// Whether Fn is stored inline is decided at compile time, so oversized callables never reach
+	// the placement new
+	template <typename Fn>
+	struct FitsInline : std::integral_constant<bool, sizeof(Fn) <= INLINE_SIZE && alignof(Fn) <= alignof(std::max_align_t)> {};
+
+	template <typename F>
+	void assign(F&& f) {
+		typedef typename std::decay<F>::type Fn;
+		assign<Fn>(std::forward<F>(f), FitsInline<Fn>());
+	}
+	template <typename Fn, typename F>
+	void assign(F&& f, std::true_type) {
+		new (storage) Fn(std::forward<F>(f));
+		ops = &InlineOps<Fn>::ops;
+	}
+	template <typename Fn, typename F>
+	void assign(F&& f, std::false_type) {
+		*reinterpret_cast<Fn**>(storage) = new Fn(std::forward<F>(f));
+		ops = &HeapOps<Fn>::ops;
+	}
+
+	void move_from(TimerCallback& other) {
+		ops = other.ops;
+		if (ops) {
+			ops->move(storage, other.storage);
+			ops->destroy(other.storage);
+			other.ops = nullptr;
+		}
+	}
+
+	alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+	const Ops* ops = nullptr;
+};
+
+template <typename Fn>
+const TimerCallback::Ops TimerCallback::InlineOps<Fn>::ops = { &InlineOps<Fn>::invoke, &InlineOps<Fn>::move, &InlineOps<Fn>::destroy };
+template <typename Fn>
+const TimerCallback::Ops TimerCallback::HeapOps<Fn>::ops = { &HeapOps<Fn>::invoke, &HeapOps<Fn>::move, &HeapOps<Fn>::destroy };
+
+// Refers to a scheduled timer. Stays safe to use after the timer fired or was cancelled.
+struct TimerHandle {
+	uint32_t index = UINT32_MAX;
+	uint32_t generation = 0;
+};
+
+// Hierarchical timing wheel with 1 ms ticks: a 256 slot wheel for the next quarter second and three
+// 64 slot wheels above it, up to about 18 hours. Scheduling, cancelling and firing are O(1); timers
+// in the outer wheels are only touched when their slot cascades down, so idle timers cost nothing.
+class TimerWheel
+{
+public:
+	TimerWheel();
+
+	TimerHandle schedule(float delay_ms, TimerCallback callback);
+	// Returns false if the timer already fired or was cancelled
+	bool cancel(TimerHandle handle);
+	bool is_pending(TimerHandle handle) const;
+	// Remaining time of a pending timer, 0 otherwise
+	float remaining_ms(TimerHandle handle) const;
+
+	// Moves time forward and fires every timer that expired, in expiry order. Timers expiring on the
+	// same tick fire in the order they were scheduled.
+	void advance(float elapsed_ms);
+	// Fires every pending timer now, e.g. to revert active effects before a reset. Timers scheduled
+	// by those callbacks are dropped.
+	void flush();
+	// Drops every pending timer without firing it
+	void clear();
+
+	// Current time of the wheel. Putting it back before scheduling the remaining_ms of saved timers
+	// again makes them expire on the same ticks as before.
+	struct Time {
+		uint64_t tick = 0;
+		float fraction_ms = 0.f;
+	};
+	Time time() const { return { now, fraction_ms }; }
+	// Only while no timer is pending
+	void set_time(Time time);
+
+	size_t size() const { return count; }
+
+private:
+	static const uint32_t NONE = UINT32_MAX;
+	static const uint32_t ROOT_BITS = 8;
+	static const uint32_t LEVEL_BITS = 6;
+	static const uint32_t LEVEL_COUNT = 3;	// Levels above the root wheel
+	static const uint32_t ROOT_SIZE = 1 << ROOT_BITS;
+	static const uint32_t LEVEL_SIZE = 1 << LEVEL_BITS;
+	static const uint32_t SLOT_COUNT = ROOT_SIZE + LEVEL_COUNT * LEVEL_SIZE;
+	static const uint64_t MAX_DELAY_TICKS = (1ull << (ROOT_BITS + LEVEL_COUNT * LEVEL_BITS)) - 1;
+
+	struct Timer {
+		uint64_t expiry = 0;	// Absolute tick
+		uint64_t sequence = 0;	// Scheduling order, slots are sorted by it
+		uint32_t prev = NONE;
+		uint32_t next = NONE;	// Also links the free list
+		uint32_t slot = NONE;	// NONE when the timer is not scheduled
+		uint32_t generation = 0;
+		TimerCallback callback;
+	};
+
+	std::vector<Timer> timers;
+	uint32_t free_head = NONE;
+	uint32_t heads[SLOT_COUNT];
+	uint32_t tails[SLOT_COUNT];
+	uint64_t next_sequence = 0;
+	uint64_t now = 0;			// Current tick
+	float fraction_ms = 0.f;	// Time not yet converted into a tick
+	size_t count = 0;
+
+	uint32_t allocate();
+	void release(uint32_t index);
+	void link(uint32_t index);
+	void unlink(uint32_t index);
+	void cascade(uint32_t level);
+};
@@ -1,5 +0,0 @@
-// internal
-#include "tiny_ecs.hpp"
-
-// All we need to store besides the containers is the id of every entity and callbacks to be able to remove entities across containers
-unsigned int Entity::id_count = 1;
\ No newline at end of file
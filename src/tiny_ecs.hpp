@@ -5,21 +5,98 @@
 #include <unordered_map>
 #include <set>
 #include <functional>
+#include <memory>
 #include <typeindex>
 #include <assert.h>
 
-// Unique identifyer for all entities
+// Unique identifyer for all entities of one registry
 class Entity
 {
 	unsigned int id;
-	static unsigned int id_count; // starts from 1, entit 0 is the default initialization
 public:
-	Entity()
+	// The low INDEX_BITS of an id number the entity, the bits above are its generation. A reused
+	// number comes back one generation later (see PrefabLibrary::recycle), and containers key on
+	// the whole id, so a handle kept from before (e.g. by a timer) no longer finds any components.
+	static const unsigned int INDEX_BITS = 24;
+	static const unsigned int INDEX_MASK = (1u << INDEX_BITS) - 1;
+
+	// Entity 0 is the default initialization and never has components, new entities come from
+	// ECSRegistry::create_entity so every world numbers its entities independently.
+	Entity() : id(0) {}
+	explicit Entity(unsigned int id) : id(id) {}
+	operator unsigned int() { return id; } // this enables automatic casting to int
+
+	unsigned int index() const { return id & INDEX_MASK; }
+	unsigned int generation() const { return id >> INDEX_BITS; }
+	// The same number for its next use. Generations wrap around after 256 reuses.
+	Entity next_generation() const { return Entity(index() | ((generation() + 1) << INDEX_BITS)); }
+};
+
+// Allocator for the entity -> index maps. Single nodes are kept on a per-thread free list when
+// released, so removing and re-inserting components (e.g. recycled enemies) does not hit the heap.
+template <typename T>
+struct NodeAllocator
+{
+	typedef T value_type;
+
+	NodeAllocator() = default;
+	template <typename U>
+	NodeAllocator(const NodeAllocator<U>&) {}
+
+	T* allocate(size_t n)
 	{
-		id = id_count++;
-		// Note, indices of already deleted entities arent re-used in this simple implementation.
+		FreeList& list = free_list();
+		if (n == 1 && list.head) {
+			FreeNode* node = list.head;
+			list.head = node->next;
+			return reinterpret_cast<T*>(node);
+		}
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T* p, size_t n)
+	{
+		if (n == 1 && sizeof(T) >= sizeof(FreeNode)) {
+			FreeList& list = free_list();
+			FreeNode* node = reinterpret_cast<FreeNode*>(p);
+			node->next = list.head;
+			list.head = node;
+		}
+		else {
+			::operator delete(p);
+		}
+	}
+
+private:
+	struct FreeNode { FreeNode* next; };
+	struct FreeList
+	{
+		FreeNode* head = nullptr;
+		~FreeList()
+		{
+			while (head) {
+				FreeNode* next = head->next;
+				::operator delete(head);
+				head = next;
+			}
+		}
+	};
+	static FreeList& free_list()
+	{
+		static thread_local FreeList list;
+		return list;
 	}
-	operator unsigned int() { return id; } // this enables automatic casting to int
+};
+
+template <typename T, typename U>
+bool operator==(const NodeAllocator<T>&, const NodeAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const NodeAllocator<T>&, const NodeAllocator<U>&) { return false; }
+
+// Copy of the contents of one container, made by the container it belongs to
+struct ContainerSnapshot
+{
+	virtual ~ContainerSnapshot() {}
 };
 
 // Common interface to refer to all containers in the ECS registry
@@ -29,6 +106,12 @@ struct ContainerInterface
 	virtual size_t size() = 0;
 	virtual void remove(Entity e) = 0;
 	virtual bool has(Entity entity) = 0;
+
+	// An empty snapshot that save and restore of this container accept
+	virtual std::unique_ptr<ContainerSnapshot> create_snapshot() = 0;
+	virtual void save(ContainerSnapshot& snapshot) = 0;
+	// Replaces the contents with the snapshot, without running any hooks
+	virtual void restore(const ContainerSnapshot& snapshot) = 0;
 };
 
 // A container that stores components of type 'Component' and associated entities
@@ -37,7 +120,8 @@ class ComponentContainer : public ContainerInterface
 {
 private:
 	// The hash map from Entity -> array index.
-	std::unordered_map<unsigned int, unsigned int> map_entity_componentID; // the entity is cast to uint to be hashable.
+	std::unordered_map<unsigned int, unsigned int, std::hash<unsigned int>, std::equal_to<unsigned int>,
+		NodeAllocator<std::pair<const unsigned int, unsigned int>>> map_entity_componentID; // the entity is cast to uint to be hashable.
 	bool registered = false;
 public:
 	// Container of all components of type 'Component'
@@ -46,6 +130,11 @@ public:
 	// The corresponding entities
 	std::vector<Entity> entities;
 
+	// Optional lifecycle hooks: on_insert runs after a component was added, on_remove before it goes
+	// away (also for clear()). They must not insert into or remove from this same container.
+	std::function<void(Entity, Component&)> on_insert;
+	std::function<void(Entity, Component&)> on_remove;
+
 	// Constructor that registers the type
 	ComponentContainer()
 	{
@@ -54,7 +143,10 @@ public:
 	// Update a component associated with an entity
 	inline void update(Entity e, const Component& c) {
         assert(has(e) && "Entity not contained in ECS registry");
-        components[map_entity_componentID[e]] = c;
+        Component& component = components[map_entity_componentID[e]];
+        if (on_remove) on_remove(e, component);
+        component = c;
+        if (on_insert) on_insert(e, component);
     }
 
 	// Inserting a component c associated to entity e
@@ -66,9 +158,22 @@ public:
 		map_entity_componentID[e] = (unsigned int)components.size();
 		components.push_back(std::move(c)); // the move enforces move instead of copy constructor
 		entities.push_back(e);
+		if (on_insert) on_insert(e, components.back());
 		return components.back();
 	};
 
+	// Make room for n more components, e.g. before inserting a batch. Keeps the geometric growth of the vectors.
+	void reserve_additional(size_t n)
+	{
+		size_t required = components.size() + n;
+		if (components.capacity() < required) {
+			size_t grown = std::max(required, components.capacity() * 2);
+			components.reserve(grown);
+			entities.reserve(grown);
+		}
+		map_entity_componentID.reserve(required);
+	}
+
 	// The emplace function takes the the provided arguments Args, creates a new object of type Component, and inserts it into the ECS system
 	template<typename... Args>
 	Component& emplace(Entity e, Args &&... args) {
@@ -85,7 +190,8 @@ public:
 		return components[map_entity_componentID[e]];
 	}
 
-	// Check if entity has a component of type 'Component'
+	// Check if entity has a component of type 'Component'. False for handles of an older
+	// generation, the map is keyed by the whole id.
 	bool has(Entity entity) {
 		return map_entity_componentID.count(entity) > 0;
 	}
@@ -97,6 +203,7 @@ public:
 		{
 			// Get the current position
 			int cID = map_entity_componentID[e];
+			if (on_remove) on_remove(e, components[cID]);
 
 			// Move the last element to position cID using the move operator
 			// Note, components[cID] = components.back() would trigger the copy instead of move operator
@@ -115,6 +222,10 @@ public:
 	// Remove all components of type 'Component'
 	void clear()
 	{
+		if (on_remove) {
+			for (size_t i = 0; i < components.size(); i++)
+				on_remove(entities[i], components[i]);
+		}
 		map_entity_componentID.clear();
 		components.clear();
 		entities.clear();
@@ -126,6 +237,37 @@ public:
 		return components.size();
 	}
 
+	// The dense arrays as they were. Saving into the same snapshot again reuses its memory.
+	struct Snapshot : ContainerSnapshot
+	{
+		std::vector<Component> components;
+		std::vector<Entity> entities;
+	};
+
+	std::unique_ptr<ContainerSnapshot> create_snapshot()
+	{
+		return std::unique_ptr<ContainerSnapshot>(new Snapshot());
+	}
+
+	void save(ContainerSnapshot& snapshot)
+	{
+		Snapshot& saved = static_cast<Snapshot&>(snapshot);
+		saved.components = components;
+		saved.entities = entities;
+	}
+
+	// The entity map is rebuilt from the entities, its nodes come from the free list of clear()
+	void restore(const ContainerSnapshot& snapshot)
+	{
+		const Snapshot& saved = static_cast<const Snapshot&>(snapshot);
+		components = saved.components;
+		entities = saved.entities;
+		map_entity_componentID.clear();
+		map_entity_componentID.reserve(entities.size());
+		for (unsigned int i = 0; i < entities.size(); i++)
+			map_entity_componentID[entities[i]] = i;
+	}
+
 	// Sort the components and associated entity assignment structures by the comparisonFunction, see std::sort
 	template <class Compare>
 	void sort(Compare comparisonFunction)
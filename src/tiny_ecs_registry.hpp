@@ -1,9 +1,34 @@
 #pragma once
+#include <memory>
 #include <vector>
 
 #include "tiny_ecs.hpp"
 #include "components.hpp"
+#include "projectile_pool.hpp"
+#include "attachment_hierarchy.hpp"
+#include "contact_cache.hpp"
+#include "population_index.hpp"
+#include "event_bus.hpp"
+#include "prefabs.hpp"
+#include "random_service.hpp"
 
+// Copy of everything a registry holds, see ECSRegistry::save_snapshot. Made by create_snapshot for
+// one registry; saving into it again reuses its memory, so a warm snapshot costs no allocations
+// for components without heap members.
+struct RegistrySnapshot
+{
+	std::vector<std::unique_ptr<ContainerSnapshot>> containers;	// In the order of registry_list
+	ProjectilePool projectiles;
+	ContactCache contacts;
+	PopulationIndex population;
+	RandomService random;
+	PrefabLibrary::Pools prefab_pools;
+	unsigned int next_entity_id = 0;
+	bool saved = false;
+};
+
+// Everything one simulated world owns. Systems get the registry of their world at construction
+// and free functions take it as first argument, so several worlds can run side by side.
 class ECSRegistry
 {
 	// Callbacks to remove a particular or all entities in the system
@@ -14,7 +39,6 @@ public:
 	ComponentContainer<DeathTimer> deathTimers;
 	ComponentContainer<Transform> transforms;
 	ComponentContainer<Motion> motions;
-	ComponentContainer<Collision> collisions;
 	ComponentContainer<Player> players;
 	ComponentContainer<Enemy> enemies;
 	ComponentContainer<Mesh*> meshPtrs;
@@ -27,74 +51,110 @@ public:
 	ComponentContainer<Health> healthValues;
 	ComponentContainer<Healthbar> healthbar;
 	ComponentContainer<Gun> guns;
-	ComponentContainer<Projectile> projectiles;
 	ComponentContainer<Invincibility> invincibility;
 	ComponentContainer<Dash> dashes;
 	ComponentContainer<Animation> animations;
 	ComponentContainer<CollidePlayer> collidePlayers;
 	ComponentContainer<CollideEnemy> collideEnemies;
-	ComponentContainer<Attachment> attachments;
+	AttachmentContainer attachments;
 	ComponentContainer<Camera> camera;
 	ComponentContainer<Cyst> cysts;
-	ComponentContainer<TimedEvent> timedEvents;
 	ComponentContainer<MenuElem> menuElems;
 	ComponentContainer<MenuButton> menuButtons;
 	ComponentContainer<Melee> melees;
 	ComponentContainer<Waypoint> waypoints;
 	ComponentContainer<Boss> bosses;
 	ComponentContainer<Cure> cure;
+	ComponentContainer<DistanceRing> distanceRings;
 	ComponentContainer<PlayerAbility> playerAbilities;
 	ComponentContainer<Game> game;
 	ComponentContainer<Credits> credits;
 	ComponentContainer<GameMode> gameMode;
 	ComponentContainer<TripleBullets> tripleBullets;
 	ComponentContainer<LotsOfBullets> lotsOfBullets;
-	
 
-	// constructor that adds all containers for looping over them
+	// Bullets are not entities, see projectile_pool.hpp
+	ProjectilePool projectiles;
+	// Collisions found by the physics system this step, see event_bus.hpp
+	CollisionEventBus collisionEvents;
+	// Pairs of entities touching each other, see contact_cache.hpp
+	ContactCache contacts;
+	// Enemy counts by type and region, kept in sync with enemies
+	PopulationIndex population;
+	// Seed and tick of this world's random streams
+	RandomService random;
+	// Enemy templates and their recycled entities
+	PrefabLibrary prefabs;
+	// Counts restore_snapshot calls, caches built from the containers compare it to notice one
+	unsigned int restores = 0;
+
+
+	// Calls visitor with a pointer to every container member, in the order of registry_list
 	// IMPORTANT: Don't forget to add any newly added containers!
+	template <typename Visitor>
+	static constexpr void for_each_container(Visitor&& visitor)
+	{
+		visitor(&ECSRegistry::deathTimers);
+		visitor(&ECSRegistry::transforms);
+		visitor(&ECSRegistry::motions);
+		visitor(&ECSRegistry::players);
+		visitor(&ECSRegistry::enemies);
+		visitor(&ECSRegistry::meshPtrs);
+		visitor(&ECSRegistry::renderRequests);
+		visitor(&ECSRegistry::screenStates);
+		visitor(&ECSRegistry::debugComponents);
+		visitor(&ECSRegistry::colors);
+		visitor(&ECSRegistry::regions);
+		visitor(&ECSRegistry::chests);
+		visitor(&ECSRegistry::healthValues);
+		visitor(&ECSRegistry::healthbar);
+		visitor(&ECSRegistry::invincibility);
+		visitor(&ECSRegistry::animations);
+		visitor(&ECSRegistry::dashes);
+		visitor(&ECSRegistry::guns);
+		visitor(&ECSRegistry::collidePlayers);
+		visitor(&ECSRegistry::collideEnemies);
+		visitor(&ECSRegistry::attachments);
+		visitor(&ECSRegistry::camera);
+		visitor(&ECSRegistry::cysts);
+		visitor(&ECSRegistry::menuElems);
+		visitor(&ECSRegistry::menuButtons);
+		visitor(&ECSRegistry::melees);
+		visitor(&ECSRegistry::waypoints);
+		visitor(&ECSRegistry::bosses);
+		visitor(&ECSRegistry::cure);
+		visitor(&ECSRegistry::distanceRings);
+		visitor(&ECSRegistry::playerAbilities);
+		visitor(&ECSRegistry::game);
+		visitor(&ECSRegistry::credits);
+		visitor(&ECSRegistry::gameMode);
+		visitor(&ECSRegistry::tripleBullets);
+		visitor(&ECSRegistry::lotsOfBullets);
+	}
+
+	// constructor that adds all containers for looping over them
 	ECSRegistry()
 	{
-		registry_list.push_back(&deathTimers);
-		registry_list.push_back(&transforms);
-		registry_list.push_back(&motions);
-		registry_list.push_back(&collisions);
-		registry_list.push_back(&players);
-		registry_list.push_back(&enemies);
-		registry_list.push_back(&meshPtrs);
-		registry_list.push_back(&renderRequests);
-		registry_list.push_back(&screenStates);
-		registry_list.push_back(&debugComponents);
-		registry_list.push_back(&colors);
-		registry_list.push_back(&regions);
-		registry_list.push_back(&chests);
-		registry_list.push_back(&healthValues);
-		registry_list.push_back(&projectiles);
-		registry_list.push_back(&invincibility);
-		registry_list.push_back(&animations);
-		registry_list.push_back(&dashes);
-		registry_list.push_back(&guns);
-		registry_list.push_back(&collidePlayers);
-		registry_list.push_back(&collideEnemies);
-		registry_list.push_back(&attachments);
-		registry_list.push_back(&camera);
-		registry_list.push_back(&cysts);
-		registry_list.push_back(&timedEvents);
-		registry_list.push_back(&menuElems);
-		registry_list.push_back(&menuButtons);
-		registry_list.push_back(&melees);
-		registry_list.push_back(&waypoints);
-		registry_list.push_back(&bosses);
-		registry_list.push_back(&cure);
-		registry_list.push_back(&playerAbilities);
-		registry_list.push_back(&game);
-		registry_list.push_back(&credits);
-		registry_list.push_back(&gameMode);
+		for_each_container([this](auto member) { registry_list.push_back(&(this->*member)); });
+
+		population.track(enemies, transforms);
+	}
+
+	// The container hooks point into this registry, so it stays where it was created
+	ECSRegistry(const ECSRegistry&) = delete;
+	ECSRegistry& operator=(const ECSRegistry&) = delete;
+
+	Entity create_entity() {
+		assert(next_entity_id <= Entity::INDEX_MASK && "Out of entity numbers");
+		return Entity(next_entity_id++);
 	}
 
 	void clear_all_components() {
 		for (ContainerInterface* reg : registry_list)
 			reg->clear();
+		projectiles.clear();
+		collisionEvents.clear();
+		contacts.clear();
 	}
 
 	void list_all_components() {
@@ -102,6 +162,8 @@ public:
 		for (ContainerInterface* reg : registry_list)
 			if (reg->size() > 0)
 				printf("%4d components of type %s\n", (int)reg->size(), typeid(*reg).name());
+		if (projectiles.size() > 0)
+			printf("%4d projectiles\n", (int)projectiles.size());
 	}
 
 	void list_all_components_of(Entity e) {
@@ -114,7 +176,47 @@ public:
 	void remove_all_components_of(Entity e) {
 		for (ContainerInterface* reg : registry_list)
 			reg->remove(e);
+		contacts.forget(e);
+	}
+
+	RegistrySnapshot create_snapshot() {
+		RegistrySnapshot snapshot;
+		for (ContainerInterface* reg : registry_list)
+			snapshot.containers.push_back(reg->create_snapshot());
+		return snapshot;
 	}
-};
 
-extern ECSRegistry registry;
\ No newline at end of file
+	// Copies the dense component arrays, the entity counter and the state kept next to the
+	// containers. Pending collision events are not saved, take snapshots between steps.
+	void save_snapshot(RegistrySnapshot& snapshot) {
+		assert(snapshot.containers.size() == registry_list.size() && "Snapshot of another registry");
+		for (size_t i = 0; i < registry_list.size(); i++)
+			registry_list[i]->save(*snapshot.containers[i]);
+		snapshot.projectiles = projectiles;
+		snapshot.contacts = contacts;
+		snapshot.population = population;
+		snapshot.random = random;
+		snapshot.prefab_pools = prefabs.get_pools();
+		snapshot.next_entity_id = next_entity_id;
+		snapshot.saved = true;
+	}
+
+	// Puts the registry back to the saved state in bulk. Container hooks don't run, state they
+	// keep outside the registry has to be rebuilt by its owner, see SpawnManager::rebuild.
+	void restore_snapshot(const RegistrySnapshot& snapshot) {
+		assert(snapshot.saved && snapshot.containers.size() == registry_list.size() && "Snapshot was never saved");
+		for (size_t i = 0; i < registry_list.size(); i++)
+			registry_list[i]->restore(*snapshot.containers[i]);
+		projectiles = snapshot.projectiles;
+		collisionEvents.clear();
+		contacts = snapshot.contacts;
+		population = snapshot.population;
+		random = snapshot.random;
+		prefabs.set_pools(snapshot.prefab_pools);
+		next_entity_id = snapshot.next_entity_id;
+		restores++;
+	}
+
+private:
+	unsigned int next_entity_id = 1;	// 0 is the default initialized Entity
+};
@@ -0,0 +1,36 @@
+// stlib
+#include <cstdlib>
+#include <cstring>
+
+// internal
+#include "save_game.hpp"
+
+static bool has_suffix(const std::string& text, const std::string& suffix) {
+	return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Converts save games between the binary format and JSON, picking the direction from the file
+// extensions, e.g. save_convert savegame.bin savegame.json to inspect a save and back to play it.
+int main(int argc, char* argv[])
+{
+	if (argc != 3) {
+		fprintf(stderr, "Usage: %s <input.bin|input.json> <output.bin|output.json>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	std::string input = argv[1];
+	std::string output = argv[2];
+
+	SaveState state;
+	bool read = has_suffix(input, ".json") ? read_save_json(input, state) : read_save_binary(input, state);
+	if (!read) {
+		fprintf(stderr, "Failed to read %s\n", input.c_str());
+		return EXIT_FAILURE;
+	}
+	bool written = has_suffix(output, ".json") ? write_save_json(output, state) : write_save_binary(output, state);
+	if (!written) {
+		return EXIT_FAILURE;
+	}
+	printf("Converted %s to %s: %d enemies, %d cysts, %d chests\n", input.c_str(), output.c_str(),
+		(int)state.enemies.size(), (int)state.cysts.size(), (int)state.chests.size());
+	return EXIT_SUCCESS;
+}
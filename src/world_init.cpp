@@ -2,6 +2,7 @@
 #include "world_init.hpp"
 #include "components.hpp"
 #include "tiny_ecs_registry.hpp"
+#include "prefabs.hpp"
 
 // stlib
 #include <vector>
@@ -9,9 +10,9 @@
 #include <algorithm>
 #include <iostream>
 
-Entity createPlayer(vec2 pos)
+Entity createPlayer(ECSRegistry& registry, vec2 pos)
 {
-	auto entity = Entity();
+	auto entity = registry.create_entity();
 
 	// Setting initial bullet_transform values
 	Transform& transform = registry.transforms.emplace(entity);
@@ -25,7 +26,7 @@ Entity createPlayer(vec2 pos)
 	// Create an (empty) Player component to be able to refer to all players
 	Player& playerComp = registry.players.emplace(entity);
 
-	createGun(entity);
+	createGun(registry, entity);
 
 	registry.collideEnemies.emplace(entity);
 	registry.renderRequests.insert(
@@ -47,13 +48,12 @@ Entity createPlayer(vec2 pos)
 	return entity;
 }
 
-Entity createDashing(Entity dasher) {
+Entity createDashing(ECSRegistry& registry, Entity dasher) {
 	if (!registry.dashes.has(dasher)) {
 		registry.dashes.emplace(dasher);
 	}
-	Entity dash_entity = Entity();
-	Attachment& attachment = registry.attachments.emplace(dash_entity);
-	attachment.parent = dasher;
+	Entity dash_entity = registry.create_entity();
+	Attachment& attachment = registry.attachments.attach(dash_entity, dasher);
 	attachment.relative_transform_2.scale(DASHING_TEXTURE_SIZE / vec2(8, 1));
 	attachment.type = ATTACHMENT_ID::DASHING;
 
@@ -76,7 +76,7 @@ Entity createDashing(Entity dasher) {
 }
 
 
-Entity createGun(Entity holder) {
+Entity createGun(ECSRegistry& registry, Entity holder) {
 	Gun& gun_component = registry.guns.emplace(holder);
 	gun_component.angle_offset = IMMUNITY_TEXTURE_ANGLE;
 	gun_component.offset = { 40.f, 50.f };
@@ -84,10 +84,9 @@ Entity createGun(Entity holder) {
 	gun_component.bullet_size = { 15.f, 15.f };
 	gun_component.damage = 10.f;
 
-	Entity gun_entity = Entity();
-	Attachment& attachment = registry.attachments.emplace(gun_entity);
+	Entity gun_entity = registry.create_entity();
+	Attachment& attachment = registry.attachments.attach(gun_entity, holder);
 	attachment.type = ATTACHMENT_ID::GUN;
-	attachment.parent = holder;
 	attachment.relative_transform_1.translate({ 40.f, -15.f });
 	attachment.relative_transform_1.rotate(IMMUNITY_TEXTURE_ANGLE + M_PI / 2);
 	attachment.relative_transform_2.scale(GUN_TEXTURE_SIZE * vec2(0.5f, 1.f));
@@ -107,19 +106,18 @@ Entity createGun(Entity holder) {
 	return gun_entity;
 }
 
-Entity createSword(RenderSystem* renderer, Entity& holder) {
+Entity createSword(ECSRegistry& registry, RenderSystem* renderer, Entity& holder) {
 	if (!registry.melees.has(holder)) {
 		registry.melees.emplace(holder);
 	}
-	Entity melee_entity = Entity();
+	Entity melee_entity = registry.create_entity();
 	registry.melees.get(holder).melee_entity = melee_entity;
 	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SWORD);
 	registry.meshPtrs.emplace(melee_entity, &mesh);
 
 	registry.collideEnemies.emplace(melee_entity);
 	
-	Attachment& attachment = registry.attachments.emplace(melee_entity);
-	attachment.parent = holder;
+	Attachment& attachment = registry.attachments.attach(melee_entity, holder);
 	attachment.type = ATTACHMENT_ID::SWORD;
 	attachment.angle_freedom = M_PI / 2.f;
 
@@ -146,10 +144,10 @@ Entity createSword(RenderSystem* renderer, Entity& holder) {
 
 }
 
-Entity createBoss(RenderSystem* renderer, vec2 pos, float health) {
+Entity createBoss(ECSRegistry& registry, RenderSystem* renderer, vec2 pos, float health) {
 	// Create boss components
 	GameMode& gameMode = registry.gameMode.components.back();
-	auto entity = Entity();
+	auto entity = registry.create_entity();
 	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::BACTERIOPHAGE);
 	registry.meshPtrs.emplace(entity, &mesh);
 
@@ -172,9 +170,9 @@ Entity createBoss(RenderSystem* renderer, vec2 pos, float health) {
 	enemyHealth.maxHealth = gameMode.enemy_health_map[ENEMY_ID::BOSS];
 
 	// Setting initial components values
-	Enemy& new_enemy = registry.enemies.emplace(entity);
-	new_enemy.type = ENEMY_ID::BOSS;
-	registry.bosses.emplace(entity);
+	registry.enemies.insert(entity, { ENEMY_ID::BOSS });
+	Boss& boss = registry.bosses.emplace(entity);
+	boss.type = BOSS_ID::BACTERIOPHAGE;
 
 	Gun& weapon = registry.guns.emplace(entity);
 	weapon.damage = 15.f;
@@ -193,12 +191,12 @@ Entity createBoss(RenderSystem* renderer, vec2 pos, float health) {
 		  GEOMETRY_BUFFER_ID::SPRITE,
 		  RENDER_ORDER::BOSS });
 
-	createBossArms(renderer, entity, transform.scale);
+	createBossArms(registry, renderer, entity, transform.scale);
 	std::cout << "Creating boss at position: " << pos.x << ", " << pos.y << std::endl;
 	return entity;
 }
 
-void createBossArms(RenderSystem* renderer, Entity bossEntity, vec2 bossSize) {
+void createBossArms(ECSRegistry& registry, RenderSystem* renderer, Entity bossEntity, vec2 bossSize) {
 	// Create boss arm parts
 	// Odd arms are on one side and even arms on the other.
 	uint arms_count = 6;
@@ -212,13 +210,12 @@ void createBossArms(RenderSystem* renderer, Entity bossEntity, vec2 bossSize) {
 		for (uint arm_part_idx = 0; arm_part_idx < arm_parts_count; arm_part_idx++) {
 			uint arm_pair_idx = (uint)(arm_idx / 2);
 
-			auto entity = Entity();
+			auto entity = registry.create_entity();
 			Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::BACTERIOPHAGE_ARM);
 			registry.meshPtrs.emplace(entity, &mesh);
 
-			Attachment& articulated = registry.attachments.emplace(entity);
+			Attachment& articulated = registry.attachments.attach(entity, parent_entity);
 			articulated.type = ATTACHMENT_ID::BACTERIOPHAGE_ARM;
-			articulated.parent = parent_entity;
 			articulated.angle_freedom = M_PI / 12.f + M_PI / 12.f * (arm_part_idx + 1);
 
 			// Calculate and store the relative position of joint (pivot) with respect to its parent
@@ -278,25 +275,25 @@ void createBossArms(RenderSystem* renderer, Entity bossEntity, vec2 bossSize) {
 	}
 }
 
-Entity createSecondBoss(RenderSystem* renderer, vec2 pos, float health) {
+Entity createSecondBoss(ECSRegistry& registry, RenderSystem* renderer, vec2 pos, float health) {
 	// Create boss components
-	auto boss_entity = Entity();
+	auto boss_entity = registry.create_entity();
 	// Assuming boss is a type of enemy
 	Dash& enemy_dash = registry.dashes.emplace(boss_entity);
 	enemy_dash.delay_duration_ms = PLAYER_DASH_DELAY / registry.gameMode.components.back().FRIEND_BOSS_DIFFICULTY * 2.f;
 	enemy_dash.active_duration_ms = 50.f;
 
-	Enemy& new_enemy = registry.enemies.emplace(boss_entity);
-	// Setting initial components values
-	new_enemy.type = ENEMY_ID::FRIENDBOSS;
-	registry.bosses.emplace(boss_entity);
-
 	Transform& transform = registry.transforms.emplace(boss_entity);
 	transform.position = pos;
 	transform.angle_offset = IMMUNITY_TEXTURE_ANGLE;
 	transform.angle = transform.angle_offset;
 	transform.scale = FRIEND_BOSS_SIZE;
 
+	// Setting initial components values, after the transform so the population index sees the region
+	registry.enemies.insert(boss_entity, { ENEMY_ID::FRIENDBOSS });
+	Boss& boss = registry.bosses.emplace(boss_entity);
+	boss.type = BOSS_ID::FRIEND;
+
 	Motion& motion = registry.motions.emplace(boss_entity);
 
 	motion.max_velocity = 350.f;
@@ -327,142 +324,30 @@ Entity createSecondBoss(RenderSystem* renderer, vec2 pos, float health) {
 	return boss_entity;
 }
 
-Entity createBossClone(vec2 pos, float health) {
-	// Create boss components
-	auto entity = Entity();
-	// Assuming boss is a type of enemy
-	registry.collidePlayers.emplace(entity);
-
-	Enemy& new_enemy = registry.enemies.emplace(entity);
-	// Setting initial components values
-	new_enemy.type = ENEMY_ID::FRIENDBOSSCLONE;
-
-	Transform& transform = registry.transforms.emplace(entity);
-	transform.position = pos;
-	transform.angle_offset = IMMUNITY_TEXTURE_ANGLE;
-	transform.angle = transform.angle_offset;
-	transform.scale = FRIEND_BOSS_SIZE;
-
-	Motion& motion = registry.motions.emplace(entity);
-
-	motion.max_velocity = 300.f; // TODO: Dummy boss for now, change this later
-
-	Health& enemyHealth = registry.healthValues.emplace(entity);
-	enemyHealth.health = registry.gameMode.components.back().enemy_health_map[ENEMY_ID::FRIENDBOSSCLONE];
-
-
-	// Add to render_request
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::FRIEND,
-		  EFFECT_ASSET_ID::TEXTURED,
-		  GEOMETRY_BUFFER_ID::SPRITE,
-		  RENDER_ORDER::BOSS });
-	return entity;
+Entity createBossClone(ECSRegistry& registry, vec2 pos, float health) {
+	// Components come from data/prefabs/enemies.json
+	return spawnPrefab(registry, registry.prefabs.get(ENEMY_ID::FRIENDBOSSCLONE), 1, &pos).front();
 }
 
 
-Entity createRedEnemy(vec2 pos, float health) {
-	
-	// Create enemy components
-	auto entity = Entity();
-	Enemy& new_enemy = registry.enemies.emplace(entity);
-	new_enemy.type = ENEMY_ID::RED;
-	registry.collidePlayers.emplace(entity);
-
-	Transform& transform = registry.transforms.emplace(entity);
-	transform.position = pos;
-	transform.angle_offset = M_PI / 2;
-	transform.angle = transform.angle_offset;
-	transform.scale = RED_ENEMY_SIZE;
-
-	Motion& motion = registry.motions.emplace(entity);
-	motion.max_velocity = 400;
-	Health& enemyHealth = registry.healthValues.emplace(entity);
-	enemyHealth.health = registry.gameMode.components.back().enemy_health_map[ENEMY_ID::RED];
-
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::RED_ENEMY,
-			EFFECT_ASSET_ID::TEXTURED,
-			GEOMETRY_BUFFER_ID::SPRITE,
-			RENDER_ORDER::ENEMIES_BK });
-
-	return entity;
+Entity createRedEnemy(ECSRegistry& registry, vec2 pos, float health) {
+	// Components come from data/prefabs/enemies.json
+	return spawnPrefab(registry, registry.prefabs.get(ENEMY_ID::RED), 1, &pos).front();
 }
 
-Entity createGreenEnemy(vec2 pos, float health) {
-	
-	// Create enemy components
-	auto entity = Entity();
-	Enemy& new_enemy = registry.enemies.emplace(entity);
-	new_enemy.type = ENEMY_ID::GREEN;
-	registry.collidePlayers.emplace(entity);
-
-	Transform& transform = registry.transforms.emplace(entity);
-	transform.position = pos;
-	transform.scale = GREEN_ENEMY_SIZE;
-	transform.angle_offset = 3 * M_PI / 4;
-	transform.angle = transform.angle_offset;
-
-	Motion& motion = registry.motions.emplace(entity);
-	motion.max_velocity = 200;
-	Health& enemyHealth = registry.healthValues.emplace(entity);
-	enemyHealth.health = registry.gameMode.components.back().enemy_health_map[ENEMY_ID::GREEN];;
-
-	// Add to render_request
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::GREEN_ENEMY_MOVING,
-			EFFECT_ASSET_ID::TEXTURED,
-			GEOMETRY_BUFFER_ID::SPRITESHEET_GREEN_ENEMY_MOVING,
-			RENDER_ORDER::ENEMIES_BK });
-
-	Animation& animation = registry.animations.emplace(entity);
-	animation.update_period_ms *= 2;
-	animation.total_frame = (int)ANIMATION_FRAME_COUNT::GREEN_ENEMY_MOVING;
-	animation.pause_animation = true;
-	return entity;
+Entity createGreenEnemy(ECSRegistry& registry, vec2 pos, float health) {
+	// Components come from data/prefabs/enemies.json
+	return spawnPrefab(registry, registry.prefabs.get(ENEMY_ID::GREEN), 1, &pos).front();
 }
 
 
-Entity createYellowEnemy(vec2 pos, float health) {
-	// Create enemy components
-	auto entity = Entity();
-	Enemy& new_enemy = registry.enemies.emplace(entity);
-	new_enemy.type = ENEMY_ID::YELLOW;
-	registry.collidePlayers.emplace(entity);
-
-	Gun& weapon = registry.guns.emplace(entity);
-	weapon.attack_delay = 900.f;
-	weapon.bullet_speed = 400.f;
-	weapon.bullet_size = { 25.f, 25.f };
-	weapon.bullet_color = { 0.718f, 1.f, 0.f, 1.f };
-
-	Transform& transform = registry.transforms.emplace(entity);
-	transform.position = pos;
-	transform.scale = YELLOW_ENEMY_SIZE;
-
-	Motion& motion = registry.motions.emplace(entity);
-	motion.max_velocity = 0.0f;
-	motion.max_angular_velocity = M_PI;
-
-	Health& enemyHealth = registry.healthValues.emplace(entity);
-	enemyHealth.health = registry.gameMode.components.back().enemy_health_map[ENEMY_ID::YELLOW];;
-
-	// Add tp render_request
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::YELLOW_ENEMY,
-			EFFECT_ASSET_ID::TEXTURED,
-			GEOMETRY_BUFFER_ID::SPRITE,
-			RENDER_ORDER::ENEMIES_BK });
-	return entity;
+Entity createYellowEnemy(ECSRegistry& registry, vec2 pos, float health) {
+	// Components come from data/prefabs/enemies.json
+	return spawnPrefab(registry, registry.prefabs.get(ENEMY_ID::YELLOW), 1, &pos).front();
 }
 
-Entity createChest(vec2 pos, REGION_GOAL_ID ability) {
-    auto entity = Entity();
+Entity createChest(ECSRegistry& registry, vec2 pos, REGION_GOAL_ID ability) {
+    auto entity = registry.create_entity();
 	registry.collidePlayers.emplace(entity);
 
     // Set up the transform for the chest
@@ -497,8 +382,8 @@ Entity createChest(vec2 pos, REGION_GOAL_ID ability) {
     return entity;
 }
 
-Entity createCure(vec2 pos) {
-	auto entity = Entity();
+Entity createCure(ECSRegistry& registry, vec2 pos) {
+	auto entity = registry.create_entity();
 	registry.collidePlayers.emplace(entity);
 
 	Transform& transform = registry.transforms.emplace(entity);
@@ -528,7 +413,7 @@ Entity createCure(vec2 pos) {
 	return entity;
 }
 
-void createRandomRegions(size_t num_regions, std::default_random_engine& rng) {
+void createRandomRegions(ECSRegistry& registry, size_t num_regions, RandomStream& rng) {
 	assert(region_theme_count >= num_regions);
 	assert(region_goal_count >= num_regions);
 
@@ -551,7 +436,7 @@ void createRandomRegions(size_t num_regions, std::default_random_engine& rng) {
 	float angle = 0.f;
 
 	for (int i = 0; i < num_regions; i++) {
-		auto entity = Entity();
+		auto entity = registry.create_entity();
 		Region& region = registry.regions.emplace(entity);
 
 		// Set region unique theme
@@ -604,7 +489,7 @@ void createRandomRegions(size_t num_regions, std::default_random_engine& rng) {
 	}
 }
 
-void createRandomCysts(std::default_random_engine& rng) {
+void createRandomCysts(ECSRegistry& registry, RandomStream& rng) {
 	const float ANGLE = (M_PI * 2 / NUM_REGIONS);
 	const int TOTAL_CYSTS = 132; 
 	const float MAX_CLOSENESS = SCREEN_RADIUS / 2;
@@ -644,14 +529,14 @@ void createRandomCysts(std::default_random_engine& rng) {
 			}
 
 			// finally create cyst
-			createCyst(pos);
+			createCyst(registry, pos);
 			positions.push_back(pos);
 		}
 	}
 }
 
-void createCyst(vec2 pos, float health) {
-	auto cyst_entity = Entity();
+void createCyst(ECSRegistry& registry, vec2 pos, float health) {
+	auto cyst_entity = registry.create_entity();
 	registry.cysts.emplace(cyst_entity);
 	registry.healthValues.insert(cyst_entity, {health});
 	registry.collidePlayers.emplace(cyst_entity);
@@ -681,8 +566,8 @@ void createCyst(vec2 pos, float health) {
 			RENDER_ORDER::ENEMIES_BK });
 }
 
-Entity createLine(vec2 position, float angle, vec2 scale) {
-	Entity entity = Entity();
+Entity createLine(ECSRegistry& registry, vec2 position, float angle, vec2 scale) {
+	Entity entity = registry.create_entity();
 
 	registry.renderRequests.insert(
 		entity,
@@ -704,8 +589,8 @@ Entity createLine(vec2 position, float angle, vec2 scale) {
 	return entity;
 }
 
-Entity createHoldGuide(vec2 position, vec2 scale) {
-	Entity entity = Entity();
+Entity createHoldGuide(ECSRegistry& registry, vec2 position, vec2 scale) {
+	Entity entity = registry.create_entity();
 
 	registry.renderRequests.insert(
 		entity,
@@ -724,9 +609,9 @@ Entity createHoldGuide(vec2 position, vec2 scale) {
 	return entity;
 }
 
-std::tuple<Entity, Entity> createHealthbar(vec2 position, vec2 scale) {
-	Entity bar = Entity();
-	Entity frame = Entity();
+std::tuple<Entity, Entity> createHealthbar(ECSRegistry& registry, vec2 position, vec2 scale) {
+	Entity bar = registry.create_entity();
+	Entity frame = registry.create_entity();
 
 	Healthbar& healthbar = registry.healthbar.emplace(bar);
 	healthbar.full_health_color = { 0.f,1.f,0.f,1.f };
@@ -758,9 +643,9 @@ std::tuple<Entity, Entity> createHealthbar(vec2 position, vec2 scale) {
 	return std::make_tuple(bar, frame);
 }
 
-std::tuple<Entity, Entity> createBossHealthbar(vec2 position, vec2 scale) {
-	Entity bar = Entity();
-	Entity frame = Entity();
+std::tuple<Entity, Entity> createBossHealthbar(ECSRegistry& registry, vec2 position, vec2 scale) {
+	Entity bar = registry.create_entity();
+	Entity frame = registry.create_entity();
 
 	Healthbar& healthbar = registry.healthbar.emplace(bar);
 	healthbar.full_health_color = { 1.f,0.f,0.f,0.f };
@@ -793,105 +678,107 @@ std::tuple<Entity, Entity> createBossHealthbar(vec2 position, vec2 scale) {
 	return std::make_tuple(bar, frame);
 }
 
-void createBullet(Entity shooter, vec2 scale, vec4 color) {
+void createBullet(ECSRegistry& registry, Entity shooter, vec2 scale, vec4 color) {
+	BulletPattern pattern;
 	if (registry.lotsOfBullets.has(shooter)) {
-		// not efficient but haven't noticed any performance issues
-		createBulletHelper(shooter, scale, color, -M_PI / 5);
-		createBulletHelper(shooter, scale, color, -2 * M_PI / 5);
-		createBulletHelper(shooter, scale, color, -3 * M_PI / 5);
-		createBulletHelper(shooter, scale, color, -4 * M_PI / 5);
-		createBulletHelper(shooter, scale, color, M_PI / 5);
-		createBulletHelper(shooter, scale, color, 2 * M_PI / 5);
-		createBulletHelper(shooter, scale, color, 3 * M_PI / 5);
-		createBulletHelper(shooter, scale, color, 4 * M_PI / 5);
-		createBulletHelper(shooter, scale, color, 0.f);
-		createBulletHelper(shooter, scale, color, M_PI);
+		pattern.type = BULLET_PATTERN_ID::RING;
+		pattern.count = 10;
 	} else if (registry.tripleBullets.has(shooter)) {
-		createBulletHelper(shooter, scale*0.8f, color, -0.21f);
-		createBulletHelper(shooter, scale, color, 0.f);
-		createBulletHelper(shooter, scale*0.8f, color, 0.21f);
-	}
-	else {
-		createBulletHelper(shooter, scale, color, 0.f);
+		pattern.type = BULLET_PATTERN_ID::FAN;
+		pattern.count = 3;
+		pattern.spread = 0.42f;
+		pattern.size_curve = { 1.f, 0.8f };
 	}
+	createBulletPattern(registry, shooter, pattern, scale, color);
 }
 
 // Can be used for either player or enemy
-void createBulletHelper(Entity shooter, vec2 scale, vec4 color, float angle_offset) {
+void createBulletPattern(ECSRegistry& registry, Entity shooter, const BulletPattern& pattern, vec2 scale, vec4 color) {
 	assert(registry.transforms.has(shooter));
-	// Create bullet's components
-	auto bullet_entity = Entity();
-
-	Transform& bullet_transform = registry.transforms.emplace(bullet_entity);
-	Motion& bullet_motion = registry.motions.emplace(bullet_entity);
-	registry.colors.insert(bullet_entity, color);
+	assert(pattern.count > 0);
+	assert((pattern.type != BULLET_PATTERN_ID::BURST || pattern.count == 1 || pattern.speed_curve.x != pattern.speed_curve.y) && "Bullets of the burst would stack");
 
-	// Set initial position and velocity
+	// Everything that only depends on the shooter is computed once for the whole pattern
 	Transform& shooter_transform = registry.transforms.get(shooter);
 	Gun& weapon = registry.guns.get(shooter);
+	Motion shooter_motion = registry.motions.get(shooter);
 
 	Transformation t;
 	t.translate(shooter_transform.position);
 	t.rotate(shooter_transform.angle + shooter_transform.angle_offset);
 	t.translate(weapon.offset);
 	//t.rotate(weapon.angle_offset);
-
-	bullet_transform.position = t.mat[2];
-	bullet_transform.scale = scale;
-	bullet_transform.angle = 0.f;
-
-	Motion shooter_motion = registry.motions.get(shooter);
-
-	if (registry.enemies.has(shooter)) {
-		bullet_motion.velocity = { cos(shooter_transform.angle - weapon.angle_offset) * weapon.bullet_speed, 
-			sin(shooter_transform.angle - weapon.angle_offset) * weapon.bullet_speed};
-	}
-	else {
-		vec2 bullet_direction = normalize(vec2(cos(shooter_transform.angle + angle_offset - weapon.angle_offset), sin(shooter_transform.angle + angle_offset - weapon.angle_offset)));
-
-		float projection = dot(shooter_motion.velocity, bullet_direction);
-		// add players sideways velocity
-		vec2 shooter_velocity = shooter_motion.velocity - bullet_direction * projection;
-		// add half of players forward/backward velocity
-		//shooter_velocity += bullet_direction * projection * 0.5f;
-
-		// scale to length of max_velocity (ie when dashing)
-		if (length(shooter_velocity) > shooter_motion.max_velocity) {
-			float h = hypot(shooter_velocity.x, shooter_velocity.y);
-			shooter_velocity.x = shooter_motion.max_velocity * shooter_velocity.x / h;
-			shooter_velocity.y = shooter_motion.max_velocity * shooter_velocity.y / h;
+	vec2 muzzle_position = t.mat[2];
+
+	float aim_angle = shooter_transform.angle - weapon.angle_offset + pattern.angle_offset;
+	// Only the player's bullets inherit the shooter's velocity
+	bool inherit_velocity = !registry.enemies.has(shooter);
+	bool collide_enemies = registry.collideEnemies.has(shooter);
+	bool collide_players = registry.collidePlayers.has(shooter);
+	float damage = weapon.damage;
+	float bullet_speed = weapon.bullet_speed;
+
+	// First pass: compute the state of every bullet
+	uint count = pattern.count;
+	std::vector<vec2> velocities(count);
+	std::vector<vec2> scales(count);
+	for (uint i = 0; i < count; i++) {
+		float t_index = count > 1 ? (float)i / (count - 1) : 0.f;
+		float angle = 0.f;
+		float curve_t = t_index;
+		switch (pattern.type) {
+		case BULLET_PATTERN_ID::FAN:
+			angle = count > 1 ? (t_index - 0.5f) * pattern.spread : 0.f;
+			curve_t = fabs(2.f * t_index - 1.f);
+			break;
+		case BULLET_PATTERN_ID::RING:
+			angle = 2.f * M_PI * i / count;
+			break;
+		case BULLET_PATTERN_ID::SPIRAL:
+			angle = pattern.spread * i;
+			break;
+		default:
+			break;
 		}
-
-		bullet_motion.velocity = bullet_direction * weapon.bullet_speed + shooter_velocity;
+		float speed_multiplier = mix(pattern.speed_curve.x, pattern.speed_curve.y, curve_t);
+		float size_multiplier = mix(pattern.size_curve.x, pattern.size_curve.y, curve_t);
+
+		vec2 bullet_direction = vec2(cos(aim_angle + angle), sin(aim_angle + angle));
+		vec2 velocity = bullet_direction * bullet_speed * speed_multiplier;
+		if (inherit_velocity) {
+			float projection = dot(shooter_motion.velocity, bullet_direction);
+			// add players sideways velocity
+			vec2 shooter_velocity = shooter_motion.velocity - bullet_direction * projection;
+
+			// scale to length of max_velocity (ie when dashing)
+			if (length(shooter_velocity) > shooter_motion.max_velocity) {
+				float h = hypot(shooter_velocity.x, shooter_velocity.y);
+				shooter_velocity.x = shooter_motion.max_velocity * shooter_velocity.x / h;
+				shooter_velocity.y = shooter_motion.max_velocity * shooter_velocity.y / h;
+			}
+			velocity += shooter_velocity;
+		}
+		velocities[i] = velocity;
+		scales[i] = scale * size_multiplier;
 	}
 
-	// Set projectile damage based on weapon
-	registry.projectiles.insert(bullet_entity, { weapon.damage });
-
-	if (registry.collideEnemies.has(shooter)) {
-		registry.collideEnemies.emplace(bullet_entity);
-	}
-	if (registry.collidePlayers.has(shooter)) {
-		registry.collidePlayers.emplace(bullet_entity);
+	// Second pass: append the batch to the projectile pool, growing it once
+	uint8_t team = (collide_enemies ? PROJECTILE_HITS_ENEMIES : 0) | (collide_players ? PROJECTILE_HITS_PLAYERS : 0);
+	registry.projectiles.reserve_additional(count);
+	for (uint i = 0; i < count; i++) {
+		float radius = max(scales[i].x, scales[i].y) / 2.f;
+		registry.projectiles.spawn(muzzle_position, velocities[i], radius, damage, color, team);
 	}
-
-	// Add bullet to render request
-	registry.renderRequests.insert(
-		bullet_entity,
-		{ TEXTURE_ASSET_ID::TEXTURE_COUNT, // TEXTURE_COUNT indicates that no txture is needed
-			EFFECT_ASSET_ID::COLOURED,
-			GEOMETRY_BUFFER_ID::BULLET,
-			RENDER_ORDER::OBJECTS });
 }
 
-Entity createCamera(vec2 pos) {
-	Entity camera = Entity();
+Entity createCamera(ECSRegistry& registry, vec2 pos) {
+	Entity camera = registry.create_entity();
 	registry.camera.insert(camera, { pos });
 	return camera;
 }
 
-Entity createCrosshair() {
-	Entity entity = Entity();
+Entity createCrosshair(ECSRegistry& registry) {
+	Entity entity = registry.create_entity();
 
 	registry.transforms.insert(entity, { vec2(0.f,0.f), vec2(20.f,20.f), 0.f, true});
 
@@ -906,10 +793,10 @@ Entity createCrosshair() {
 	return entity;
 }
 
-void createWaypoint(REGION_GOAL_ID goal, Entity target) {
+void createWaypoint(ECSRegistry& registry, REGION_GOAL_ID goal, Entity target) {
 	assert(registry.transforms.has(target));
 	
-	Entity entity = Entity();
+	Entity entity = registry.create_entity();
 	Waypoint& waypoint = registry.waypoints.emplace(entity);
 	waypoint.target = target;
 	waypoint.goal = goal;
@@ -934,8 +821,8 @@ void createWaypoint(REGION_GOAL_ID goal, Entity target) {
 	registry.colors.insert(entity, { 1.f,1.f,1.f,0.f });
 }
 
-Entity createDeathScreen(int scenario) {
-	Entity entity = Entity();
+Entity createDeathScreen(ECSRegistry& registry, int scenario) {
+	Entity entity = registry.create_entity();
 
 	Transform& transform = registry.transforms.emplace(entity);
 	transform.scale = { DIALOG_TEXTURE_SIZE.x, DIALOG_TEXTURE_SIZE.y };
@@ -953,9 +840,9 @@ Entity createDeathScreen(int scenario) {
 	return entity;
 }
 
-Entity createCredits() {
+Entity createCredits(ECSRegistry& registry) {
 	// Background texture
-	Entity black_screen = Entity();
+	Entity black_screen = registry.create_entity();
 
 	registry.renderRequests.insert(
 		black_screen,
@@ -970,7 +857,7 @@ Entity createCredits() {
 	registry.colors.insert(black_screen, { 0.f,0.f,0.f,1.f, });
 
 	// Credits texture
-	Entity entity = Entity();
+	Entity entity = registry.create_entity();
 
 	Credits& credits = registry.credits.emplace(entity);
 	Transform& transform = registry.transforms.emplace(entity);
@@ -986,7 +873,7 @@ Entity createCredits() {
 			RENDER_ORDER::CREDITS });
 
 	// Title texture
-	Entity title = Entity();
+	Entity title = registry.create_entity();
 
 	Transform& title_transform = registry.transforms.emplace(title);
 	title_transform.position.y = -DIALOG_TEXTURE_SIZE.y;
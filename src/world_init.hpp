@@ -2,6 +2,8 @@
 
 #include "common.hpp"
 #include "tiny_ecs.hpp"
+#include "tiny_ecs_registry.hpp"
+#include "random_service.hpp"
 #include "render_system.hpp"
 
 #include <random>
@@ -43,42 +45,67 @@ const vec2 CURE_SIZE = CURE_TEXTURE_SIZE * 2.0f;
 const vec2 BACTERIOPHAGE_BOSS_SIZE = BACTERIOPHAGE_TEXTURE_SIZE * 0.7f;
 const vec2 FRIEND_BOSS_SIZE = FRIEND_TEXTURE_SIZE * 3.f;
 
+// Bullet patterns, all angles are relative to where the shooter's gun points
+enum class BULLET_PATTERN_ID {
+	SINGLE = 0,
+	FAN = SINGLE + 1,		// count bullets evenly over an arc of 'spread' radians
+	RING = FAN + 1,			// count bullets evenly over a full circle
+	SPIRAL = RING + 1,		// count bullets, each turned 'spread' radians further than the previous
+	BURST = SPIRAL + 1,		// count bullets in the same direction, separated by the speed curve
+	BULLET_PATTERN_COUNT = BURST + 1
+};
+
+struct BulletPattern {
+	BULLET_PATTERN_ID type = BULLET_PATTERN_ID::SINGLE;
+	uint count = 1;
+	float spread = 0.f;
+	float angle_offset = 0.f;		// Rotates the whole pattern
+	// Per-bullet multipliers of the gun's speed and of the bullet size. For FAN they go from the
+	// centre bullet (x) to the outermost bullets (y), otherwise from the first (x) to the last bullet (y).
+	vec2 speed_curve = { 1.f, 1.f };
+	vec2 size_curve = { 1.f, 1.f };
+};
+// Speed curve of bursts that don't set one, the last bullet trails the first
+const vec2 BURST_SPEED_CURVE = { 1.f, 0.6f };
+
 /*************************[ characters ]*************************/
 // the player
-Entity createPlayer(vec2 pos);
-Entity createDashing(Entity dasher);
-Entity createSword(RenderSystem* renderer, Entity& playerEntity);
-Entity createCure(vec2 pos);
-Entity createGun(Entity holder);
+Entity createPlayer(ECSRegistry& registry, vec2 pos);
+Entity createDashing(ECSRegistry& registry, Entity dasher);
+Entity createSword(ECSRegistry& registry, RenderSystem* renderer, Entity& playerEntity);
+Entity createCure(ECSRegistry& registry, vec2 pos);
+Entity createGun(ECSRegistry& registry, Entity holder);
 // enemies
-Entity createRedEnemy(vec2 pos, float health = 40.0f);
-Entity createGreenEnemy(vec2 pos, float health = 150.0f);
-Entity createYellowEnemy(vec2 pos, float health = 50.0f);
-Entity createBossClone(vec2 pos, float health = 10.0f);
-Entity createBoss(RenderSystem* renderer, vec2 pos, float health = INFINITY);
-void createBossArms(RenderSystem* renderer, Entity bossEntity, vec2 bossSize);
-Entity createSecondBoss(RenderSystem* renderer, vec2 pos, float health = INFINITY);
+Entity createRedEnemy(ECSRegistry& registry, vec2 pos, float health = 40.0f);
+Entity createGreenEnemy(ECSRegistry& registry, vec2 pos, float health = 150.0f);
+Entity createYellowEnemy(ECSRegistry& registry, vec2 pos, float health = 50.0f);
+Entity createBossClone(ECSRegistry& registry, vec2 pos, float health = 10.0f);
+Entity createBoss(ECSRegistry& registry, RenderSystem* renderer, vec2 pos, float health = INFINITY);
+void createBossArms(ECSRegistry& registry, RenderSystem* renderer, Entity bossEntity, vec2 bossSize);
+Entity createSecondBoss(ECSRegistry& registry, RenderSystem* renderer, vec2 pos, float health = INFINITY);
 
 /*************************[ environment ]*************************/
 // the random regions
-void createRandomRegions(size_t num_regions, std::default_random_engine& rng);
-void createRandomCysts(std::default_random_engine& rng);
-void createCyst(vec2 pos, float health = 50.0f);
-Entity createChest(vec2 pos, REGION_GOAL_ID ability);
-void createBullet(Entity shooter, vec2 scale, vec4 color);
-void createBulletHelper(Entity shooter, vec2 scale, vec4 color, float angle_offset);
+void createRandomRegions(ECSRegistry& registry, size_t num_regions, RandomStream& rng);
+void createRandomCysts(ECSRegistry& registry, RandomStream& rng);
+void createCyst(ECSRegistry& registry, vec2 pos, float health = 50.0f);
+Entity createChest(ECSRegistry& registry, vec2 pos, REGION_GOAL_ID ability);
+// fires the shooter's gun, picking the pattern from its active buffs
+void createBullet(ECSRegistry& registry, Entity shooter, vec2 scale, vec4 color);
+// computes every bullet of the pattern in one pass and inserts them as a batch
+void createBulletPattern(ECSRegistry& registry, Entity shooter, const BulletPattern& pattern, vec2 scale, vec4 color);
 
 /*************************[ UI ]*************************/
 // a red line for debugging purposes
-Entity createLine(vec2 position, float angle, vec2 scale);
+Entity createLine(ECSRegistry& registry, vec2 position, float angle, vec2 scale);
 // create healthbar and its frame. Returns healthbar entity
-std::tuple<Entity, Entity> createHealthbar(vec2 position, vec2 scale);
-std::tuple<Entity, Entity> createBossHealthbar(vec2 position, vec2 scale);
-Entity createCrosshair();
-void createWaypoint(REGION_GOAL_ID goal, Entity target);
-Entity createDeathScreen(int scenario);
-Entity createCredits();
-Entity createHoldGuide(vec2 position, vec2 scale);
+std::tuple<Entity, Entity> createHealthbar(ECSRegistry& registry, vec2 position, vec2 scale);
+std::tuple<Entity, Entity> createBossHealthbar(ECSRegistry& registry, vec2 position, vec2 scale);
+Entity createCrosshair(ECSRegistry& registry);
+void createWaypoint(ECSRegistry& registry, REGION_GOAL_ID goal, Entity target);
+Entity createDeathScreen(ECSRegistry& registry, int scenario);
+Entity createCredits(ECSRegistry& registry);
+Entity createHoldGuide(ECSRegistry& registry, vec2 position, vec2 scale);
 
 /*************************[ other ]*************************/
-Entity createCamera(vec2 pos);
+Entity createCamera(ECSRegistry& registry, vec2 pos);
@@ -0,0 +1,490 @@
+// internal
+#include "world_serializer.hpp"
+#include "component_reflection.hpp"
+
+// stlib
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+
+// The record a component is saved as, mesh pointers become MeshRef
+template <typename Component>
+struct SavedAs {
+	typedef Component type;
+	static const Component& save(const Component& component, const Mesh*) { return component; }
+	static bool load(const Component& saved, Mesh*, Component& component) {
+		component = saved;
+		return true;
+	}
+};
+
+template <>
+struct SavedAs<Mesh*> {
+	typedef MeshRef type;
+	static MeshRef save(const Mesh* mesh, const Mesh* meshes) {
+		MeshRef ref;
+		for (int i = 0; meshes && i < geometry_count; i++) {
+			if (mesh == meshes + i) ref.geometry = i;
+		}
+		return ref;
+	}
+	static bool load(const MeshRef& ref, Mesh* meshes, Mesh*& mesh) {
+		if (!meshes || ref.geometry < 0 || ref.geometry >= geometry_count) return false;
+		mesh = meshes + ref.geometry;
+		return true;
+	}
+};
+
+// Records that index fixed size tables, checked before anything of a save is restored
+template <typename Record>
+struct SavedRange {
+	static const bool checked = false;
+	static bool valid(const Record&) { return true; }
+};
+
+// PopulationIndex counts enemies by type and region
+template <>
+struct SavedRange<Enemy> {
+	static const bool checked = true;
+	static bool valid(const Enemy& enemy) {
+		return (int)enemy.type >= 0 && (int)enemy.type < enemy_type_count && enemy.region >= 0 && enemy.region < (int)NUM_REGIONS;
+	}
+};
+
+// Container type of a registry member, only used in decltype
+template <typename Container>
+Container container_of(Container ECSRegistry::*);
+
+template <typename Member>
+struct SavedRecord {
+	typedef decltype(container_of(std::declval<Member>())) Container;
+	typedef typename decltype(Container::components)::value_type Component;
+	typedef typename SavedAs<Component>::type type;
+};
+
+template <typename T>
+static void encode_record(std::vector<char>& data, const T& record, std::true_type) {
+	field_to_bytes(data, record);
+}
+
+template <typename T>
+static void encode_record(std::vector<char>& data, const T& record, std::false_type) {
+	BinaryFieldWriter writer{ data };
+	Reflection<T>::visit(record, writer);
+}
+
+template <typename T>
+static bool decode_record(const char*& in, const char* end, T& record, std::true_type) {
+	return field_from_bytes(in, end, record);
+}
+
+template <typename T>
+static bool decode_record(const char*& in, const char* end, T& record, std::false_type) {
+	BinaryFieldReader reader{ in, end };
+	Reflection<T>::visit(record, reader);
+	return reader.ok;
+}
+
+struct WorldBlock {
+	std::string name;
+	WORLD_ENCODING encoding;
+	uint32_t record_size;
+	uint32_t count;
+	uint32_t data_size;
+	const char* ids;
+	const char* data;
+
+	Entity entity(uint32_t i) const {
+		uint32_t id;
+		memcpy(&id, ids + (size_t)i * sizeof(id), sizeof(id));
+		return Entity(id);
+	}
+};
+
+template <typename T>
+static void append_value(std::vector<char>& blob, T value) {
+	const char* bytes = (const char*)&value;
+	blob.insert(blob.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static bool read_value(const char*& in, const char* end, T& value) {
+	return field_from_bytes(in, end, value);
+}
+
+template <typename T>
+static void append_record(WorldBlockData& block, const T& record) {
+	encode_record(block.data, record, std::is_trivially_copyable<T>());
+	block.count++;
+}
+
+template <typename T>
+static void append_json_record(WorldBlockData& block, const json& component) {
+	T record = T();
+	JsonFieldReader reader{ component };
+	Reflection<T>::visit(record, reader);
+	append_record(block, record);
+}
+
+template <typename T>
+static void append_block(std::vector<char>& blob, const WorldBlockData& block) {
+	typedef std::is_trivially_copyable<T> raw;
+	assert(block.entities.size() == block.count);
+	const char* name = Reflection<T>::name();
+	append_value(blob, (uint8_t)strlen(name));
+	blob.insert(blob.end(), name, name + strlen(name));
+	append_value(blob, (uint8_t)(raw::value ? WORLD_ENCODING::RAW : WORLD_ENCODING::FIELDS));
+	append_value(blob, (uint32_t)(raw::value ? sizeof(T) : 0));
+	append_value(blob, block.count);
+	append_value(blob, (uint32_t)block.data.size());
+	const char* id_bytes = (const char*)block.entities.data();
+	blob.insert(blob.end(), id_bytes, id_bytes + block.entities.size() * sizeof(uint32_t));
+	blob.insert(blob.end(), block.data.begin(), block.data.end());
+}
+
+// What the JSON reader needs of every type, in the order of for_each_world_container
+struct WorldType {
+	const char* name;
+	void (*append_json_record)(WorldBlockData& block, const json& component);
+	void (*append_block)(std::vector<char>& blob, const WorldBlockData& block);
+};
+
+static const std::vector<WorldType>& world_types() {
+	static const std::vector<WorldType> types = [] {
+		std::vector<WorldType> list;
+		for_each_world_container([&list](auto member) {
+			typedef typename SavedRecord<decltype(member)>::type Record;
+			list.push_back({ Reflection<Record>::name(), &append_json_record<Record>, &append_block<Record> });
+		});
+		return list;
+	}();
+	return types;
+}
+
+static int world_type_index(const std::string& name) {
+	const std::vector<WorldType>& types = world_types();
+	for (size_t i = 0; i < types.size(); i++) {
+		if (name == types[i].name) return (int)i;
+	}
+	return -1;
+}
+
+static bool parse_blocks(const std::vector<char>& blob, std::vector<WorldBlock>& blocks) {
+	const char* in = blob.data();
+	const char* end = blob.data() + blob.size();
+	uint32_t block_count;
+	if (!read_value(in, end, block_count)) return false;
+	blocks.resize(block_count);
+	for (WorldBlock& block : blocks) {
+		uint8_t name_length, encoding;
+		if (!read_value(in, end, name_length) || (size_t)(end - in) < name_length) return false;
+		block.name.assign(in, name_length);
+		in += name_length;
+		if (!read_value(in, end, encoding) || !read_value(in, end, block.record_size)
+			|| !read_value(in, end, block.count) || !read_value(in, end, block.data_size)) return false;
+		block.encoding = (WORLD_ENCODING)encoding;
+		if ((size_t)(end - in) / sizeof(uint32_t) < block.count) return false;
+		block.ids = in;
+		in += (size_t)block.count * sizeof(uint32_t);
+		if ((size_t)(end - in) < block.data_size) return false;
+		block.data = in;
+		in += block.data_size;
+	}
+	return in == end;
+}
+
+static const WorldBlock* find_block(const std::vector<WorldBlock>& blocks, const char* name) {
+	for (const WorldBlock& block : blocks) {
+		if (block.name == name) return &block;
+	}
+	return nullptr;
+}
+
+template <typename T>
+static bool decode_block(const WorldBlock& block, std::vector<T>& records) {
+	typedef std::is_trivially_copyable<T> raw;
+	WORLD_ENCODING encoding = raw::value ? WORLD_ENCODING::RAW : WORLD_ENCODING::FIELDS;
+	if (block.encoding != encoding || (raw::value && block.record_size != sizeof(T))) {
+		fprintf(stderr, "Saved %s have a different layout than in this build, skipped\n", block.name.c_str());
+		return false;
+	}
+	records.assign(block.count, T());
+	const char* in = block.data;
+	const char* end = block.data + block.data_size;
+	for (T& record : records) {
+		if (!decode_record(in, end, record, raw())) {
+			fprintf(stderr, "Saved %s are damaged, skipped\n", block.name.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+// Hooks see the component as it is inserted, the saved one is written over it afterwards
+template <typename Component>
+static void restore_component(ComponentContainer<Component>& container, Entity entity, const Component& component) {
+	container.insert(entity, component) = component;
+}
+
+static void restore_component(AttachmentContainer& container, Entity entity, const Attachment& component) {
+	container.attach(entity, component.parent) = component;
+}
+
+// Inserts records of the container member under remap of their saved entity, entity_of(i) is the
+// saved entity of record i. Entity fields are remapped the same way.
+template <typename Member, typename EntityOf>
+static void restore_records(ECSRegistry& registry, Member member, std::vector<typename SavedRecord<Member>::type>& records,
+	EntityOf entity_of, Mesh* meshes, const std::function<Entity(Entity)>& remap)
+{
+	typedef SavedRecord<Member> Record;
+	// Entity() stays Entity(), it is the unset value of Entity fields
+	auto remap_field = [&](Entity entity) {
+		return (unsigned int)entity == 0 ? entity : remap(entity);
+	};
+	EntityFieldRemapper<decltype(remap_field)> remapper{ remap_field };
+
+	auto& container = registry.*member;
+	container.reserve_additional(records.size());
+	for (size_t i = 0; i < records.size(); i++) {
+		Entity entity = remap(entity_of(i));
+		if ((unsigned int)entity == 0) continue;
+		Reflection<typename Record::type>::visit(records[i], remapper);
+		typename Record::Component component;
+		if (!SavedAs<typename Record::Component>::load(records[i], meshes, component)) continue;
+		restore_component(container, entity, component);
+	}
+}
+
+void capture_world(ECSRegistry& registry, const std::vector<Entity>& entities, const Mesh* meshes, std::vector<char>& blob) {
+	std::unordered_set<unsigned int> included;
+	for (Entity entity : entities) {
+		included.insert(entity);
+	}
+
+	blob.clear();
+	uint32_t block_count = 0;
+	append_value(blob, block_count);
+	for_each_world_container([&](auto member) {
+		typedef SavedRecord<decltype(member)> Record;
+		auto& container = registry.*member;
+		WorldBlockData block;
+		for (size_t i = 0; i < container.components.size(); i++) {
+			Entity entity = container.entities[i];
+			if (included.count(entity) == 0) continue;
+			block.entities.push_back(entity);
+			append_record<typename Record::type>(block, SavedAs<typename Record::Component>::save(container.components[i], meshes));
+		}
+		if (block.count == 0) return;
+		append_block<typename Record::type>(blob, block);
+		block_count++;
+	});
+	memcpy(blob.data(), &block_count, sizeof(block_count));
+}
+
+bool restore_world(ECSRegistry& registry, const std::vector<char>& blob, Mesh* meshes, const std::function<Entity(Entity)>& remap) {
+	std::vector<WorldBlock> blocks;
+	if (!parse_blocks(blob, blocks)) {
+		fprintf(stderr, "Saved world is damaged\n");
+		return false;
+	}
+
+	// A record out of range rejects the whole save, the registry is still untouched here
+	bool in_range = true;
+	for_each_world_container([&](auto member) {
+		typedef typename SavedRecord<decltype(member)>::type Record;
+		if (!SavedRange<Record>::checked || !in_range) return;
+		const WorldBlock* block = find_block(blocks, Reflection<Record>::name());
+		std::vector<Record> records;
+		if (!block || !decode_block(*block, records)) return;
+		for (const Record& record : records) {
+			if (!SavedRange<Record>::valid(record)) in_range = false;
+		}
+		if (!in_range) fprintf(stderr, "Saved %s are out of range\n", block->name.c_str());
+	});
+	if (!in_range) return false;
+
+	for_each_world_container([&](auto member) {
+		typedef typename SavedRecord<decltype(member)>::type Record;
+		const WorldBlock* block = find_block(blocks, Reflection<Record>::name());
+		std::vector<Record> records;
+		if (!block || !decode_block(*block, records)) return;
+		restore_records(registry, member, records, [block](size_t i) { return block->entity((uint32_t)i); }, meshes, remap);
+	});
+
+	// The insert hook placed enemies by their position, they are counted where they spawned
+	registry.population.rebuild(registry.enemies);
+	return true;
+}
+
+json world_to_json(const std::vector<char>& blob) {
+	json data = json::object();
+	std::vector<WorldBlock> blocks;
+	if (!parse_blocks(blob, blocks)) {
+		fprintf(stderr, "Saved world is damaged\n");
+		return data;
+	}
+
+	for_each_world_container([&](auto member) {
+		typedef typename SavedRecord<decltype(member)>::type Record;
+		const char* name = Reflection<Record>::name();
+		const WorldBlock* block = find_block(blocks, name);
+		std::vector<Record> records;
+		if (!block || !decode_block(*block, records)) return;
+
+		json& entities = data[name]["entities"] = json::array();
+		json& components = data[name]["components"] = json::array();
+		for (uint32_t i = 0; i < block->count; i++) {
+			entities.push_back((unsigned int)block->entity(i));
+			json component = json::object();
+			JsonFieldWriter writer{ component };
+			Reflection<Record>::visit(records[i], writer);
+			components.push_back(component);
+		}
+	});
+	return data;
+}
+
+WorldJsonReader::WorldJsonReader() : blocks(world_types().size()) {
+}
+
+int WorldJsonReader::type_index(const std::string& type) {
+	if (last_index < 0 || type != last_type) {
+		last_type = type;
+		last_index = world_type_index(type);
+	}
+	return last_index;
+}
+
+bool WorldJsonReader::add_entity(const std::string& type, uint32_t entity) {
+	int index = type_index(type);
+	if (index < 0) return false;
+	blocks[index].entities.push_back(entity);
+	return true;
+}
+
+bool WorldJsonReader::add_component(const std::string& type, const json& component) {
+	int index = type_index(type);
+	if (index < 0) return false;
+	world_types()[index].append_json_record(blocks[index], component);
+	return true;
+}
+
+bool WorldJsonReader::finish(std::vector<char>& blob) {
+	const std::vector<WorldType>& types = world_types();
+	blob.clear();
+	uint32_t block_count = 0;
+	append_value(blob, block_count);
+	for (size_t i = 0; i < types.size(); i++) {
+		if (blocks[i].entities.size() != blocks[i].count) {
+			fprintf(stderr, "Saved %s don't have an entity per component\n", types[i].name);
+			return false;
+		}
+		if (blocks[i].count == 0) continue;
+		types[i].append_block(blob, blocks[i]);
+		block_count++;
+	}
+	memcpy(blob.data(), &block_count, sizeof(block_count));
+	return true;
+}
+
+// The records of one type, decoded
+struct WorldStaging::Block {
+	virtual ~Block() {}
+	// False when the record is out of range
+	virtual bool add_component(const json& component) = 0;
+	virtual size_t size() const = 0;
+	// Moves the records into registry and forgets them
+	virtual void restore(ECSRegistry& registry, Mesh* meshes, const std::function<Entity(Entity)>& remap) = 0;
+
+	std::vector<Entity> entities;
+	bool out_of_range = false;
+};
+
+template <typename Member>
+struct WorldStaging::TypedBlock : WorldStaging::Block {
+	typedef typename SavedRecord<Member>::type Record;
+
+	explicit TypedBlock(Member member) : member(member) {}
+
+	bool add_component(const json& component) {
+		Record record = Record();
+		JsonFieldReader reader{ component };
+		Reflection<Record>::visit(record, reader);
+		records.push_back(record);
+		return SavedRange<Record>::valid(record);
+	}
+
+	size_t size() const { return records.size(); }
+
+	void restore(ECSRegistry& registry, Mesh* meshes, const std::function<Entity(Entity)>& remap) {
+		restore_records(registry, member, records, [this](size_t i) { return entities[i]; }, meshes, remap);
+		std::vector<Record>().swap(records);
+		std::vector<Entity>().swap(entities);
+	}
+
+	Member member;
+	std::vector<Record> records;
+};
+
+WorldStaging::WorldStaging() {
+	for_each_world_container([this](auto member) {
+		blocks.emplace_back(new TypedBlock<decltype(member)>(member));
+	});
+}
+
+WorldStaging::~WorldStaging() {
+}
+
+int WorldStaging::type_index(const std::string& type) {
+	if (last_index < 0 || type != last_type) {
+		last_type = type;
+		last_index = world_type_index(type);
+	}
+	return last_index;
+}
+
+bool WorldStaging::add_entity(const std::string& type, uint32_t entity) {
+	int index = type_index(type);
+	if (index < 0) return false;
+	blocks[index]->entities.push_back(Entity(entity));
+	return true;
+}
+
+bool WorldStaging::add_component(const std::string& type, const json& component) {
+	int index = type_index(type);
+	if (index < 0) return false;
+	if (!blocks[index]->add_component(component)) blocks[index]->out_of_range = true;
+	return true;
+}
+
+bool WorldStaging::finish() {
+	const std::vector<WorldType>& types = world_types();
+	for (size_t i = 0; i < blocks.size(); i++) {
+		if (blocks[i]->entities.size() != blocks[i]->size()) {
+			fprintf(stderr, "Saved %s don't have an entity per component\n", types[i].name);
+			return false;
+		}
+		if (blocks[i]->out_of_range) {
+			fprintf(stderr, "Saved %s are out of range\n", types[i].name);
+			return false;
+		}
+	}
+	return true;
+}
+
+bool WorldStaging::empty() const {
+	for (const auto& block : blocks) {
+		if (block->size() > 0) return false;
+	}
+	return true;
+}
+
+void restore_world(ECSRegistry& registry, WorldStaging& staging, Mesh* meshes, const std::function<Entity(Entity)>& remap) {
+	for (auto& block : staging.blocks) {
+		block->restore(registry, meshes, remap);
+	}
+	registry.population.rebuild(registry.enemies);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// stlib
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Full fidelity snapshots of a set of entities with all their components, for every container listed
+// in component_reflection.hpp. A snapshot is a byte blob: uint32 block count, then one block per type
+//   uint8 name length, name, uint8 WORLD_ENCODING, uint32 record size, uint32 record count,
+//   uint32 data size, the uint32 entity ids, then the data
+// Trivially copyable components are copied whole (RAW, the record size is their sizeof), the others
+// field by field (FIELDS), so RAW records keep whatever padding bytes the components had. Blocks are
+// found by name, RAW blocks from a build with a different layout are skipped with a warning.
+enum class WORLD_ENCODING {
+	RAW = 0,
+	FIELDS = RAW + 1,
+	WORLD_ENCODING_COUNT = FIELDS + 1
+};
+
+// Replaces blob with the components of entities, in container order. Mesh pointers are stored as
+// their index into meshes, the renderer's array of geometry_count meshes.
+void capture_world(ECSRegistry& registry, const std::vector<Entity>& entities, const Mesh* meshes, std::vector<char>& blob);
+
+// Inserts the components of blob. A saved entity goes to remap(entity), which also rewrites the
+// Entity fields of components; records remapped to Entity() are dropped. The entities must not
+// have any of the saved components yet. Fails without inserting anything when the blob is damaged
+// or a record is out of range, e.g. an enemy type or region this build does not have.
+bool restore_world(ECSRegistry& registry, const std::vector<char>& blob, Mesh* meshes, const std::function<Entity(Entity)>& remap);
+
+class WorldStaging;
+
+// Moves the components of staging into registry, like restore_world for a blob. staging was checked
+// by its finish() and is empty afterwards.
+void restore_world(ECSRegistry& registry, WorldStaging& staging, Mesh* meshes, const std::function<Entity(Entity)>& remap);
+
+// The same snapshot as JSON, one object per type with "entities" and "components" lists
+json world_to_json(const std::vector<char>& blob);
+
+// The records of one type, already encoded
+struct WorldBlockData {
+	std::vector<uint32_t> entities;
+	std::vector<char> data;
+	uint32_t count = 0;
+};
+
+// Builds a snapshot from its JSON form one value at a time, so a save game can be streamed in
+// without holding the world as JSON. Types are named as in world_to_json, the entities and
+// components of a type may come in any order.
+class WorldJsonReader
+{
+public:
+	WorldJsonReader();
+
+	// Both return false for types this build does not know
+	bool add_entity(const std::string& type, uint32_t entity);
+	bool add_component(const std::string& type, const json& component);
+
+	// Replaces blob with the snapshot, fails if a type got a different number of entities and components
+	bool finish(std::vector<char>& blob);
+
+private:
+	int type_index(const std::string& type);
+
+	std::vector<WorldBlockData> blocks;	// In the order of for_each_world_container
+	std::string last_type;	// Records of a type come in runs, so the last lookup is kept
+	int last_index = -1;
+};
+
+// A saved world streamed in from its JSON form like with WorldJsonReader, but kept decoded under the
+// saved entity ids instead of encoded into a blob. The game reads a JSON save into one and restores it
+// only once the whole file checked out, so the world is held once while loading and the running game
+// is not touched by a file that turns out to be damaged.
+class WorldStaging
+{
+public:
+	WorldStaging();
+	~WorldStaging();
+
+	// Both return false for types this build does not know
+	bool add_entity(const std::string& type, uint32_t entity);
+	bool add_component(const std::string& type, const json& component);
+
+	// Fails if a type got a different number of entities and components, or a record out of range
+	bool finish();
+	bool empty() const;
+
+private:
+	friend void restore_world(ECSRegistry& registry, WorldStaging& staging, Mesh* meshes, const std::function<Entity(Entity)>& remap);
+
+	struct Block;
+	template <typename Member>
+	struct TypedBlock;
+
+	int type_index(const std::string& type);
+
+	std::vector<std::unique_ptr<Block>> blocks;	// In the order of for_each_world_container
+	std::string last_type;	// Records of a type come in runs, so the last lookup is kept
+	int last_index = -1;
+};
@@ -1,6 +1,8 @@
 // Header
 #include "world_system.hpp"
+#include "world_serializer.hpp"
 #include "world_init.hpp"
+#include "prefabs.hpp"
 #include "sub_systems/dialog_system.hpp"
 #include "sub_systems/effects_system.hpp"
 #include "sub_systems/menu_system.hpp"
@@ -14,28 +16,20 @@
 #include <unordered_map>
 #include <iostream>
 
-std::unordered_map < int, int > keys_pressed;
-float spaceBarPressDuration = 0.0f;
-std::unordered_map < int, float > axes_state;
-const unsigned char* controller_buttons = nullptr;
-vec2 mouse;
 const float ENEMY_SPAWN_PADDING = 50.f; // Padding to ensure off-screen spawn
-float enemy_spawn_cooldown = 5000.f;
-float individual_spawn_interval = 1000.f;
-std::vector<ENEMY_ID> enemyTypes = { ENEMY_ID::RED, ENEMY_ID::GREEN, ENEMY_ID::YELLOW }; // Add more types as needed
-float menu_timer = 0.f;
-
-bool controller_mode = FALSE; //if most recent input is controller set to 1, if mouse/keyboard set to 0
-
+const float PROJECTILE_KNOCKBACK_VELOCITY = 1400.f; // Player knockback when hit by a bullet
+const std::vector<ENEMY_ID> enemyTypes = { ENEMY_ID::RED, ENEMY_ID::GREEN, ENEMY_ID::YELLOW }; // Add more types as needed
 
 // Create the world
-WorldSystem::WorldSystem() {
-	// Seeding rng with random device
-	rng = std::default_random_engine(std::random_device()());
+WorldSystem::WorldSystem(ECSRegistry& registry)
+	: registry(registry), spawn_manager(registry), checkpoints(registry, CHECKPOINT_CAPACITY), checkpoint_states(CHECKPOINT_CAPACITY),
+	save_writer(&WorldSystem::build_save_state) {
+	// Seeding rng with random device, every other stream derives from this seed
+	registry.random.reseed(std::random_device()());
+	rng = registry.random.persistent_stream(RNG_STREAM_ID::WORLD);
+	printf("RNG seed: %u\n", registry.random.get_seed());
 	allow_accel = true;
-	enemyCounts[ENEMY_ID::RED] = 0;
-	enemyCounts[ENEMY_ID::GREEN] = 0;
-	enemyCounts[ENEMY_ID::YELLOW] = 0;
+	game_entity = registry.create_entity();
 	maxEnemies[ENEMY_ID::RED] = 0;
 	maxEnemies[ENEMY_ID::GREEN] = 0;
 	maxEnemies[ENEMY_ID::YELLOW] = 0;
@@ -129,9 +123,9 @@ GLFWwindow* WorldSystem::create_window() {
 	// Input is handled using GLFW, for more info see
 	// http://www.glfw.org/docs/latest/input_guide.html
 	glfwSetWindowUserPointer(window, this);
-	auto key_redirect = [](GLFWwindow* wnd, int _0, int _1, int _2, int _3) { ((WorldSystem*)glfwGetWindowUserPointer(wnd))->on_key(_0, _1, _2, _3); };
-	auto cursor_pos_redirect = [](GLFWwindow* wnd, double _0, double _1) { ((WorldSystem*)glfwGetWindowUserPointer(wnd))->on_mouse_move({ _0, _1 }); };
-	auto mouse_button_callback = [](GLFWwindow* wnd, int button, int action, int mods) { ((WorldSystem*)glfwGetWindowUserPointer(wnd))->on_key(button, 0, action, mods); };
+	auto key_redirect = [](GLFWwindow* wnd, int _0, int, int _2, int _3) { ((WorldSystem*)glfwGetWindowUserPointer(wnd))->on_glfw_input(InputEvent::key(_0, _2, _3)); };
+	auto cursor_pos_redirect = [](GLFWwindow* wnd, double _0, double _1) { ((WorldSystem*)glfwGetWindowUserPointer(wnd))->on_glfw_input(InputEvent::cursor_move({ _0, _1 })); };
+	auto mouse_button_callback = [](GLFWwindow* wnd, int button, int action, int mods) { ((WorldSystem*)glfwGetWindowUserPointer(wnd))->on_glfw_input(InputEvent::mouse_button(button, action, mods)); };
 	auto controller_joystick_callback = [](int joy, int event) { ((WorldSystem*)glfwGetWindowUserPointer(glfwGetCurrentContext()))->on_controller_joy(joy, event); };
 
 	glfwSetKeyCallback(window, key_redirect);
@@ -228,18 +222,25 @@ void WorldSystem::on_controller_joy(int joy, int event) {
 
 }
 
-void WorldSystem::init(RenderSystem* renderer_arg) {
+bool WorldSystem::init(RenderSystem* renderer_arg, const FrameContext* frame_arg) {
 	this->renderer = renderer_arg;
-	this->effects_system = new EffectsSystem(player, rng, soundChunks, *this);
-	this->menu_system = new MenuSystem(mouse);
+	this->frame = frame_arg;
+	if (!registry.prefabs.load(prefab_path("enemies.json"))) {
+		fprintf(stderr, "Failed to load enemy prefabs\n");
+		return false;
+	}
+	this->effects_system = new EffectsSystem(registry, player, soundChunks, *this);
+	this->menu_system = new MenuSystem(registry, mouse);
+	spawn_manager.init();
+	subscribe_collision_handlers();
 
 	// Create world entities that don't reset
-	cursor = createCrosshair();
+	cursor = createCrosshair(registry);
 
-	createCamera({ 0.f, 0.f });
-	hold_to_collect = createHoldGuide({ 0.f, CONTENT_HEIGHT_PX * -0.42 }, HOLD_GUIDE_TEXTURE_SIZE * 0.5f);
-	dialog_system = new DialogSystem(keys_pressed, mouse, controller_buttons);
-	registry.gameMode.insert(Entity(), regularMode);
+	createCamera(registry, { 0.f, 0.f });
+	hold_to_collect = createHoldGuide(registry, { 0.f, CONTENT_HEIGHT_PX * -0.42 }, HOLD_GUIDE_TEXTURE_SIZE * 0.5f);
+	dialog_system = new DialogSystem(registry, input, mouse);
+	registry.gameMode.insert(registry.create_entity(), regularMode);
 
 	// Set all states to default
 	restart_game(true);
@@ -249,18 +250,18 @@ void WorldSystem::init(RenderSystem* renderer_arg) {
 
 	button_select = BUTTON_SELECT::NONE;
 	state = GAME_STATE::START_MENU;
+	return true;
 }
 
-bool isKeyPressed() {
-	for (auto keyVal = keys_pressed.begin(); keyVal != keys_pressed.end(); ++keyVal) {
-		if (keyVal->second) return true;
-	}
-	if (controller_buttons != nullptr) {
-		for (uint i = 0; i < 19; i++) {
-			if (controller_buttons[i]) return true;
-		}
-	}
-	return false;
+void WorldSystem::set_seed(uint32_t seed) {
+	registry.random.reseed(seed);
+	rng = registry.random.persistent_stream(RNG_STREAM_ID::WORLD);
+	printf("RNG seed: %u\n", registry.random.get_seed());
+}
+
+void WorldSystem::start_run(bool show_dialogs) {
+	dialog_system->enabled = show_dialogs;
+	restart_game(true);
 }
 
 void WorldSystem::step_deathTimer(float elapsed_ms) {
@@ -274,10 +275,12 @@ void WorldSystem::step_deathTimer(float elapsed_ms) {
 
 			if (timer.timer_ms <= 0) {
 				// Player is dead -> restart
-				if (isKeyPressed()) {
+				if (input.any()) {
+					bool in_boss_fight = registry.bosses.size() > 0 && registry.bosses.components[0].activated;
 					registry.deathTimers.remove(entity);
 					registry.remove_all_components_of(death_screen);
-					restart_game();
+					// Dying in a boss fight retries it from where it started
+					if (!in_boss_fight || !restore_checkpoint()) restart_game();
 				}
 				return;
 			}
@@ -296,8 +299,8 @@ void WorldSystem::step_deathTimer(float elapsed_ms) {
 
 				if (type == ENEMY_ID::BOSS) {
 					vec2 enemyDeathSpot = registry.transforms.get(entity).position;
-					Entity cure = createCure(enemyDeathSpot);
-					createWaypoint(REGION_GOAL_ID::CURE, cure);
+					Entity cure = createCure(registry, enemyDeathSpot);
+					createWaypoint(registry, REGION_GOAL_ID::CURE, cure);
 					registry.game.get(game_entity).isFirstBossDefeated = true;
 					registry.colors.get(boss_healthbar).a = 0.f;
 					registry.colors.get(boss_healthbar_frame).a = 0.f;
@@ -324,25 +327,24 @@ void WorldSystem::step_deathTimer(float elapsed_ms) {
 					state = GAME_STATE::CREDITS;
 				}
 
-				enemyCounts[type]--;
+				remove_entity(entity);
+				// Regular enemies and clones come from prefabs, keep their entity for the next spawn
+				if (registry.prefabs.get(type).loaded) registry.prefabs.recycle(type, entity);
+			}
+			else {
+				remove_entity(entity);
 			}
-			remove_entity(entity);
 		}
 	}
 }
 
 void WorldSystem::remove_entity(Entity entity) {
-	// Remove all attachments of the entity recursively before removing itself
-	// Iterating backwards and updating i since multiple entities can be removed
-	for (int i = (int)registry.attachments.components.size() - 1;
-		i >= 0 && registry.attachments.components.size() > 0;
-		i = min(i - 1, (int)registry.attachments.components.size() - 1)
-		) {
-		if (registry.attachments.components[i].parent == entity) {
-			remove_entity(registry.attachments.entities[i]);
-		}
+	// Remove the entity together with all its attachments, deepest first
+	std::vector<Entity> subtree;
+	registry.attachments.collect_subtree(entity, subtree);
+	for (int i = (int)subtree.size() - 1; i >= 0; i--) {
+		registry.remove_all_components_of(subtree[i]);
 	}
-	registry.remove_all_components_of(entity);
 }
 
 void WorldSystem::step_roll_credits(float elapsed_ms) {
@@ -388,18 +390,18 @@ void WorldSystem::startEntityDeath(Entity entity) {
 
 		Mix_PlayChannel(chunkToChannel["player_death"], soundChunks["player_death"], 0);
 
-		RenderSystem::animationSys_switchAnimation(player,
+		RenderSystem::animationSys_switchAnimation(registry, player,
 			ANIMATION_FRAME_COUNT::IMMUNITY_DYING,
 			static_cast<int>(ceil((DEATH_EFFECT_DURATION + buffer) / static_cast<int>(ANIMATION_FRAME_COUNT::IMMUNITY_DYING))));
 
 		int scenario = 1;
 		for (auto boss : registry.bosses.entities) {
-			if (length(vec2(renderer->createViewMatrix() * vec3(registry.transforms.get(boss).position, 1.f))) < SCREEN_RADIUS) {
+			if (length(frame->to_screen(registry.transforms.get(boss).position)) < SCREEN_RADIUS) {
 				scenario = 2;
 				break;
 			}
 		}
-		death_screen = createDeathScreen(scenario);
+		death_screen = createDeathScreen(registry, scenario);
 		registry.motions.get(player).max_velocity *= 0.f;
 		registry.collideEnemies.remove(player);
 		registry.guns.get(player).attack_timer = 9999.f;
@@ -426,7 +428,7 @@ void WorldSystem::startEntityDeath(Entity entity) {
 
 		Enemy& enemy = registry.enemies.get(entity);
 		if (enemy.type == ENEMY_ID::GREEN) {
-			RenderSystem::animationSys_switchAnimation(entity,
+			RenderSystem::animationSys_switchAnimation(registry, entity,
 				ANIMATION_FRAME_COUNT::GREEN_ENEMY_DYING,
 				static_cast<int>(ceil((DEATH_EFFECT_DURATION_ENEMY + buffer) / static_cast<int>(ANIMATION_FRAME_COUNT::GREEN_ENEMY_DYING))));
 		}
@@ -519,6 +521,8 @@ void WorldSystem::step_invincibility(float elapsed_ms) {
 		float flashAlpha;
 		if (timer <= 0) {
 			registry.invincibility.remove(player);
+			// Enemies and cysts the player still touches act on it again
+			registry.contacts.rearm(player);
 			flashAlpha = 1.f;
 		}
 		else {
@@ -531,13 +535,9 @@ void WorldSystem::step_invincibility(float elapsed_ms) {
 		player_color.a = flashAlpha;
 
 		// set alpha value for all attachments of  the player
-		for (uint i = 0; i < registry.attachments.size(); i++) {
-			Attachment& att = registry.attachments.components[i];
-			if (att.parent == player) {
-				Entity att_entity = registry.attachments.entities[i];
-				if (registry.colors.has(att_entity)) {
-					registry.colors.get(att_entity).a = flashAlpha;
-				}
+		for (Entity att_entity : registry.attachments.children_of(player)) {
+			if (registry.colors.has(att_entity)) {
+				registry.colors.get(att_entity).a = flashAlpha;
 			}
 		}
 	}
@@ -546,12 +546,15 @@ void WorldSystem::step_invincibility(float elapsed_ms) {
 		Enemy& enemy_attrib = registry.enemies.components[i];
 		if (enemy_attrib.sword_attack_cd > 0.f) {
 			enemy_attrib.sword_attack_cd -= elapsed_ms;
+			// A sword still touching it hits again
+			if (enemy_attrib.sword_attack_cd <= 0.f) registry.contacts.rearm(registry.enemies.entities[i]);
 		}
 	}
 	for (uint i = 0; i < registry.cysts.components.size(); i++) {
 		Cyst& cyst_attrib = registry.cysts.components[i];
 		if (cyst_attrib.sword_attack_cd > 0.f) {
 			cyst_attrib.sword_attack_cd -= elapsed_ms;
+			if (cyst_attrib.sword_attack_cd <= 0.f) registry.contacts.rearm(registry.cysts.entities[i]);
 		}
 	}
 }
@@ -604,44 +607,29 @@ void WorldSystem::step_dash(float elapsed_ms) {
 	}
 }
 
-bool out_of_boundary_check(vec2 entityScale, vec2 entityPos) {
-	if (length(entityPos) + length(entityScale) / 2.f > MAP_RADIUS) {
-		return true;
-	}
-	return false;
-}
-
 void WorldSystem::spawnEnemyOfType(ENEMY_ID type, vec2 player_position, vec2 player_velocity) {
-	std::uniform_real_distribution<float> angle_randomness(-M_PI / 4, M_PI / 4);  // 45 degrees randomness
-
-	// Determine the angle for spawning based on player's velocity
-	float player_movement_angle = atan2(player_velocity.y, player_velocity.x);
-	float random_offset = angle_randomness(rng);
-	float angle = length(player_velocity) > 0.001f
-		? player_movement_angle + random_offset
-		: uniform_dist(rng) * 2 * M_PI;
-
-	// Calculate spawn position around the player, but off-screen
-	vec2 offset = { cos(angle) * (SCREEN_RADIUS + ENEMY_SPAWN_PADDING), sin(angle) * (SCREEN_RADIUS + ENEMY_SPAWN_PADDING) };
-	vec2 spawn_position = player_position + offset;
+	// Prefer spawning ahead of the player (45 degrees randomness), anywhere around it when standing still
+	bool is_moving = length(player_velocity) > 0.001f;
+	float preferred_angle = is_moving ? atan2(player_velocity.y, player_velocity.x) : 0.f;
+	float spread = is_moving ? M_PI / 4 : M_PI;
+
+	// Calculate spawn position around the player, off-screen but inside the map
+	vec2 spawn_position;
+	if (!SpawnManager::sample_spawn_point(player_position, SCREEN_RADIUS + ENEMY_SPAWN_PADDING,
+		registry.prefabs.get(type).transform.scale, preferred_angle, spread, uniform_dist(rng), spawn_position)) {
+		return;
+	}
 
 	switch (type) {
 	case ENEMY_ID::RED:
-		if (out_of_boundary_check(RED_ENEMY_SIZE, spawn_position)) break;
-		//std::cout << "Spawning Red Enemy at: (" << spawn_position.x << ", " << spawn_position.y << ")" << std::endl;
-		createRedEnemy(spawn_position);
-		enemyCounts[ENEMY_ID::RED]++;
+		spawn_manager.track(createRedEnemy(registry, spawn_position));
 		break;
 	case ENEMY_ID::GREEN:
-		if (out_of_boundary_check(GREEN_ENEMY_SIZE, spawn_position)) break;
-		//std::cout << "Spawning Green Enemy at: (" << spawn_position.x << ", " << spawn_position.y << ")" << std::endl;
-		createGreenEnemy(spawn_position);
-		enemyCounts[ENEMY_ID::GREEN]++;
+		spawn_manager.track(createGreenEnemy(registry, spawn_position));
 		break;
 	case ENEMY_ID::YELLOW:
-		if (out_of_boundary_check(YELLOW_ENEMY_SIZE, spawn_position)) break;
-		createYellowEnemy(spawn_position);
-		enemyCounts[ENEMY_ID::YELLOW]++;
+		spawn_manager.track(createYellowEnemy(registry, spawn_position));
+		break;
 	default:
 		break;
 	}
@@ -653,7 +641,7 @@ void WorldSystem::spawnEnemiesNearInterestPoint(vec2 player_position) {
 	std::uniform_int_distribution<int> type_dist(0, static_cast<int>(enemyTypes.size()) - 1);
 	ENEMY_ID randomType = enemyTypes[type_dist(rng)];
 
-	if (enemyCounts[randomType] < getMaxEnemiesForType(randomType)) {
+	if (registry.population.count(randomType) < getMaxEnemiesForType(randomType)) {
 		spawnEnemyOfType(randomType, player_position, player_velocity);
 	}
 
@@ -667,12 +655,12 @@ int WorldSystem::getMaxEnemiesForType(ENEMY_ID type) {
 	return 0;
 }
 
-float calculateSpawnProbability(vec2 player_position) {
-	float nearest_distance = FLT_MAX;
-	for (const Region& region : registry.regions.components) {
-		float distance = length(player_position - region.interest_point);
-		nearest_distance = std::min(nearest_distance, distance);
-	}
+static float calculateSpawnProbability(ECSRegistry& registry, vec2 player_position) {
+	if (registry.regions.size() != NUM_REGIONS) return 0.f;
+	// All interest points are at the same distance from the center, in the middle of their region,
+	// so the nearest one is the one of the region the player is in
+	const Region& region = registry.regions.components[region_index(player_position)];
+	float nearest_distance = length(player_position - region.interest_point);
 	// Convert distance to a probability (closer to interest point = higher probability)
 	return 1.0f - (nearest_distance / MAP_RADIUS);
 }
@@ -683,7 +671,7 @@ void WorldSystem::step_enemySpawn(float elapsed_ms) {
 
 	if (enemy_spawn_cooldown <= 0.f) {
 		vec2 player_position = registry.transforms.get(player).position;
-		float spawn_probability = calculateSpawnProbability(player_position);
+		float spawn_probability = calculateSpawnProbability(registry, player_position);
 
 		std::uniform_real_distribution<float> spawn_chance(0.f, 1.f);
 		if (spawn_chance(rng) < spawn_probability) {
@@ -695,22 +683,6 @@ void WorldSystem::step_enemySpawn(float elapsed_ms) {
 	}
 }
 
-// steps timers and invoke associated callback upon expiration
-void WorldSystem::step_timer_with_callback(float elapsed_ms) {
-	std::vector<Entity> garbage; // another garbage collector
-	for (uint i = 0; i < registry.timedEvents.components.size(); i++) {
-		TimedEvent& timedEvent = registry.timedEvents.components[i];
-		timedEvent.timer_ms -= elapsed_ms;
-		if (timedEvent.timer_ms <= 0.f) {
-			timedEvent.callback();
-			garbage.push_back(registry.timedEvents.entities[i]);
-		}
-	}
-	for (Entity e : garbage) {
-		registry.remove_all_components_of(e);
-	}
-}
-
 void WorldSystem::step_waypoints() {
 	static const float padding = 23.f;
 	static const float top = -CONTENT_HEIGHT_PX / 2 + padding + 4.f;
@@ -751,7 +723,7 @@ void WorldSystem::step_waypoints() {
 
 	// hide all if boss onscreen
 	for (auto boss : registry.bosses.entities) {
-		if (length(vec2(renderer->createViewMatrix() * vec3(registry.transforms.get(boss).position, 1.f))) < SCREEN_RADIUS) {
+		if (length(frame->to_screen(registry.transforms.get(boss).position)) < SCREEN_RADIUS) {
 			for (Entity wp : registry.waypoints.entities) {
 				registry.colors.get(wp).a = 0.f;
 			}
@@ -778,7 +750,7 @@ void WorldSystem::step_waypoints() {
 			continue;
 		}
 
-		vec2 interest_point_screen_coord = vec2(renderer->createViewMatrix() * vec3(waypoint.interest_point, 1.0));
+		vec2 interest_point_screen_coord = frame->to_screen(waypoint.interest_point);
 		vec2 result = findIntersectionPoint(interest_point_screen_coord);
 
 		registry.transforms.get(wp).position = result;
@@ -820,43 +792,31 @@ void WorldSystem::shakeCamera(float amount, float ms, float shake_scale, vec2 di
 	camera.shake_scale = shake_scale;
 	camera.shake_direction = direction;
 
-	TimedEvent& timer = registry.timedEvents.emplace(Entity());
-	timer.timer_ms = ms;
-	timer.callback = [amount]() {
-		registry.camera.components[0].shake -= amount;
-		};
+	TimedEvent shake_end;
+	shake_end.type = TIMED_EVENT_ID::CAMERA_SHAKE_END;
+	shake_end.values[0] = amount;
+	schedule_event(ms, shake_end);
 }
 
 void WorldSystem::update_camera(float elapsed_ms) {
-	static float total_time = 0.f;
-	total_time += elapsed_ms;
+	camera_time_ms += elapsed_ms;
 	Camera& camera = registry.camera.components[0];
-	camera.position = registry.transforms.get(player).position + camera.shake_direction * camera.shake * sin(total_time / camera.shake_scale);
+	camera.position = registry.transforms.get(player).position + camera.shake_direction * camera.shake * sinf(camera_time_ms / camera.shake_scale);
 }
 
-void WorldSystem::remove_garbage() {
-	Transform player_transform = registry.transforms.get(player);
-	vec2 player_pos = player_transform.position;
+void WorldSystem::remove_garbage(float elapsed_ms) {
+	vec2 player_pos = registry.transforms.get(player).position;
 	// Remove off-screen bullets to improve performance
-	for (Entity bullet : registry.projectiles.entities) {
-		Transform transform = registry.transforms.get(bullet);
-		if (length(transform.position - player_pos) > SCREEN_RADIUS + 200.f) {
-			registry.remove_all_components_of(bullet);
-		}
-	}
+	registry.projectiles.cull_outside(player_pos, DESPAWN_RADIUS);
 
-	for (int i = 0; i < registry.enemies.components.size(); i++) {
-		Enemy enemyComponent = registry.enemies.components[i];
-		if (enemyComponent.type == ENEMY_ID::GREEN || enemyComponent.type == ENEMY_ID::RED || enemyComponent.type == ENEMY_ID::YELLOW) {
-			Entity enemyEntity = registry.enemies.entities[i];
-			Transform enemyTransform = registry.transforms.get(enemyEntity);
-			//consider player_pos as the center pointer of the player's view screen. despawn enemy if it is out of the view
-			if (length(enemyTransform.position - player_pos) > SCREEN_RADIUS + 200.f) {
-				registry.remove_all_components_of(enemyEntity);
-				enemyCounts[enemyComponent.type]--;
-				printf("remove enemy with id = %d at position <%f, %f>\n", static_cast<int>(enemyEntity), enemyTransform.position.x, enemyTransform.position.y);
-			}
-		}
+	// Regular enemies that fell behind, only the distance rings that are due get looked at
+	despawned.clear();
+	spawn_manager.step(player_pos, elapsed_ms, despawned);
+	for (Entity enemyEntity : despawned) {
+		ENEMY_ID type = registry.enemies.get(enemyEntity).type;
+		// Attachments go too, otherwise they would follow the entity's next spawn
+		remove_entity(enemyEntity);
+		registry.prefabs.recycle(type, enemyEntity);
 	}
 }
 
@@ -888,7 +848,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update) {
 	}
 	else if (state == GAME_STATE::CREDITS) {
 		if (registry.credits.size() == 0) {
-			createCredits();
+			createCredits(registry);
 		}
 		step_roll_credits(elapsed_ms_since_last_update);
 	}
@@ -896,6 +856,9 @@ bool WorldSystem::step(float elapsed_ms_since_last_update) {
 		/*************************[ gameplay ]*************************/
 		// Code below this line will happen only during gameplay
 
+		// Captured before anything moves, so the save holds the state between two ticks
+		step_autosave(elapsed_ms_since_last_update);
+
 		if (DEBUG_MODE) create_debug_lines();
 
 		// Input updates
@@ -932,13 +895,13 @@ bool WorldSystem::step(float elapsed_ms_since_last_update) {
 		if (!(registry.bosses.size() > 0 && registry.bosses.components[0].activated)) {
 			step_enemySpawn(elapsed_ms_since_last_update);
 		}
-		step_timer_with_callback(elapsed_ms_since_last_update);
+		timers.advance(elapsed_ms_since_last_update);
 		step_waypoints();
 		detect_bossfight();
 		step_chests();
 
 		// Cleanup
-		remove_garbage();
+		remove_garbage(elapsed_ms_since_last_update);
 	}
 	else {
 		assert(false);	// Invalid game state
@@ -955,14 +918,9 @@ void WorldSystem::create_debug_lines() {
 			const Transform transform = registry.transforms.get(entity);
 			const Mesh* mesh = registry.meshPtrs.components[i];
 
-			Transformation t_matrix;
-			t_matrix.translate(transform.position);
-			t_matrix.rotate(transform.angle);
-			t_matrix.scale(transform.scale);
-
 			std::vector<vec2> vertex_pos;
 			for (TexturedVertex v : mesh->texture_vertices) {
-				vec3 world_pos = t_matrix.mat * vec3(v.position.x, v.position.y, 1.f);
+				vec3 world_pos = transform.world * vec3(v.position.x, v.position.y, 1.f);
 				vertex_pos.push_back(vec2(world_pos.x, world_pos.y));
 
 			}
@@ -974,7 +932,7 @@ void WorldSystem::create_debug_lines() {
 				vec2 diff = point_2 - point_1;
 				float line_len = length(diff);
 				float line_angle = atan2f(diff.y, diff.x);
-				createLine(line_pos, line_angle, { line_len, 2.f });
+				createLine(registry, line_pos, line_angle, { line_len, 2.f });
 			}
 		}
 	}
@@ -989,23 +947,23 @@ void WorldSystem::populate_region_goals() {
 
 		if (region.goal == REGION_GOAL_ID::CURE) {
 			if (!game.isFirstBossDefeated) {
-				Entity firstBoss = createBoss(renderer, region.interest_point);
-				createWaypoint(region.goal, firstBoss);
+				Entity firstBoss = createBoss(registry, renderer, region.interest_point);
+				createWaypoint(registry, region.goal, firstBoss);
 			}
 			else if (!game.isCureObtained) {
-				Entity cure = createCure(region.interest_point);
-				createWaypoint(region.goal, cure);
+				Entity cure = createCure(registry, region.interest_point);
+				createWaypoint(registry, region.goal, cure);
 			}
 		}
 		else if (region.goal == REGION_GOAL_ID::CANCER_CELL) {
 			if (game.isCureObtained && !game.isSecondBossDefeated) {
-				Entity secondBoss = createSecondBoss(renderer, region.interest_point);
-				createWaypoint(region.goal, secondBoss);
+				Entity secondBoss = createSecondBoss(registry, renderer, region.interest_point);
+				createWaypoint(registry, region.goal, secondBoss);
 			}
 		}
 		else {
-			Entity chest = createChest(region.interest_point, region.goal);
-			createWaypoint(region.goal, chest);
+			Entity chest = createChest(registry, region.interest_point, region.goal);
+			createWaypoint(registry, region.goal, chest);
 		}
 	}
 }
@@ -1015,7 +973,7 @@ void WorldSystem::populate_player_abilities() {
 		PLAYER_ABILITY_ID ability = ability_component.id;
 		switch (ability) {
 		case PLAYER_ABILITY_ID::SWORD: {
-			createSword(renderer, player);
+			createSword(registry, renderer, player);
 			break;
 		}
 		case PLAYER_ABILITY_ID::BULLET_BOOST: {
@@ -1035,10 +993,7 @@ void WorldSystem::populate_player_abilities() {
 		case PLAYER_ABILITY_ID::HEALTH_BOOST: {
 			assert(registry.healthValues.has(player));
 			Health& health = registry.healthValues.get(player);
-			assert(registry.renderRequests.has(healthbar_frame));
-			registry.renderRequests.get(healthbar_frame).used_texture = TEXTURE_ASSET_ID::HEALTHBAR_FRAME_BOOST;
-			assert(registry.healthbar.has(healthbar));
-			registry.healthbar.get(healthbar).full_health_color = { 0.f, 1.f, 1.f, 1.f };
+			apply_health_boost_hud();
 			health.healthMultiplier = 2.0f;
 			health.maxHealth *= health.healthMultiplier;
 			health.health = health.maxHealth;
@@ -1046,7 +1001,7 @@ void WorldSystem::populate_player_abilities() {
 			break;
 		}
 		case PLAYER_ABILITY_ID::DASHING: {
-			createDashing(player);
+			createDashing(registry, player);
 			break;
 		}
 		default:
@@ -1056,6 +1011,13 @@ void WorldSystem::populate_player_abilities() {
 	}
 }
 
+void WorldSystem::apply_health_boost_hud() {
+	assert(registry.renderRequests.has(healthbar_frame));
+	registry.renderRequests.get(healthbar_frame).used_texture = TEXTURE_ASSET_ID::HEALTHBAR_FRAME_BOOST;
+	assert(registry.healthbar.has(healthbar));
+	registry.healthbar.get(healthbar).full_health_color = { 0.f, 1.f, 1.f, 1.f };
+}
+
 // Reset the world state to its initial state
 void WorldSystem::restart_game(bool hard_reset) {
 	printf("\n=========================\n|\tRestarting\t|\n=========================\n");
@@ -1079,19 +1041,17 @@ void WorldSystem::restart_game(bool hard_reset) {
 		dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_GAME_START);
 	}
 
-	maxEnemies[ENEMY_ID::RED] = registry.gameMode.components.back().max_red;
-	maxEnemies[ENEMY_ID::GREEN] = registry.gameMode.components.back().max_green;
-	maxEnemies[ENEMY_ID::YELLOW] = registry.gameMode.components.back().max_yellow;
+	update_enemy_limits();
 
 	// Create a new player
-	player = createPlayer({ 0, 0 });
+	player = createPlayer(registry, { 0, 0 });
 	effects_system->player = player;
 	populate_player_abilities();
 
 	// Populate regions
 	if (DEBUG_MODE) {
-		createBoss(renderer, { 100.f, 100.f });
-		createSecondBoss(renderer, { -100.f, 100.f });
+		createBoss(registry, renderer, { 100.f, 100.f });
+		createSecondBoss(registry, renderer, { -100.f, 100.f });
 	}
 	else {
 		populate_region_goals();
@@ -1101,13 +1061,16 @@ void WorldSystem::restart_game(bool hard_reset) {
 	registry.colors.get(boss_healthbar).a = 0.f;
 	registry.colors.get(boss_healthbar_frame).a = 0.f;
 
-	createRandomCysts(rng);
+	createRandomCysts(registry, rng);
 	update_camera(0.f);
 }
 
 // Call this method each frame to update the space bar duration
-void updateSpaceBarPressDuration() {
-	if (keys_pressed[GLFW_KEY_SPACE] || (controller_buttons != nullptr && controller_buttons[2])) {
+static void updateSpaceBarPressDuration(const InputState& input, float& spaceBarPressDuration) {
+	if (input.action_pressed(INPUT_ACTION::INTERACT)) {
+		spaceBarPressDuration = 0.0f; // Reset duration on new press
+	}
+	if (input.action(INPUT_ACTION::INTERACT)) {
 		spaceBarPressDuration += 1;
 	}
 	else {
@@ -1115,7 +1078,7 @@ void updateSpaceBarPressDuration() {
 	}
 }
 
-bool isHoldingSpace(float time_ms) {
+static bool isHoldingSpace(float spaceBarPressDuration, float time_ms) {
 	if (spaceBarPressDuration >= time_ms) {
 		return true;
 	}
@@ -1124,13 +1087,77 @@ bool isHoldingSpace(float time_ms) {
 
 void WorldSystem::squish(Entity entity, float squish_amount) {
 	registry.transforms.get(entity).scale *= squish_amount;
-	TimedEvent& timer = registry.timedEvents.emplace(Entity());
-	timer.timer_ms = 30.f;
-	timer.callback = [entity, squish_amount]() {
-		if (registry.transforms.has(entity)) {
-			registry.transforms.get(entity).scale /= squish_amount;
+	TimedEvent squish_end;
+	squish_end.type = TIMED_EVENT_ID::SQUISH_END;
+	squish_end.entity = entity;
+	squish_end.values[0] = squish_amount;
+	schedule_event(30.f, squish_end);
+}
+
+void WorldSystem::schedule_event(float delay_ms, const TimedEvent& event) {
+	uint32_t id = next_event_id++;
+	TimerHandle timer = timers.schedule(delay_ms, [this, id]() { fire_event(id); });
+	pending_events[id] = { event, timer };
+}
+
+void WorldSystem::fire_event(uint32_t id) {
+	auto it = pending_events.find(id);
+	assert(it != pending_events.end());
+	TimedEvent event = it->second.event;
+	pending_events.erase(it);
+
+	switch (event.type) {
+	case TIMED_EVENT_ID::CAMERA_SHAKE_END:
+		registry.camera.components[0].shake -= event.values[0];
+		break;
+	case TIMED_EVENT_ID::SQUISH_END:
+		if (registry.transforms.has(event.entity)) {
+			registry.transforms.get(event.entity).scale /= event.values[0];
 		}
-		};
+		break;
+	case TIMED_EVENT_ID::CHEST_WAVE_END: {
+		// the chest's wave of enemies is over
+		individual_spawn_interval = 1000.f; // revert spawn change
+		enemy_spawn_cooldown = 25000.f; // don't spawn for x seconds
+		printf("set cooldown\n");
+
+		// don't activate again for x seconds
+		TimedEvent rearm;
+		rearm.type = TIMED_EVENT_ID::CHEST_REARM;
+		rearm.entity = event.entity;
+		schedule_event(25000.f, rearm);
+		break;
+	}
+	case TIMED_EVENT_ID::CHEST_REARM:
+		if (registry.chests.has(event.entity)) {
+			printf("deactivating\n");
+			registry.chests.get(event.entity).waveActivated = false;
+		}
+		break;
+	case TIMED_EVENT_ID::EFFECT_END:
+		effects_system->end_effect(event);
+		break;
+	default:
+		assert(false && "Unknown timed event");
+		break;
+	}
+}
+
+void WorldSystem::resume_event(float delay_ms, TimedEvent event) {
+	switch (event.type) {
+	case TIMED_EVENT_ID::CAMERA_SHAKE_END:
+		registry.camera.components[0].shake += event.values[0];
+		break;
+	case TIMED_EVENT_ID::CHEST_WAVE_END:
+		individual_spawn_interval = 200.f;
+		break;
+	case TIMED_EVENT_ID::EFFECT_END:
+		effects_system->resume_effect(event);
+		break;
+	default:
+		break;
+	}
+	schedule_event(delay_ms, event);
 }
 
 void WorldSystem::show_hold_to_collect() {
@@ -1147,175 +1174,23 @@ void WorldSystem::show_hold_to_collect() {
 }
 
 // Compute collisions between entities
-void WorldSystem::resolve_collisions() {
-	// Loop over all collisions detected by the physics system
-	std::list<Entity> garbage{};
-	auto& collisionsRegistry = registry.collisions;
-	bool show_hold_guide = false;
-	for (uint i = 0; i < collisionsRegistry.components.size(); i++) {
-		// The entity and its collider
-		Entity entity = collisionsRegistry.entities[i];
-		Collision collision = collisionsRegistry.components[i];
-		Transform& transform = registry.transforms.get(entity);
-		Motion& motion = registry.motions.get(entity);
-		// When any moving object collides with the boundary, it gets bounced towards the 
-		// reflected direction (similar to the physics model of reflection of light)
-		if (collision.collision_type == COLLISION_TYPE::WITH_BOUNDARY) {
-			vec2 normal_vec = -normalize(transform.position);
-			// Only reflect when velocity is pointing out of the boundary to avoid being stuck
-			if (dot(motion.velocity, normal_vec) < 0) {
-				vec2 reflection = motion.velocity - 2 * dot(motion.velocity, normal_vec) * normal_vec;
-				// Gradually lose some momentum each collision
-				motion.velocity = 0.95f * reflection;
-				allow_accel = false;
-			}
-		}
-		else if (collision.collision_type == COLLISION_TYPE::PLAYER_WITH_REGION_BOUNDARY) {
-			motion.velocity = 0.95f * collision.knockback_dir;
-			allow_accel = false;
-		}
-		else if (collision.collision_type == COLLISION_TYPE::PLAYER_WITH_ENEMY
-			&& !registry.invincibility.has(entity)) {
-
-			if (!registry.collideEnemies.has(player)) continue;
-
-			registry.invincibility.emplace(entity);
-
-			// When player collides with enemy, only player gets knocked back,
-			// towards its relative direction from the enemy
-			Entity enemy_entity = collision.other_entity;
-			Transform& enemy_transform = registry.transforms.get(enemy_entity);
-			Motion& enemy_motion = registry.motions.get(enemy_entity);
-			vec2 knockback_direction = normalize(transform.position - enemy_transform.position);
-			motion.velocity = (enemy_motion.max_velocity + 1000) * knockback_direction;
-			allow_accel = false;
-
-			// Update player health
-			if (!DEBUG_MODE) {
-				Health& playerHealth = registry.healthValues.get(entity);
-				playerHealth.health -= 10.0;
-			}
-
-			shakeCamera(4.f, 200.f, 10.f, knockback_direction);
-			Mix_PlayChannel(chunkToChannel["player_hit"], soundChunks["player_hit"], 0);
-			squish(player, 0.96f);
-		}
-		else if (collision.collision_type == COLLISION_TYPE::PLAYER_WITH_CHEST) {
-			updateSpaceBarPressDuration();
-			Entity chestEntity = collision.other_entity;
-			Chest& chest = registry.chests.get(chestEntity);
-
-			if (!chest.isOpened && isHoldingSpace(100.0f)) {
-				enemy_spawn_cooldown = 1000.f; // lower cooldown set by step_chests()
-
-				chest.isOpened = true;
-				Entity abilityEntity = Entity();
-
-				// Grant the ability to the player
-				switch (chest.ability) {
-				case REGION_GOAL_ID::SWORD_ATTACK: {
-					registry.playerAbilities.insert(abilityEntity, { PLAYER_ABILITY_ID::SWORD });
-					createSword(renderer, player);
-					dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_SWORD, 1500.f);
-					if (controller_mode) {
-						dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_SWORD_CONTROLLER, 1000.f);
-					}
-					else {
-						dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_SWORD_MOUSE, 1000.f);
-					}
-					Mix_PlayChannel(chunkToChannel["sword_unlock"], soundChunks["sword_unlock"], 0);
-					std::cout << "Player received SWORD ability from chest." << std::endl;
-					break;
-				}
-				case REGION_GOAL_ID::MULTIPLE_BULLETS: {
-					registry.playerAbilities.insert(abilityEntity, { PLAYER_ABILITY_ID::BULLET_BOOST });
-					assert(registry.guns.has(player));
-					Gun& gun_component = registry.guns.get(player);
-					gun_component.attack_delay /= 2;
-					Entity gun_entity = getAttachment(player, ATTACHMENT_ID::GUN);
-					assert(registry.colors.has(gun_entity));
-					vec4& gun_color = registry.colors.get(gun_entity);
-					gun_color.g = 0.5f;
-					gun_color.b = 0.5f;
-					assert(registry.attachments.has(gun_entity));
-					Attachment& att = registry.attachments.get(gun_entity);	// This is a quick workaround
-					att.relative_transform_2.scale({ 1.5f, 1.5f });
-					dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_BULLETBOOST, 1500.f);
-					Mix_PlayChannel(chunkToChannel["bullet_unlock"], soundChunks["bullet_unlock"], 0);
-					std::cout << "Player received BULLET_BOOST ability from chest." << std::endl;
-					break;
-				}
-				case REGION_GOAL_ID::HEALTH_BOOST: {
-					registry.playerAbilities.insert(abilityEntity, { PLAYER_ABILITY_ID::HEALTH_BOOST });
-					Health& health = registry.healthValues.get(player);
-					assert(registry.renderRequests.has(healthbar_frame));
-					registry.renderRequests.get(healthbar_frame).used_texture = TEXTURE_ASSET_ID::HEALTHBAR_FRAME_BOOST;
-					assert(registry.healthbar.has(healthbar));
-					registry.healthbar.get(healthbar).full_health_color = { 0.f, 1.f, 1.f, 1.f };
-					dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_HEALTHBOOST, 1500.f);
-					health.healthMultiplier = 2.0f; // Double the health multiplier
-					health.maxHealth *= health.healthMultiplier; // Update maximum health
-					health.health = health.maxHealth; // Set current health to max
-					health.healthIncrement = 1.0f; // Set health increment, e.g., 1 health point per second
-					Mix_PlayChannel(chunkToChannel["health_unlock"], soundChunks["health_unlock"], 0);
-					std::cout << "Player received HEALTH_BOOST ability from chest." << std::endl;
-					break;
-				}
-				case REGION_GOAL_ID::DASH: {
-					registry.playerAbilities.insert(abilityEntity, { PLAYER_ABILITY_ID::DASHING });
-					createDashing(player);
-					dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_DASHING, 1500.f);
-					if (controller_mode) {
-						dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_DASHING_CONTROLLER, 1000.f);
-					}
-					else {
-						dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_DASHING_KEYBOARD, 1000.f);
-					}
-					Mix_PlayChannel(chunkToChannel["dash_unlock"], soundChunks["dash_unlock"], 0);
-					std::cout << "Player received DASHING ability from chest." << std::endl;
-					break;
-				}
-				default:
-					std::cout << "Unknown ability. Error." << std::endl;
-				}
-
-				for (auto& region : registry.regions.components) {
-					if (region.goal == chest.ability) {
-						region.is_cleared = true;
-					}
-				}
-
-				garbage.push_back(chestEntity);
-			}
-			else if (!chest.isOpened) {
-				show_hold_guide = true;
-			}
-		}
-		else if (collision.collision_type == COLLISION_TYPE::PLAYER_WITH_CURE) {
-			Entity cureEntity = collision.other_entity;
-			registry.game.get(game_entity).isCureObtained = true;
-
-			for (Region& region : registry.regions.components) {
-				if (region.goal == REGION_GOAL_ID::CURE) {
-					region.is_cleared = true;
-				}
-				else if (region.goal == REGION_GOAL_ID::CANCER_CELL) {
-					Entity secondBoss = createSecondBoss(renderer, region.interest_point);
-					createWaypoint(region.goal, secondBoss);
-				}
-			}
-
-			garbage.push_back(cureEntity);
-		}
-		else if (collision.collision_type == COLLISION_TYPE::BULLET_WITH_ENEMY) {
+void WorldSystem::resolve_projectile_hits() {
+	ProjectilePool& projectiles = registry.projectiles;
+	for (const ProjectileHit& hit : projectiles.hits) {
+		// A bullet may already have been used up by an earlier hit this step
+		if (!projectiles.is_alive(hit.projectile)) continue;
+		vec2 bullet_position = projectiles.positions[hit.projectile];
+		float damage = projectiles.damages[hit.projectile];
+
+		if (hit.type == COLLISION_TYPE::BULLET_WITH_ENEMY) {
 			// When bullet collides with enemy, only enemy gets knocked back,
 			// towards its relative direction from the enemy
-			Entity enemy_entity = collision.other_entity;
+			Entity enemy_entity = hit.target;
 			Enemy& enemyAttrib = registry.enemies.get(enemy_entity);
 			if (enemyAttrib.type != ENEMY_ID::BOSS) {
 				Transform& enemy_transform = registry.transforms.get(enemy_entity);
 				Motion& enemy_motion = registry.motions.get(enemy_entity);
-				vec2 knockback_direction = normalize(enemy_transform.position - transform.position);
+				vec2 knockback_direction = normalize(enemy_transform.position - bullet_position);
 				enemy_motion.velocity = enemy_motion.max_velocity * knockback_direction;
 				enemy_motion.allow_accel = false;
 				squish(enemy_entity, 0.95f);
@@ -1323,98 +1198,24 @@ void WorldSystem::resolve_collisions() {
 
 			// Deal damage to enemy
 			Health& enemyHealth = registry.healthValues.get(enemy_entity);
-			enemyHealth.health -= registry.projectiles.get(entity).damage;
+			enemyHealth.health -= damage;
 
 			Mix_PlayChannel(chunkToChannel["enemy_hit"], soundChunks["enemy_hit"], 0);
 
-			garbage.push_back(entity);
-
+			projectiles.kill(hit.projectile);
 		}
-		else if (collision.collision_type == COLLISION_TYPE::BULLET_WITH_CYST) {
-			Entity cyst = collision.other_entity;
+		else if (hit.type == COLLISION_TYPE::BULLET_WITH_CYST) {
+			Entity cyst = hit.target;
 
 			// Deal damage to enemy
 			Health& health = registry.healthValues.get(cyst);
-			health.health -= registry.projectiles.get(entity).damage;
+			health.health -= damage;
 
 			Mix_PlayChannel(chunkToChannel["enemy_hit"], soundChunks["enemy_hit"], 0);
 			squish(cyst, 0.9f);
-			garbage.push_back(entity);
-		}
-		else if (collision.collision_type == COLLISION_TYPE::SWORD_WITH_ENEMY) {
-			assert(registry.attachments.has(entity));
-			Entity sword_holder = registry.attachments.get(entity).parent;
-			assert(registry.melees.has(sword_holder));
-			Entity enemy_entity = collision.other_entity;
-			Enemy& enemyAttrib = registry.enemies.get(enemy_entity);
-			if (enemyAttrib.sword_attack_cd <= 0.f) {
-				Transform& enemy_transform = registry.transforms.get(enemy_entity);
-				Motion& enemy_motion = registry.motions.get(enemy_entity);
-				vec2 knockback_direction = normalize(enemy_transform.position - transform.position);
-				// No knockback on boss
-				if (enemyAttrib.type != ENEMY_ID::BOSS) {
-					if (registry.melees.get(sword_holder).animation_timer > 0.f) {
-						enemy_motion.velocity = enemy_motion.max_velocity * knockback_direction;
-					}
-					else {
-						// Less knockback when sword is not slashing
-						enemy_motion.velocity = enemy_motion.max_velocity / 2.f * knockback_direction;
-					}
-					squish(enemy_entity, 0.95f);
-				}
-				enemy_motion.allow_accel = false;
-
-				// Deal damage to enemy
-				Health& enemyHealth = registry.healthValues.get(enemy_entity);
-				if (registry.melees.get(sword_holder).animation_timer > 0.f) {
-					enemyHealth.health -= registry.melees.get(sword_holder).damage;
-				}
-				else {
-					// Deal less damage when sword is not slashing
-					enemyHealth.health -= registry.melees.get(sword_holder).damage / 4.f;
-				}
-
-				// Give enemy invincibility to sword for a moment after taking an attack
-				enemyAttrib.sword_attack_cd = 500.f;
-
-				Mix_PlayChannel(chunkToChannel["enemy_hit"], soundChunks["enemy_hit"], 0);
-			}
-
-		}
-		else if (collision.collision_type == COLLISION_TYPE::SWORD_WITH_CYST) {
-			assert(registry.attachments.has(entity));
-			Entity sword_holder = registry.attachments.get(entity).parent;
-			assert(registry.melees.has(sword_holder));
-
-			Entity cyst = collision.other_entity;
-			Cyst& cyst_attrib = registry.cysts.get(cyst);
-
-			if (cyst_attrib.sword_attack_cd <= 0.f) {
-				// Deal damage to cyst
-				Health& health = registry.healthValues.get(cyst);
-				if (registry.melees.get(sword_holder).animation_timer > 0.f) {
-					health.health -= registry.melees.get(sword_holder).damage;
-				}
-				else {
-					health.health -= registry.melees.get(sword_holder).damage / 8.f;
-				}
-
-				// Give cyst invincibility to sword for a moment after taking an attack
-				cyst_attrib.sword_attack_cd = 500.f;
-				squish(cyst, 0.9f);
-
-				Mix_PlayChannel(chunkToChannel["enemy_hit"], soundChunks["enemy_hit"], 0);
-			}
-		}
-		else if (collision.collision_type == COLLISION_TYPE::PLAYER_WITH_CYST
-			&& !registry.invincibility.has(entity)) {
-			Entity cyst = collision.other_entity;
-			Transform& cyst_transform = registry.transforms.get(cyst);
-			vec2 knockback_direction = normalize(transform.position - cyst_transform.position);
-			motion.velocity = 150.f * knockback_direction;
-			allow_accel = false;
+			projectiles.kill(hit.projectile);
 		}
-		else if (collision.collision_type == COLLISION_TYPE::BULLET_WITH_PLAYER
+		else if (hit.type == COLLISION_TYPE::BULLET_WITH_PLAYER
 			&& !registry.invincibility.has(player)) {
 
 			if (!registry.collideEnemies.has(player)) continue;
@@ -1423,36 +1224,312 @@ void WorldSystem::resolve_collisions() {
 
 			Transform& player_transform = registry.transforms.get(player);
 			Motion& player_motion = registry.motions.get(player);
-			vec2 knockback_direction = normalize(player_transform.position - transform.position);
+			vec2 knockback_direction = normalize(player_transform.position - bullet_position);
 
-			player_motion.velocity = (motion.max_velocity + 1000) * knockback_direction;
+			player_motion.velocity = PROJECTILE_KNOCKBACK_VELOCITY * knockback_direction;
 			allow_accel = false;
 
 			// Deal damage to player
 			Health& playerHealth = registry.healthValues.get(player);
-			playerHealth.health -= registry.projectiles.get(entity).damage;
+			playerHealth.health -= damage;
 			shakeCamera(3.f, 150.f, 3.f, knockback_direction);
 			Mix_PlayChannel(chunkToChannel["player_hit"], soundChunks["player_hit"], 0);
 			squish(player, 0.96f);
 
-			garbage.push_back(entity);
-		}
-		else if (collision.collision_type == COLLISION_TYPE::BULLET_WITH_BOUNDARY) {
-			garbage.push_back(entity);
+			projectiles.kill(hit.projectile);
 		}
 	}
+	projectiles.hits.clear();
+}
+
+void WorldSystem::resolve_collisions() {
+	resolve_projectile_hits();
+
+	// Hand all collisions detected by the physics system to the handlers below, one batch per type
+	show_hold_guide = false;
+	registry.collisionEvents.dispatch();
+	step_chest_pickup();
+
 	if (show_hold_guide) {
 		show_hold_to_collect();
 	}
 	else {
 		registry.colors.get(hold_to_collect).a = 0.f;
 	}
-	for (Entity i : garbage) {
+	for (Entity i : collision_garbage) {
 		registry.remove_all_components_of(i);
 	}
+	collision_garbage.clear();
+}
+
+void WorldSystem::subscribe_collision_handlers() {
+	CollisionEventBus& bus = registry.collisionEvents;
+	bus.subscribe(COLLISION_TYPE::WITH_BOUNDARY, [this](const std::vector<CollisionEvent>& events) { on_boundary_collisions(events); });
+	bus.subscribe(COLLISION_TYPE::PLAYER_WITH_ENEMY, [this](const std::vector<CollisionEvent>& events) { on_player_enemy_collisions(events); });
+	bus.subscribe(COLLISION_TYPE::PLAYER_WITH_CYST, [this](const std::vector<CollisionEvent>& events) { on_player_cyst_collisions(events); });
+	// Chests are opened by holding interact while touching them, see step_chest_pickup
+	bus.subscribe(COLLISION_TYPE::PLAYER_WITH_CURE, [this](const std::vector<CollisionEvent>& events) { on_player_cure_collisions(events); });
+	bus.subscribe(COLLISION_TYPE::PLAYER_WITH_REGION_BOUNDARY, [this](const std::vector<CollisionEvent>& events) { on_region_boundary_collisions(events); });
+	// Hits skipped for a cooldown or invincibility come again when it ends, see step_invincibility
+	bus.subscribe(COLLISION_TYPE::SWORD_WITH_ENEMY, [this](const std::vector<CollisionEvent>& events) { on_sword_enemy_collisions(events); });
+	bus.subscribe(COLLISION_TYPE::SWORD_WITH_CYST, [this](const std::vector<CollisionEvent>& events) { on_sword_cyst_collisions(events); });
+}
+
+// When any moving object collides with the boundary, it gets bounced towards the 
+// reflected direction (similar to the physics model of reflection of light)
+void WorldSystem::on_boundary_collisions(const std::vector<CollisionEvent>& events) {
+	for (const CollisionEvent& collision : events) {
+		Entity entity = collision.entity;
+		Transform& transform = registry.transforms.get(entity);
+		Motion& motion = registry.motions.get(entity);
+		// Only reported while moving out of the boundary, reflecting never leaves the body stuck
+		vec2 normal_vec = -normalize(transform.position);
+		vec2 reflection = motion.velocity - 2 * dot(motion.velocity, normal_vec) * normal_vec;
+		// Gradually lose some momentum each collision
+		motion.velocity = 0.95f * reflection;
+		allow_accel = false;
+	}
+}
 
-	// Remove all collisions from this simulation step
-	registry.collisions.clear();
+void WorldSystem::on_region_boundary_collisions(const std::vector<CollisionEvent>& events) {
+	for (const CollisionEvent& collision : events) {
+		Motion& motion = registry.motions.get(collision.entity);
+		motion.velocity = 0.95f * collision.knockback_dir;
+		allow_accel = false;
+	}
+}
+
+void WorldSystem::on_player_enemy_collisions(const std::vector<CollisionEvent>& events) {
+	for (const CollisionEvent& collision : events) {
+		Entity entity = collision.entity;
+		if (registry.invincibility.has(entity)) continue;
+		if (!registry.collideEnemies.has(player)) continue;
+
+		registry.invincibility.emplace(entity);
+
+		// When player collides with enemy, only player gets knocked back,
+		// towards its relative direction from the enemy
+		Entity enemy_entity = collision.other_entity;
+		Transform& transform = registry.transforms.get(entity);
+		Motion& motion = registry.motions.get(entity);
+		Transform& enemy_transform = registry.transforms.get(enemy_entity);
+		Motion& enemy_motion = registry.motions.get(enemy_entity);
+		vec2 knockback_direction = normalize(transform.position - enemy_transform.position);
+		motion.velocity = (enemy_motion.max_velocity + 1000) * knockback_direction;
+		allow_accel = false;
+
+		// Update player health
+		if (!DEBUG_MODE) {
+			Health& playerHealth = registry.healthValues.get(entity);
+			playerHealth.health -= 10.0;
+		}
+
+		shakeCamera(4.f, 200.f, 10.f, knockback_direction);
+		Mix_PlayChannel(chunkToChannel["player_hit"], soundChunks["player_hit"], 0);
+		squish(player, 0.96f);
+	}
+}
+
+void WorldSystem::step_chest_pickup() {
+	for (Entity chestEntity : registry.chests.entities) {
+		if (!registry.contacts.touching(player, chestEntity)) continue;
+		updateSpaceBarPressDuration(input, spaceBarPressDuration);
+		Chest& chest = registry.chests.get(chestEntity);
+
+		if (!chest.isOpened && isHoldingSpace(spaceBarPressDuration, 100.0f)) {
+			enemy_spawn_cooldown = 1000.f; // lower cooldown set by step_chests()
+
+			chest.isOpened = true;
+			Entity abilityEntity = registry.create_entity();
+
+			// Grant the ability to the player
+			switch (chest.ability) {
+			case REGION_GOAL_ID::SWORD_ATTACK: {
+				registry.playerAbilities.insert(abilityEntity, { PLAYER_ABILITY_ID::SWORD });
+				createSword(registry, renderer, player);
+				dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_SWORD, 1500.f);
+				if (controller_mode) {
+					dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_SWORD_CONTROLLER, 1000.f);
+				}
+				else {
+					dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_SWORD_MOUSE, 1000.f);
+				}
+				Mix_PlayChannel(chunkToChannel["sword_unlock"], soundChunks["sword_unlock"], 0);
+				std::cout << "Player received SWORD ability from chest." << std::endl;
+				break;
+			}
+			case REGION_GOAL_ID::MULTIPLE_BULLETS: {
+				registry.playerAbilities.insert(abilityEntity, { PLAYER_ABILITY_ID::BULLET_BOOST });
+				assert(registry.guns.has(player));
+				Gun& gun_component = registry.guns.get(player);
+				gun_component.attack_delay /= 2;
+				Entity gun_entity = getAttachment(player, ATTACHMENT_ID::GUN);
+				assert(registry.colors.has(gun_entity));
+				vec4& gun_color = registry.colors.get(gun_entity);
+				gun_color.g = 0.5f;
+				gun_color.b = 0.5f;
+				assert(registry.attachments.has(gun_entity));
+				Attachment& att = registry.attachments.get(gun_entity);	// This is a quick workaround
+				att.relative_transform_2.scale({ 1.5f, 1.5f });
+				dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_BULLETBOOST, 1500.f);
+				Mix_PlayChannel(chunkToChannel["bullet_unlock"], soundChunks["bullet_unlock"], 0);
+				std::cout << "Player received BULLET_BOOST ability from chest." << std::endl;
+				break;
+			}
+			case REGION_GOAL_ID::HEALTH_BOOST: {
+				registry.playerAbilities.insert(abilityEntity, { PLAYER_ABILITY_ID::HEALTH_BOOST });
+				Health& health = registry.healthValues.get(player);
+				assert(registry.renderRequests.has(healthbar_frame));
+				registry.renderRequests.get(healthbar_frame).used_texture = TEXTURE_ASSET_ID::HEALTHBAR_FRAME_BOOST;
+				assert(registry.healthbar.has(healthbar));
+				registry.healthbar.get(healthbar).full_health_color = { 0.f, 1.f, 1.f, 1.f };
+				dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_HEALTHBOOST, 1500.f);
+				health.healthMultiplier = 2.0f; // Double the health multiplier
+				health.maxHealth *= health.healthMultiplier; // Update maximum health
+				health.health = health.maxHealth; // Set current health to max
+				health.healthIncrement = 1.0f; // Set health increment, e.g., 1 health point per second
+				Mix_PlayChannel(chunkToChannel["health_unlock"], soundChunks["health_unlock"], 0);
+				std::cout << "Player received HEALTH_BOOST ability from chest." << std::endl;
+				break;
+			}
+			case REGION_GOAL_ID::DASH: {
+				registry.playerAbilities.insert(abilityEntity, { PLAYER_ABILITY_ID::DASHING });
+				createDashing(registry, player);
+				dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_DASHING, 1500.f);
+				if (controller_mode) {
+					dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_DASHING_CONTROLLER, 1000.f);
+				}
+				else {
+					dialog_system->add_dialog(TEXTURE_ASSET_ID::TUTORIAL_UNLOCK_DASHING_KEYBOARD, 1000.f);
+				}
+				Mix_PlayChannel(chunkToChannel["dash_unlock"], soundChunks["dash_unlock"], 0);
+				std::cout << "Player received DASHING ability from chest." << std::endl;
+				break;
+			}
+			default:
+				std::cout << "Unknown ability. Error." << std::endl;
+			}
+
+			for (auto& region : registry.regions.components) {
+				if (region.goal == chest.ability) {
+					region.is_cleared = true;
+				}
+			}
+
+			collision_garbage.push_back(chestEntity);
+		}
+		else if (!chest.isOpened) {
+			show_hold_guide = true;
+		}
+	}
+}
+
+void WorldSystem::on_player_cure_collisions(const std::vector<CollisionEvent>& events) {
+	for (const CollisionEvent& collision : events) {
+		Entity cureEntity = collision.other_entity;
+		registry.game.get(game_entity).isCureObtained = true;
+
+		for (Region& region : registry.regions.components) {
+			if (region.goal == REGION_GOAL_ID::CURE) {
+				region.is_cleared = true;
+			}
+			else if (region.goal == REGION_GOAL_ID::CANCER_CELL) {
+				Entity secondBoss = createSecondBoss(registry, renderer, region.interest_point);
+				createWaypoint(registry, region.goal, secondBoss);
+			}
+		}
+
+		collision_garbage.push_back(cureEntity);
+	}
+}
+
+void WorldSystem::on_sword_enemy_collisions(const std::vector<CollisionEvent>& events) {
+	for (const CollisionEvent& collision : events) {
+		Entity entity = collision.entity;
+		assert(registry.attachments.has(entity));
+		Entity sword_holder = registry.attachments.get(entity).parent;
+		assert(registry.melees.has(sword_holder));
+		Entity enemy_entity = collision.other_entity;
+		Enemy& enemyAttrib = registry.enemies.get(enemy_entity);
+		if (enemyAttrib.sword_attack_cd <= 0.f) {
+			Transform& transform = registry.transforms.get(entity);
+			Transform& enemy_transform = registry.transforms.get(enemy_entity);
+			Motion& enemy_motion = registry.motions.get(enemy_entity);
+			vec2 knockback_direction = normalize(enemy_transform.position - transform.position);
+			// No knockback on boss
+			if (enemyAttrib.type != ENEMY_ID::BOSS) {
+				if (registry.melees.get(sword_holder).animation_timer > 0.f) {
+					enemy_motion.velocity = enemy_motion.max_velocity * knockback_direction;
+				}
+				else {
+					// Less knockback when sword is not slashing
+					enemy_motion.velocity = enemy_motion.max_velocity / 2.f * knockback_direction;
+				}
+				squish(enemy_entity, 0.95f);
+			}
+			enemy_motion.allow_accel = false;
+
+			// Deal damage to enemy
+			Health& enemyHealth = registry.healthValues.get(enemy_entity);
+			if (registry.melees.get(sword_holder).animation_timer > 0.f) {
+				enemyHealth.health -= registry.melees.get(sword_holder).damage;
+			}
+			else {
+				// Deal less damage when sword is not slashing
+				enemyHealth.health -= registry.melees.get(sword_holder).damage / 4.f;
+			}
+
+			// Give enemy invincibility to sword for a moment after taking an attack
+			enemyAttrib.sword_attack_cd = 500.f;
+
+			Mix_PlayChannel(chunkToChannel["enemy_hit"], soundChunks["enemy_hit"], 0);
+		}
+	}
+}
+
+void WorldSystem::on_sword_cyst_collisions(const std::vector<CollisionEvent>& events) {
+	for (const CollisionEvent& collision : events) {
+		Entity entity = collision.entity;
+		assert(registry.attachments.has(entity));
+		Entity sword_holder = registry.attachments.get(entity).parent;
+		assert(registry.melees.has(sword_holder));
+
+		Entity cyst = collision.other_entity;
+		Cyst& cyst_attrib = registry.cysts.get(cyst);
+
+		if (cyst_attrib.sword_attack_cd <= 0.f) {
+			// Deal damage to cyst
+			Health& health = registry.healthValues.get(cyst);
+			if (registry.melees.get(sword_holder).animation_timer > 0.f) {
+				health.health -= registry.melees.get(sword_holder).damage;
+			}
+			else {
+				health.health -= registry.melees.get(sword_holder).damage / 8.f;
+			}
+
+			// Give cyst invincibility to sword for a moment after taking an attack
+			cyst_attrib.sword_attack_cd = 500.f;
+			squish(cyst, 0.9f);
+
+			Mix_PlayChannel(chunkToChannel["enemy_hit"], soundChunks["enemy_hit"], 0);
+		}
+	}
+}
+
+void WorldSystem::on_player_cyst_collisions(const std::vector<CollisionEvent>& events) {
+	for (const CollisionEvent& collision : events) {
+		Entity entity = collision.entity;
+		if (registry.invincibility.has(entity)) continue;
+		Entity cyst = collision.other_entity;
+		Transform& transform = registry.transforms.get(entity);
+		Motion& motion = registry.motions.get(entity);
+		Transform& cyst_transform = registry.transforms.get(cyst);
+		vec2 knockback_direction = normalize(transform.position - cyst_transform.position);
+		motion.velocity = 150.f * knockback_direction;
+		allow_accel = false;
+		// Cysts are solid, the push goes on until the player is out
+		registry.contacts.rearm(entity, cyst);
+	}
 }
 
 
@@ -1474,29 +1551,7 @@ void WorldSystem::on_key(int key, int, int action, int mod) {
 		}
 	}
 
-	if (action == GLFW_PRESS && key == GLFW_MOUSE_BUTTON_LEFT) {
-		if (state == GAME_STATE::PAUSE_MENU || state == GAME_STATE::START_MENU) {
-			menu_system->recent_click_coord = mouse;
-			printf("click at %f, %f\n", mouse.x, mouse.y);
-		}
-	}
-
-	if (key == GLFW_KEY_SPACE) {
-		if (action == GLFW_PRESS) {
-			keys_pressed[key] = 1;
-			spaceBarPressDuration = 0.0f; // Reset duration on new press
-		}
-		else if (action == GLFW_RELEASE) {
-			keys_pressed[key] = 0;
-		}
-	}
-
-	if (action == GLFW_PRESS) {
-		keys_pressed[key] = 1;
-	}
-	if (action == GLFW_RELEASE) {
-		keys_pressed[key] = 0;
-	}
+	input.on_key(key, action);
 	// Debugging
 	if (key == GLFW_KEY_F) {
 		if (action == GLFW_RELEASE)
@@ -1517,6 +1572,50 @@ void WorldSystem::on_key(int key, int, int action, int mod) {
 	current_speed = fmax(0.f, current_speed);
 }
 
+void WorldSystem::handle_input_event(const InputEvent& event) {
+	if (recorder != nullptr) recorder->write(event);
+
+	switch (event.type) {
+	case INPUT_EVENT_TYPE::KEY:
+		on_key(event.code, 0, event.action, event.mods);
+		break;
+	case INPUT_EVENT_TYPE::MOUSE_BUTTON:
+		on_mouse_button(event.code, event.action, event.mods);
+		break;
+	case INPUT_EVENT_TYPE::CURSOR:
+		on_mouse_move(event.cursor);
+		break;
+	case INPUT_EVENT_TYPE::GAMEPAD:
+		input.set_gamepad(event.gamepad);
+		break;
+	default:
+		// END_TICK only marks the tick boundary in recordings
+		break;
+	}
+}
+
+void WorldSystem::on_glfw_input(const InputEvent& event) {
+	if (live_input) handle_input_event(event);
+}
+
+void WorldSystem::poll_gamepad() {
+	GamepadState gamepad = GamepadState::poll();
+	if (gamepad != input.gamepad()) {
+		handle_input_event(InputEvent::gamepad_change(gamepad));
+	}
+}
+
+void WorldSystem::on_mouse_button(int button, int action, int) {
+	input.on_mouse_button(button, action);
+
+	if (action == GLFW_PRESS && button == GLFW_MOUSE_BUTTON_LEFT) {
+		if (state == GAME_STATE::PAUSE_MENU || state == GAME_STATE::START_MENU) {
+			menu_system->recent_click_coord = mouse;
+			printf("click at %f, %f\n", mouse.x, mouse.y);
+		}
+	}
+}
+
 void WorldSystem::on_mouse_move(vec2 pos) {
 	vec2 mouseScreenCoord = vec2(pos.x - CONTENT_WIDTH_PX / 2, CONTENT_HEIGHT_PX / 2 - pos.y);
 	Transform player_transform = registry.transforms.get(player);
@@ -1530,7 +1629,7 @@ void WorldSystem::on_mouse_move(vec2 pos) {
 	registry.transforms.get(cursor).position = cursor_position;
 
 	// hide cursor if on top of player
-	vec2 mouseWorldCoord = vec2(inverse(renderer->createViewMatrix()) * vec3(cursor_position, 1.0));
+	vec2 mouseWorldCoord = frame->to_world(cursor_position);
 	if (distance(mouseWorldCoord, player_transform.position) < 70) {
 		registry.colors.get(cursor).a = 0.f;
 	}
@@ -1542,37 +1641,19 @@ void WorldSystem::on_mouse_move(vec2 pos) {
 	mouse = mouseScreenCoord;
 }
 
-void axesupdate() {
-	int axesCount;
-	const float* axes = glfwGetJoystickAxes(GLFW_JOYSTICK_1, &axesCount);
-	axes_state[0] = axes[0];
-	axes_state[1] = axes[1];
-	axes_state[2] = axes[2];
-	axes_state[3] = axes[3];
-	axes_state[4] = axes[4];
-	axes_state[5] = axes[5];
-
-}
-
 void WorldSystem::menu_controller(float elapsed_ms_since_last_update) {
-	int present = glfwJoystickPresent(GLFW_JOYSTICK_1);
-
-	if (present) {
+	if (input.gamepad_present()) {
 		menu_timer -= elapsed_ms_since_last_update;
 		if (menu_timer > 0) {
 			return;
 		}
 		menu_timer = 150;
 
-		axesupdate();
-		int count;
-		const unsigned char* buttons = glfwGetJoystickButtons(GLFW_JOYSTICK_1, &count);
-		controller_buttons = buttons;
 
 
 
 		if (state == GAME_STATE::START_MENU && button_select == BUTTON_SELECT::NONE) {
-			if (axes_state[1] > 0.3 || axes_state[1] < -0.3 || buttons[15] || buttons[17]) {
+			if (input.axis(1) > 0.3 || input.axis(1) < -0.3 || input.gamepad_button(15) || input.gamepad_button(17)) {
 				button_select = BUTTON_SELECT::START;
 				mouse = { 0,40 };
 			}
@@ -1580,19 +1661,19 @@ void WorldSystem::menu_controller(float elapsed_ms_since_last_update) {
 		}
 		else if (state == GAME_STATE::START_MENU && button_select == BUTTON_SELECT::START) {
 
-			if (axes_state[1] > 0.3 || buttons[17]) {
+			if (input.axis(1) > 0.3 || input.gamepad_button(17)) {
 				button_select = BUTTON_SELECT::LOAD;
 				mouse = { 0,-150 };
 
 			}
 
-			if (axes_state[1] < -0.3 || buttons[15]) {
+			if (input.axis(1) < -0.3 || input.gamepad_button(15)) {
 				button_select = BUTTON_SELECT::EXIT;
 				mouse = { 0,-350 };
 
 			}
 
-			if (axes_state[0] < -0.3 || buttons[18]) {
+			if (input.axis(0) < -0.3 || input.gamepad_button(18)) {
 				button_select = BUTTON_SELECT::EASY_MODE;
 				mouse = { -550, -150 };
 			}
@@ -1600,18 +1681,18 @@ void WorldSystem::menu_controller(float elapsed_ms_since_last_update) {
 		}
 		else if (state == GAME_STATE::START_MENU && button_select == BUTTON_SELECT::LOAD) {
 
-			if (axes_state[1] > 0.3 || buttons[17]) {
+			if (input.axis(1) > 0.3 || input.gamepad_button(17)) {
 				button_select = BUTTON_SELECT::EXIT;
 				mouse = { 0,-350 };
 
 			}
 
-			if (axes_state[1] < -0.3 || buttons[15]) {
+			if (input.axis(1) < -0.3 || input.gamepad_button(15)) {
 				button_select = BUTTON_SELECT::START;
 				mouse = { 0,50 };
 
 			}
-			if (axes_state[0] < -0.3 || buttons[18]) {
+			if (input.axis(0) < -0.3 || input.gamepad_button(18)) {
 				button_select = BUTTON_SELECT::EASY_MODE;
 				mouse = { -550, -150 };
 			}
@@ -1620,18 +1701,18 @@ void WorldSystem::menu_controller(float elapsed_ms_since_last_update) {
 		}
 		else if (state == GAME_STATE::START_MENU && button_select == BUTTON_SELECT::EXIT) {
 
-			if (axes_state[1] > 0.3 || buttons[17]) {
+			if (input.axis(1) > 0.3 || input.gamepad_button(17)) {
 				button_select = BUTTON_SELECT::START;
 				mouse = { 0,50 };
 
 			}
 
-			if (axes_state[1] < -0.3 || buttons[15]) {
+			if (input.axis(1) < -0.3 || input.gamepad_button(15)) {
 				button_select = BUTTON_SELECT::LOAD;
 				mouse = { 0,-150 };
 
 			}
-			if (axes_state[0] < -0.3 || buttons[18]) {
+			if (input.axis(0) < -0.3 || input.gamepad_button(18)) {
 				button_select = BUTTON_SELECT::HARD_MODE;
 				mouse = { -540, -350 };
 			}
@@ -1641,56 +1722,56 @@ void WorldSystem::menu_controller(float elapsed_ms_since_last_update) {
 
 		else if (state == GAME_STATE::START_MENU && button_select == BUTTON_SELECT::EASY_MODE) {
 
-			if (axes_state[1] > 0.3 || buttons[17]) {
+			if (input.axis(1) > 0.3 || input.gamepad_button(17)) {
 				button_select = BUTTON_SELECT::HARD_MODE;
 				mouse = { -540, -350 };
 
 			}
 
-			if (axes_state[1] < -0.3 || buttons[15]) {
+			if (input.axis(1) < -0.3 || input.gamepad_button(15)) {
 				button_select = BUTTON_SELECT::HARD_MODE;
 				mouse = { -540, -350 };
 
 			}
-			if (axes_state[0] > 0.3 || buttons[16]) {
+			if (input.axis(0) > 0.3 || input.gamepad_button(16)) {
 				button_select = BUTTON_SELECT::LOAD;
 				mouse = { 0,-150 };
 			}
 		}
 		else if (state == GAME_STATE::START_MENU && button_select == BUTTON_SELECT::HARD_MODE) {
 
-			if (axes_state[1] > 0.3 || buttons[17]) {
+			if (input.axis(1) > 0.3 || input.gamepad_button(17)) {
 				button_select = BUTTON_SELECT::EASY_MODE;
 				mouse = { -550, -150 };
 
 			}
 
-			if (axes_state[1] < -0.3 || buttons[15]) {
+			if (input.axis(1) < -0.3 || input.gamepad_button(15)) {
 				button_select = BUTTON_SELECT::EASY_MODE;
 				mouse = { -550, -150 };
 
 			}
-			if (axes_state[0] > 0.3 || buttons[16]) {
+			if (input.axis(0) > 0.3 || input.gamepad_button(16)) {
 				button_select = BUTTON_SELECT::EXIT;
 				mouse = { 0,-350 };
 			}
 		}
 
 		else if (state == GAME_STATE::PAUSE_MENU && button_select == BUTTON_SELECT::NONE) {
-			if (axes_state[1] > 0.3 || axes_state[1] < -0.3 || buttons[17] || buttons[15]) {
+			if (input.axis(1) > 0.3 || input.axis(1) < -0.3 || input.gamepad_button(17) || input.gamepad_button(15)) {
 				button_select = BUTTON_SELECT::RESUME;
 				mouse = { 0,200 };
 			}
 
 		}
 		else if (state == GAME_STATE::PAUSE_MENU && button_select == BUTTON_SELECT::RESUME) {
-			if (axes_state[1] > 0.3 || buttons[17]) {
+			if (input.axis(1) > 0.3 || input.gamepad_button(17)) {
 				button_select = BUTTON_SELECT::SAVE;
 				mouse = { 0,0 };
 
 			}
 
-			if (axes_state[1] < -0.3 || buttons[15]) {
+			if (input.axis(1) < -0.3 || input.gamepad_button(15)) {
 				button_select = BUTTON_SELECT::EXIT_CURR_PLAY;
 				mouse = { 0,-400 };
 
@@ -1700,13 +1781,13 @@ void WorldSystem::menu_controller(float elapsed_ms_since_last_update) {
 
 		}
 		else if (state == GAME_STATE::PAUSE_MENU && button_select == BUTTON_SELECT::SAVE) {
-			if (axes_state[1] > 0.3 || buttons[17]) {
+			if (input.axis(1) > 0.3 || input.gamepad_button(17)) {
 				button_select = BUTTON_SELECT::MUTE;
 				mouse = { 0,-200 };
 
 			}
 
-			if (axes_state[1] < -0.3 || buttons[15]) {
+			if (input.axis(1) < -0.3 || input.gamepad_button(15)) {
 				button_select = BUTTON_SELECT::RESUME;
 				mouse = { 0,200 };
 
@@ -1714,13 +1795,13 @@ void WorldSystem::menu_controller(float elapsed_ms_since_last_update) {
 
 		}
 		else if (state == GAME_STATE::PAUSE_MENU && button_select == BUTTON_SELECT::MUTE) {
-			if (axes_state[1] > 0.3 || buttons[17]) {
+			if (input.axis(1) > 0.3 || input.gamepad_button(17)) {
 				button_select = BUTTON_SELECT::EXIT_CURR_PLAY;
 				mouse = { 0,-400 };
 
 			}
 
-			if (axes_state[1] < -0.3 || buttons[15]) {
+			if (input.axis(1) < -0.3 || input.gamepad_button(15)) {
 				button_select = BUTTON_SELECT::SAVE;
 				mouse = { 0,0 };
 
@@ -1728,13 +1809,13 @@ void WorldSystem::menu_controller(float elapsed_ms_since_last_update) {
 
 		}
 		else if (state == GAME_STATE::PAUSE_MENU && button_select == BUTTON_SELECT::EXIT_CURR_PLAY) {
-			if (axes_state[1] > 0.3 || buttons[17]) {
+			if (input.axis(1) > 0.3 || input.gamepad_button(17)) {
 				button_select = BUTTON_SELECT::RESUME;
 				mouse = { 0,200 };
 
 			}
 
-			if (axes_state[1] < -0.3 || buttons[15]) {
+			if (input.axis(1) < -0.3 || input.gamepad_button(15)) {
 				button_select = BUTTON_SELECT::MUTE;
 				mouse = { 0,-200 };
 
@@ -1743,7 +1824,7 @@ void WorldSystem::menu_controller(float elapsed_ms_since_last_update) {
 		}
 
 
-		if (buttons[1]) {
+		if (input.gamepad_button(1)) {
 			if (state == GAME_STATE::PAUSE_MENU || state == GAME_STATE::START_MENU) {
 				menu_system->recent_click_coord = mouse;
 				controller_mode = 1;
@@ -1756,69 +1837,51 @@ void WorldSystem::menu_controller(float elapsed_ms_since_last_update) {
 
 
 void WorldSystem::step_controller() {
-	int present = glfwJoystickPresent(GLFW_JOYSTICK_1);
-	if (present) {
-		axesupdate();
-
-
-
-		int count;
-		const unsigned char* buttons = glfwGetJoystickButtons(GLFW_JOYSTICK_1, &count);
-		controller_buttons = buttons;
-
-		if (buttons[9]) {
+	if (input.gamepad_present()) {
+		if (input.gamepad_button(9)) {
 			if (state == GAME_STATE::RUNNING) {
 				state = GAME_STATE::PAUSE_MENU;
 				button_select = BUTTON_SELECT::NONE;
 			}
 		}
-		if (buttons[18]) {
+		if (input.gamepad_button(18)) {
 			controller_mode = 0;
 
 		}
-		if (buttons[16]) {
+		if (input.gamepad_button(16)) {
 			controller_mode = 1;
 
 		}
 	}
-	else {
-		axes_state[0] = 0.0;
-		axes_state[1] = 0.0;
-		axes_state[2] = 0.0;
-		axes_state[3] = 0.0;
-		axes_state[4] = 0.0;
-		axes_state[5] = 0.0;
-
-	}
 }
 
 void WorldSystem::control_movement(float elapsed_ms) {
 	Motion& playermovement = registry.motions.get(player);
 
 	// Vertical movement
-	if (keys_pressed[GLFW_KEY_W]) {
+	if (input.action(INPUT_ACTION::MOVE_UP)) {
 		playermovement.velocity.y += elapsed_ms * playermovement.acceleration_unit;
 	}
-	if (keys_pressed[GLFW_KEY_S]) {
+	if (input.action(INPUT_ACTION::MOVE_DOWN)) {
 		playermovement.velocity.y -= elapsed_ms * playermovement.acceleration_unit;
 	}
-	playermovement.velocity.y -= elapsed_ms * playermovement.acceleration_unit * axes_state[1];
+	playermovement.velocity.y -= elapsed_ms * playermovement.acceleration_unit * input.axis(1);
 
 
-	if ((!(keys_pressed[GLFW_KEY_S] || keys_pressed[GLFW_KEY_W]) || (keys_pressed[GLFW_KEY_S] && keys_pressed[GLFW_KEY_W])) && (axes_state[1] <= 0.3 && axes_state[1] >= -0.3)) {
+	if ((!(input.action(INPUT_ACTION::MOVE_DOWN) || input.action(INPUT_ACTION::MOVE_UP)) || (input.action(INPUT_ACTION::MOVE_DOWN) && input.action(INPUT_ACTION::MOVE_UP))) && (input.axis(1) <= 0.3 && input.axis(1) >= -0.3)) {
 		playermovement.velocity.y *= pow(playermovement.deceleration_unit, elapsed_ms);
 	}
 
 	// Horizontal movement
-	if (keys_pressed[GLFW_KEY_D]) {
+	if (input.action(INPUT_ACTION::MOVE_RIGHT)) {
 		playermovement.velocity.x += elapsed_ms * playermovement.acceleration_unit;
 	}
-	if (keys_pressed[GLFW_KEY_A]) {
+	if (input.action(INPUT_ACTION::MOVE_LEFT)) {
 		playermovement.velocity.x -= elapsed_ms * playermovement.acceleration_unit;
 	}
-	playermovement.velocity.x += elapsed_ms * playermovement.acceleration_unit * axes_state[0];
+	playermovement.velocity.x += elapsed_ms * playermovement.acceleration_unit * input.axis(0);
 
-	if ((!(keys_pressed[GLFW_KEY_D] || keys_pressed[GLFW_KEY_A]) || (keys_pressed[GLFW_KEY_D] && keys_pressed[GLFW_KEY_A])) && (axes_state[0] <= 0.3 && axes_state[0] >= -0.3)) {
+	if ((!(input.action(INPUT_ACTION::MOVE_RIGHT) || input.action(INPUT_ACTION::MOVE_LEFT)) || (input.action(INPUT_ACTION::MOVE_RIGHT) && input.action(INPUT_ACTION::MOVE_LEFT))) && (input.axis(0) <= 0.3 && input.axis(0) >= -0.3)) {
 		playermovement.velocity.x *= pow(playermovement.deceleration_unit, elapsed_ms);
 	}
 
@@ -1838,6 +1901,33 @@ void WorldSystem::clearSpecificEntities(ComponentContainer<Component>& component
 	}
 }
 
+template <typename Visitor>
+void WorldSystem::for_each_run_container(ECSRegistry& registry, bool hard_reset, Visitor&& visitor) {
+	visitor(registry.motions);
+	visitor(registry.players);
+	visitor(registry.cysts);
+	visitor(registry.waypoints);
+	visitor(registry.chests);
+	visitor(registry.cure);
+	visitor(registry.enemies);
+	visitor(registry.attachments);
+	visitor(registry.deathTimers);
+	visitor(registry.healthValues);
+	visitor(registry.invincibility);
+	visitor(registry.dashes);
+	visitor(registry.collidePlayers);
+	visitor(registry.collideEnemies);
+	visitor(registry.melees);
+	visitor(registry.guns);
+	visitor(registry.bosses);
+	// Progress of the whole game
+	if (hard_reset) {
+		visitor(registry.game);
+		visitor(registry.playerAbilities);
+		visitor(registry.regions);
+	}
+}
+
 void WorldSystem::reset_game_state(bool hard_reset) {
 	// Debugging for memory/component leaks
 	std::cout << "\n------------ Before Cleanup ------------\n";
@@ -1845,38 +1935,17 @@ void WorldSystem::reset_game_state(bool hard_reset) {
 
 
 	dialog_system->clear_pending_dialogs();
-	// reverse active effects
-	for (auto event : registry.timedEvents.components) {
-		event.callback();
-	}
+	// reverse active effects, events they scheduled in turn were dropped
+	timers.flush();
+	pending_events.clear();
+	// checkpoints belong to the run that ends here
+	checkpoints.clear();
 
 	// Remove entities that will be recreated
-	clearSpecificEntities(registry.timedEvents);
-	clearSpecificEntities(registry.motions);
-	clearSpecificEntities(registry.players);
-	clearSpecificEntities(registry.collisions);
-	clearSpecificEntities(registry.cysts);
-	clearSpecificEntities(registry.waypoints);
-	clearSpecificEntities(registry.chests);
-	clearSpecificEntities(registry.cure);
-	clearSpecificEntities(registry.projectiles);
-	clearSpecificEntities(registry.enemies);
-	clearSpecificEntities(registry.attachments);
-	clearSpecificEntities(registry.deathTimers);
-	clearSpecificEntities(registry.healthValues);
-	clearSpecificEntities(registry.invincibility);
-	clearSpecificEntities(registry.dashes);
-	clearSpecificEntities(registry.collidePlayers);
-	clearSpecificEntities(registry.collideEnemies);
-	clearSpecificEntities(registry.melees);
-	clearSpecificEntities(registry.guns);
-	clearSpecificEntities(registry.bosses);
+	registry.projectiles.clear();
+	for_each_run_container(registry, hard_reset, [this](auto& container) { clearSpecificEntities(container); });
 
 	if (hard_reset) {
-		clearSpecificEntities(registry.game);
-		clearSpecificEntities(registry.playerAbilities);
-		clearSpecificEntities(registry.regions);
-
 		// Clear individual entities
 		registry.remove_all_components_of(healthbar);
 		registry.remove_all_components_of(healthbar_frame);
@@ -1884,25 +1953,22 @@ void WorldSystem::reset_game_state(bool hard_reset) {
 		registry.remove_all_components_of(boss_healthbar);
 		registry.remove_all_components_of(death_screen);
 
-		createRandomRegions(NUM_REGIONS, rng);
+		createRandomRegions(registry, NUM_REGIONS, rng);
 		registry.game.emplace(game_entity);
 
 		// Set music
 		Mix_FadeInMusic(backgroundMusic["main"], -1, 5000);
 
 		// Recreate Healthbars
-		std::tuple<Entity, Entity> healthbar_elems = createHealthbar({ -CONTENT_WIDTH_PX * 0.34, CONTENT_HEIGHT_PX * 0.43 }, STATUSBAR_SCALE);
+		std::tuple<Entity, Entity> healthbar_elems = createHealthbar(registry, { -CONTENT_WIDTH_PX * 0.34, CONTENT_HEIGHT_PX * 0.43 }, STATUSBAR_SCALE);
 		healthbar = std::get<0>(healthbar_elems);
 		healthbar_frame = std::get<1>(healthbar_elems);
-		healthbar_elems = createBossHealthbar({ 0.f, CONTENT_HEIGHT_PX * -0.42 }, STATUSBAR_SCALE);
+		healthbar_elems = createBossHealthbar(registry, { 0.f, CONTENT_HEIGHT_PX * -0.42 }, STATUSBAR_SCALE);
 		boss_healthbar = std::get<0>(healthbar_elems);
 		boss_healthbar_frame = std::get<1>(healthbar_elems);
 	}
 
 	// Reset variables
-	for (auto& count : enemyCounts) {
-		count.second = 0;
-	}
 	current_speed = 1.f;
 	individual_spawn_interval = 1000.f;
 	enemy_spawn_cooldown = 5000.f;
@@ -1916,146 +1982,246 @@ void WorldSystem::reset_game_state(bool hard_reset) {
 void WorldSystem::load_game() {
 	printf("\n=========================\n|\tLoading\t\t|\n=========================\n");
 
-	std::ifstream inFile("savegame.json");
-	if (!inFile) {
+	// Saves from before the binary format only have the JSON file
+	save_writer.flush();
+	SaveState saved;
+	WorldStaging staged;
+	if (!read_save_binary(SAVE_GAME_PATH, saved) && !read_save_json(SAVE_GAME_JSON_PATH, saved, &staged)) {
 		std::cerr << "Error opening file for reading." << std::endl;
 		return;
 	}
-	json gameState;
-	inFile >> gameState;
+	apply_save_state(saved, &staged);
+	std::cout << "Game state loaded." << std::endl;
+}
 
+void WorldSystem::apply_save_state(const SaveState& saved, WorldStaging* staged) {
 	// Clear current game state before loading
 	reset_game_state(true);
 
+	// Saves with the whole world restore it as it was, older ones and damaged worlds are rebuilt from the records
+	if (!saved.world.empty() || (staged && !staged->empty())) {
+		if (restore_world_state(saved, staged)) return;
+		reset_game_state(true);
+	}
+
 	// Recreate required entities with the saved values
 
 	// Deserialize game mode
-	auto& gameModeData = gameState["gameMode"][0];
-	assert(static_cast<int>(gameModeData["id"]) < game_mode_id_count);
-	GAME_MODE_ID gm_id = static_cast<GAME_MODE_ID>(gameModeData["id"]);
-	setGameMode(gm_id);
+	assert(saved.game.game_mode < game_mode_id_count);
+	setGameMode(static_cast<GAME_MODE_ID>(saved.game.game_mode));
 
 	// Deserialize Game Data
 	assert(registry.game.has(game_entity));
-	const auto& gameData = gameState["game"];
 	Game& gameComponent = registry.game.get(game_entity);
-	gameComponent.isFirstBossDefeated = gameData["isFirstBossDefeated"];
-	gameComponent.isCureObtained = gameData["isCureObtained"];
-	gameComponent.isSecondBossDefeated = gameData["isSecondBossDefeated"];
-	gameComponent.isCystTutorialDisplayed = gameData["isCystTutorialDisplayed"];
+	gameComponent.isFirstBossDefeated = saved.game.is_first_boss_defeated;
+	gameComponent.isCureObtained = saved.game.is_cure_obtained;
+	gameComponent.isSecondBossDefeated = saved.game.is_second_boss_defeated;
+	gameComponent.isCystTutorialDisplayed = saved.game.is_cyst_tutorial_displayed;
 
 	// Deserialize and recreate Regions
-	loadRegions(gameState["regions"]);
+	loadRegions(saved.regions);
 
 	// Deserialize Player
-	const auto& playerData = gameState["player"];
-	player = createPlayer({ playerData["position"][0], playerData["position"][1] });
+	player = createPlayer(registry, saved.player.position);
 	effects_system->player = player;
 
 	// Deserialize Player Abilities
-	for (const auto& abilityId : gameState["playerAbilities"]) {
-		PLAYER_ABILITY_ID ability = static_cast<PLAYER_ABILITY_ID>(abilityId);
-
-		Entity abilityEntity = Entity();
+	for (int32_t abilityId : saved.player_abilities) {
+		Entity abilityEntity = registry.create_entity();
 		PlayerAbility abilityComponent;
-		abilityComponent.id = ability;
+		abilityComponent.id = static_cast<PLAYER_ABILITY_ID>(abilityId);
 
 		registry.playerAbilities.insert(abilityEntity, abilityComponent);
 	}
 	populate_player_abilities();
 
 	Health& playerHealth = registry.healthValues.get(player);
-	playerHealth.health = playerData["health"];
+	playerHealth.health = saved.player.health;
 
-	// Deserialize Enemies
-	for (const auto& enemyData : gameState["enemies"]) {
-		vec2 position = { enemyData["position"][0], enemyData["position"][1] };
-		float enemyHealth = enemyData["health"];
-		ENEMY_ID enemyType = static_cast<ENEMY_ID>(enemyData["type"]);
+	// Deserialize Enemies, regular enemies are gathered per type and spawned in one batch
+	std::vector<vec2> enemyPositions[enemy_type_count];
+	std::vector<float> enemyHealths[enemy_type_count];
+	for (const SavedEnemy& enemyData : saved.enemies) {
+		ENEMY_ID enemyType = static_cast<ENEMY_ID>(enemyData.type);
 		switch (enemyType) {
 		case ENEMY_ID::BOSS:
 			if (!gameComponent.isFirstBossDefeated) {
-				Entity boss1 = createBoss(renderer, position, enemyHealth);
-				createWaypoint(REGION_GOAL_ID::CURE, boss1);
+				Entity boss1 = createBoss(registry, renderer, enemyData.position, enemyData.health);
+				createWaypoint(registry, REGION_GOAL_ID::CURE, boss1);
 			}
 			break;
 		case ENEMY_ID::FRIENDBOSS:
 			if (!gameComponent.isSecondBossDefeated) {
-				Entity boss2 = createSecondBoss(renderer, position, enemyHealth);
-				createWaypoint(REGION_GOAL_ID::CANCER_CELL, boss2);
+				Entity boss2 = createSecondBoss(registry, renderer, enemyData.position, enemyData.health);
+				createWaypoint(registry, REGION_GOAL_ID::CANCER_CELL, boss2);
 			}
 			break;
 		case ENEMY_ID::RED:
-			createRedEnemy(position, enemyHealth);
-			enemyCounts[ENEMY_ID::RED]++;
-			break;
 		case ENEMY_ID::GREEN:
-			createGreenEnemy(position, enemyHealth);
-			enemyCounts[ENEMY_ID::GREEN]++;
-			break;
 		case ENEMY_ID::YELLOW:
-			createYellowEnemy(position, enemyHealth);
-			enemyCounts[ENEMY_ID::YELLOW]++;
+			enemyPositions[(int)enemyType].push_back(enemyData.position);
+			enemyHealths[(int)enemyType].push_back(enemyData.health);
 			break;
 		default:
 			// Handle unknown type
 			break;
 		}
-
-		//std::cout << "Enemy loaded: Type = " << static_cast<int>(enemyType)
-		//          << ", Position = (" << position.x << ", " << position.y << ")"
-		//          << ", Health = " << enemyHealth << "\n";
+	}
+	for (ENEMY_ID type : { ENEMY_ID::RED, ENEMY_ID::GREEN, ENEMY_ID::YELLOW }) {
+		size_t count = enemyPositions[(int)type].size();
+		if (count == 0) continue;
+		for (Entity enemy : spawnPrefab(registry, registry.prefabs.get(type), count, enemyPositions[(int)type].data(), enemyHealths[(int)type].data())) {
+			spawn_manager.track(enemy);
+		}
 	}
 
 	// Deserialize Cysts
-	for (const auto& cystData : gameState["cysts"]) {
-		vec2 position = { cystData["position"][0], cystData["position"][1] };
-		float cystHealth = cystData["health"];
-		createCyst(position, cystHealth);
-
-		//std::cout << "Cyst loaded: Position = (" << position.x << ", " << position.y << ")"
-		//		<< ", Health = " << cystHealth << "\n";
+	for (const SavedCyst& cystData : saved.cysts) {
+		createCyst(registry, cystData.position, cystData.health);
 	}
 
 	// Deserialize Chests
-	for (const auto& chestData : gameState["chests"]) {
-		vec2 position = { chestData["position"][0], chestData["position"][1] };
-		REGION_GOAL_ID ability = static_cast<REGION_GOAL_ID>(chestData["ability"]);
-		Entity chest = createChest(position, ability);
-		createWaypoint(ability, chest);
+	for (const SavedChest& chestData : saved.chests) {
+		REGION_GOAL_ID ability = static_cast<REGION_GOAL_ID>(chestData.ability);
+		Entity chest = createChest(registry, chestData.position, ability);
+		createWaypoint(registry, ability, chest);
 	}
 
 	// Deserialize Cure
-	if (!gameComponent.isCureObtained && gameState["cure"] != nullptr) {
-		vec2 curePosition = { gameState["cure"]["position"][0], gameState["cure"]["position"][1] };
-		Entity cure = createCure(curePosition);
-		createWaypoint(REGION_GOAL_ID::CURE, cure);
+	if (!gameComponent.isCureObtained && saved.has_cure) {
+		Entity cure = createCure(registry, saved.cure_position);
+		createWaypoint(registry, REGION_GOAL_ID::CURE, cure);
 	}
+}
 
-	inFile.close();
-	std::cout << "Game state loaded." << std::endl;
+bool WorldSystem::restore_world_state(const SaveState& saved, WorldStaging* staged) {
+	// The saved entities replace the run, the game and game mode entities are kept
+	for_each_run_container(registry, true, [this](auto& container) { clearSpecificEntities(container); });
+	Entity game_mode_entity = registry.gameMode.entities.back();
+	GameMode game_mode = registry.gameMode.components.back();
+	registry.gameMode.remove(game_mode_entity);
+
+	// Every other saved entity gets a new id, in the order they come up
+	std::unordered_map<unsigned int, Entity> loaded;
+	loaded[saved.world_handles.game] = game_entity;
+	loaded[saved.world_handles.game_mode] = game_mode_entity;
+	auto remap = [this, &loaded](Entity entity) {
+		auto it = loaded.find(entity);
+		if (it == loaded.end()) it = loaded.insert({ entity, registry.create_entity() }).first;
+		return it->second;
+	};
+	// A staged world was checked while reading, only a blob can still turn out to be damaged
+	bool restored = true;
+	if (staged && !staged->empty()) restore_world(registry, *staged, &renderer->getMesh((GEOMETRY_BUFFER_ID)0), remap);
+	else restored = restore_world(registry, saved.world, &renderer->getMesh((GEOMETRY_BUFFER_ID)0), remap);
+	player = remap(Entity(saved.world_handles.player));
+	if (!restored || !registry.game.has(game_entity) || !registry.gameMode.has(game_mode_entity) || !registry.players.has(player)) {
+		std::cerr << "Saved world is incomplete, loading the saved records instead" << std::endl;
+		if (!registry.gameMode.has(game_mode_entity)) registry.gameMode.insert(game_mode_entity, game_mode);
+		return false;
+	}
+
+	effects_system->player = player;
+	if (saved.world_handles.death_screen != 0) death_screen = remap(Entity(saved.world_handles.death_screen));
+	update_enemy_limits();
+	for (uint i = 0; i < registry.enemies.size(); i++) {
+		ENEMY_ID type = registry.enemies.components[i].type;
+		if (type == ENEMY_ID::RED || type == ENEMY_ID::GREEN || type == ENEMY_ID::YELLOW) {
+			spawn_manager.track(registry.enemies.entities[i]);
+		}
+	}
+	// The reset recreated the HUD
+	if (hasPlayerAbility(PLAYER_ABILITY_ID::HEALTH_BOOST)) apply_health_boost_hud();
+
+	for (const SavedProjectile& projectileData : saved.projectiles) {
+		registry.projectiles.spawn(projectileData.position, projectileData.velocity, projectileData.radius,
+			projectileData.damage, projectileData.color, projectileData.team, projectileData.lifetime_ms);
+	}
+
+	// Events of entities that are gone by now still run, they no longer find them
+	for (const SavedTimedEvent& eventData : saved.timed_events) {
+		bool known = eventData.type >= 0 && eventData.type < timed_event_count;
+		if (eventData.type == (int32_t)TIMED_EVENT_ID::EFFECT_END) known = known && eventData.effect >= 0 && eventData.effect < cyst_effect_count;
+		if (!known) continue;
+		TimedEvent event;
+		event.type = static_cast<TIMED_EVENT_ID>(eventData.type);
+		event.effect = static_cast<CYST_EFFECT_ID>(eventData.effect);
+		auto it = loaded.find(eventData.entity);
+		if (it != loaded.end()) event.entity = it->second;
+		std::copy(eventData.values, eventData.values + timed_event_value_count, event.values);
+		resume_event(eventData.remaining_ms, event);
+	}
+	return true;
+}
+
+void WorldSystem::push_checkpoint() {
+	checkpoints.push();
+	CheckpointState& checkpoint = checkpoint_states[checkpoints.slot_of()];
+	checkpoint.state = state;
+	checkpoint.player = player;
+	checkpoint.death_screen = death_screen;
+	checkpoint.rng = rng;
+	checkpoint.enemy_spawn_cooldown = enemy_spawn_cooldown;
+	checkpoint.individual_spawn_interval = individual_spawn_interval;
+	checkpoint.current_speed = current_speed;
+	checkpoint.allow_accel = allow_accel;
+	checkpoint.camera_time_ms = camera_time_ms;
+	checkpoint.scan_times = spawn_manager.get_scan_times();
+	checkpoint.timer_time = timers.time();
+	checkpoint.events.clear();
+	for (const auto& pending : pending_events) {
+		checkpoint.events.push_back({ timers.remaining_ms(pending.second.timer), pending.second.event });
+	}
+	effects_system->save_checkpoint(checkpoint.effects);
+}
+
+bool WorldSystem::restore_checkpoint(size_t back) {
+	if (!checkpoints.restore(back)) return false;
+	const CheckpointState& checkpoint = checkpoint_states[checkpoints.slot_of()];
+	state = checkpoint.state;
+	player = checkpoint.player;
+	death_screen = checkpoint.death_screen;
+	rng = checkpoint.rng;
+	enemy_spawn_cooldown = checkpoint.enemy_spawn_cooldown;
+	individual_spawn_interval = checkpoint.individual_spawn_interval;
+	current_speed = checkpoint.current_speed;
+	allow_accel = checkpoint.allow_accel;
+	camera_time_ms = checkpoint.camera_time_ms;
+
+	// The restore ran no container hooks
+	update_enemy_limits();
+	spawn_manager.rebuild();
+	spawn_manager.set_scan_times(checkpoint.scan_times);
+
+	// The pending events made changes the restore took back, the checkpoint's run instead
+	timers.clear();
+	pending_events.clear();
+	timers.set_time(checkpoint.timer_time);
+	for (const auto& event : checkpoint.events) {
+		schedule_event(event.first, event.second);
+	}
+	effects_system->restore_checkpoint(checkpoint.effects);
+	effects_system->player = player;
+	dialog_system->clear_pending_dialogs();
+	return true;
 }
 
-void WorldSystem::loadRegions(const json& regionsData) {
+void WorldSystem::loadRegions(const std::vector<SavedRegion>& regionsData) {
 	// Assuming the regions are saved in the same order they were created
 	assert(regionsData.size() == registry.regions.components.size());
 
-	bool cureUnlocked = registry.game.get(game_entity).isCureObtained;
-	bool secondBossDefeated = registry.game.get(game_entity).isSecondBossDefeated;
-
 	for (size_t i = 0; i < regionsData.size(); ++i) {
-		const auto& regionData = regionsData[i];
+		const SavedRegion& regionData = regionsData[i];
 		auto entity = registry.regions.entities[i];
 		Region& region = registry.regions.get(entity);
 
-		// Update region details from JSON data
-		region.theme = static_cast<REGION_THEME_ID>(regionData["theme"]);
-		region.goal = static_cast<REGION_GOAL_ID>(regionData["goal"]);
-		region.enemy = static_cast<ENEMY_ID>(regionData["enemy"]);
-		region.boss = static_cast<BOSS_ID>(regionData["boss"]);
-		region.is_cleared = regionData["is_cleared"];
-		vec2 interest_point = { regionData["interest_point"][0], regionData["interest_point"][1] };
-		region.interest_point = interest_point;
+		// Update region details from the saved data
+		region.theme = static_cast<REGION_THEME_ID>(regionData.theme);
+		region.goal = static_cast<REGION_GOAL_ID>(regionData.goal);
+		region.enemy = static_cast<ENEMY_ID>(regionData.enemy);
+		region.boss = static_cast<BOSS_ID>(regionData.boss);
+		region.is_cleared = regionData.is_cleared;
+		region.interest_point = regionData.interest_point;
 
 		// Update RenderRequest component
 		RenderRequest& renderReq = registry.renderRequests.get(entity);
@@ -2064,47 +2230,70 @@ void WorldSystem::loadRegions(const json& regionsData) {
 }
 
 void WorldSystem::save_game() {
-	json gameState = serializeGameState();
-	std::ofstream outFile("savegame.json");
-	if (!outFile) {
-		std::cerr << "Error opening file for writing." << std::endl;
-		return;
+	// The registry is copied as it is, the writer thread reads the save from the copy and writes
+	// it, debug mode adds a readable JSON copy
+	SaveCapture capture;
+	capture.handles.player = player;
+	capture.handles.game = game_entity;
+	capture.handles.game_mode = registry.gameMode.entities.back();
+	if (registry.deathTimers.has(player)) {
+		capture.handles.death_screen = death_screen;
 	}
-	outFile << gameState.dump(4);
-	outFile.close();
-	std::cout << "Game state saved." << std::endl;
+	capture.meshes = &renderer->getMesh((GEOMETRY_BUFFER_ID)0);
+
+	// Every timer belongs to an event, effect icons are made again on load
+	assert(timers.size() == pending_events.size() && "Timer outside of schedule_event");
+	for (const auto& pending : pending_events) {
+		TimedEvent event = pending.second.event;
+		SavedTimedEvent eventData;
+		eventData.type = static_cast<int32_t>(event.type);
+		eventData.effect = static_cast<int32_t>(event.effect);
+		eventData.entity = event.type == TIMED_EVENT_ID::EFFECT_END ? 0 : (unsigned int)event.entity;
+		eventData.remaining_ms = timers.remaining_ms(pending.second.timer);
+		std::copy(event.values, event.values + timed_event_value_count, eventData.values);
+		capture.timed_events.push_back(eventData);
+	}
+
+	save_writer.submit(registry, std::move(capture), debugging.in_debug_mode);
+	autosave_timer_ms = 0.f;
 }
 
-json WorldSystem::serializeGameState() {
-	json gameState;
+void WorldSystem::step_autosave(float elapsed_ms) {
+	if (autosave_interval_ms <= 0.f) return;
+	autosave_timer_ms += elapsed_ms;
+	// Not while the player dies, loading would bring them back with no health
+	if (autosave_timer_ms < autosave_interval_ms || registry.deathTimers.has(player)) return;
+	save_game();
+}
+
+void WorldSystem::build_save_state(ECSRegistry& registry, const SaveCapture& capture, SaveState& saved) {
+	Entity player(capture.handles.player);
+	Entity game_entity(capture.handles.game);
 
 	// Serialize Regions
 	for (const Region& region : registry.regions.components) {
-		json regionData;
-		regionData["theme"] = static_cast<int>(region.theme);
-		regionData["goal"] = static_cast<int>(region.goal);
-		regionData["enemy"] = static_cast<int>(region.enemy);
-		regionData["boss"] = static_cast<int>(region.boss);
-		regionData["is_cleared"] = region.is_cleared;
-		regionData["interest_point"] = { region.interest_point.x, region.interest_point.y };
-		gameState["regions"].push_back(regionData);
+		SavedRegion regionData;
+		regionData.theme = static_cast<int32_t>(region.theme);
+		regionData.goal = static_cast<int32_t>(region.goal);
+		regionData.enemy = static_cast<int32_t>(region.enemy);
+		regionData.boss = static_cast<int32_t>(region.boss);
+		regionData.is_cleared = region.is_cleared;
+		regionData.interest_point = region.interest_point;
+		saved.regions.push_back(regionData);
 	}
 
 	// Serialize Player
-	const auto& playerTransform = registry.transforms.get(player);
-	const auto& playerHealth = registry.healthValues.get(player);
-	gameState["player"]["position"] = { playerTransform.position.x, playerTransform.position.y };
-	gameState["player"]["health"] = playerHealth.health;
+	saved.player.position = registry.transforms.get(player).position;
+	saved.player.health = registry.healthValues.get(player).health;
 
 	const auto& gameComponent = registry.game.get(game_entity);
-	gameState["game"]["isFirstBossDefeated"] = gameComponent.isFirstBossDefeated;
-	gameState["game"]["isCureObtained"] = gameComponent.isCureObtained;
-	gameState["game"]["isSecondBossDefeated"] = gameComponent.isSecondBossDefeated;
-	gameState["game"]["isCystTutorialDisplayed"] = gameComponent.isCystTutorialDisplayed;
+	saved.game.is_first_boss_defeated = gameComponent.isFirstBossDefeated;
+	saved.game.is_cure_obtained = gameComponent.isCureObtained;
+	saved.game.is_second_boss_defeated = gameComponent.isSecondBossDefeated;
+	saved.game.is_cyst_tutorial_displayed = gameComponent.isCystTutorialDisplayed;
 
-	for (const auto& abilityEntity : registry.playerAbilities.entities) {
-		const auto& ability = registry.playerAbilities.get(abilityEntity);
-		gameState["playerAbilities"].push_back(static_cast<int>(ability.id));
+	for (const PlayerAbility& ability : registry.playerAbilities.components) {
+		saved.player_abilities.push_back(static_cast<int32_t>(ability.id));
 	}
 
 	// Serialize Enemies
@@ -2113,59 +2302,71 @@ json WorldSystem::serializeGameState() {
 		const Enemy& enemyType = enemiesContainer.components[i];
 		if (enemyType.type == ENEMY_ID::BOSS_ARM || enemyType.type == ENEMY_ID::FRIENDBOSSCLONE) continue;	// don't save these
 		Entity enemyEntity = enemiesContainer.entities[i];
-		const auto& enemyTransform = registry.transforms.get(enemyEntity);
-		const auto& enemyHealth = registry.healthValues.get(enemyEntity);
-		json enemyData;
-		enemyData["position"] = { enemyTransform.position.x, enemyTransform.position.y };
-		enemyData["health"] = enemyHealth.health;
-		enemyData["type"] = static_cast<int>(enemyType.type);
-		gameState["enemies"].push_back(enemyData);
+		SavedEnemy enemyData;
+		enemyData.type = static_cast<int32_t>(enemyType.type);
+		enemyData.position = registry.transforms.get(enemyEntity).position;
+		enemyData.health = registry.healthValues.get(enemyEntity).health;
+		saved.enemies.push_back(enemyData);
 	}
 
 	// Serialize Cysts
 	auto& cystsContainer = registry.cysts;
 	for (uint i = 0; i < cystsContainer.size(); i++) {
 		Entity cystEntity = cystsContainer.entities[i];
-		const auto& cystTransform = registry.transforms.get(cystEntity);
-		const auto& cystHealth = registry.healthValues.get(cystEntity);
-		json cystData;
-		cystData["position"] = { cystTransform.position.x, cystTransform.position.y };
-		cystData["health"] = cystHealth.health;
-		gameState["cysts"].push_back(cystData);
+		SavedCyst cystData;
+		cystData.position = registry.transforms.get(cystEntity).position;
+		cystData.health = registry.healthValues.get(cystEntity).health;
+		saved.cysts.push_back(cystData);
 	}
 
 	// Serialize Chests
 	for (const Chest& chest : registry.chests.components) {
 		if (!chest.isOpened) {
-			json chestData;
-			chestData["position"] = { chest.position.x, chest.position.y };
-			chestData["ability"] = static_cast<int>(chest.ability);
-			gameState["chests"].push_back(chestData);
+			SavedChest chestData;
+			chestData.position = chest.position;
+			chestData.ability = static_cast<int32_t>(chest.ability);
+			saved.chests.push_back(chestData);
 		}
 	}
 
 	// Serialize Cure (if exists and not picked up)
-	bool cureFound = false;
 	for (const auto& cureEntity : registry.cure.entities) {
-		const auto& cureTransform = registry.transforms.get(cureEntity);
-		json cureData;
-		cureData["position"] = { cureTransform.position.x, cureTransform.position.y };
-		gameState["cure"] = cureData;
-		cureFound = true;
+		saved.has_cure = true;
+		saved.cure_position = registry.transforms.get(cureEntity).position;
 		break;
 	}
-	if (!cureFound) {
-		gameState["cure"] = nullptr;
-	}
 
 	// Serialize game mode
-	GameMode& gameMode = registry.gameMode.components.back();
-	json gameModeData;
-	gameModeData["id"] = gameMode.id;
+	saved.game.game_mode = static_cast<int32_t>(registry.gameMode.components.back().id);
 
-	gameState["gameMode"].push_back(gameModeData);
+	build_world_state(registry, capture, saved);
+}
 
-	return gameState;
+void WorldSystem::build_world_state(ECSRegistry& registry, const SaveCapture& capture, SaveState& saved) {
+	std::vector<Entity> entities;
+	for_each_run_container(registry, true, [&entities](auto& container) {
+		entities.insert(entities.end(), container.entities.begin(), container.entities.end());
+	});
+	entities.push_back(Entity(capture.handles.game_mode));
+	if (capture.handles.death_screen != 0) {
+		entities.push_back(Entity(capture.handles.death_screen));
+	}
+	capture_world(registry, entities, capture.meshes, saved.world);
+	saved.world_handles = capture.handles;
+	saved.timed_events = capture.timed_events;
+
+	const ProjectilePool& projectiles = registry.projectiles;
+	for (size_t i = 0; i < projectiles.size(); i++) {
+		SavedProjectile projectileData;
+		projectileData.position = projectiles.positions[i];
+		projectileData.velocity = projectiles.velocities[i];
+		projectileData.radius = projectiles.radii[i];
+		projectileData.damage = projectiles.damages[i];
+		projectileData.color = projectiles.colors[i];
+		projectileData.lifetime_ms = projectiles.lifetimes[i];
+		projectileData.team = projectiles.teams[i];
+		saved.projectiles.push_back(projectileData);
+	}
 }
 
 bool WorldSystem::hasPlayerAbility(PLAYER_ABILITY_ID abilityId) {
@@ -2177,36 +2378,23 @@ bool WorldSystem::hasPlayerAbility(PLAYER_ABILITY_ID abilityId) {
 	return false;
 }
 
-Entity& WorldSystem::getAttachment(Entity character, ATTACHMENT_ID type) {
+Entity WorldSystem::getAttachment(Entity character, ATTACHMENT_ID type) {
 	Entity attachment_entity;
-	for (uint i = 0; i < registry.attachments.size(); i++) {
-		Attachment& att = registry.attachments.components[i];
-		if (att.parent == character && att.type == type)
-			attachment_entity = registry.attachments.entities[i];
+	for (Entity child : registry.attachments.children_of(character)) {
+		if (registry.attachments.get(child).type == type)
+			attachment_entity = child;
 	}
 	return attachment_entity;
 }
 
 void WorldSystem::control_action() {
-	if (controller_buttons != NULL) {
-		if (axes_state[4] > 0.1) {
-			player_shoot();
-		}
-		if (axes_state[3] > 0.1) {
-			player_sword_slash();
-		}
-		if (controller_buttons[4]) {
-			player_dash();
-		}
-
-	}
-	if (keys_pressed[GLFW_MOUSE_BUTTON_LEFT]) {
+	if (input.action(INPUT_ACTION::SHOOT)) {
 		player_shoot();
 	}
-	if (keys_pressed[GLFW_MOUSE_BUTTON_RIGHT]) {
+	if (input.action(INPUT_ACTION::SLASH)) {
 		player_sword_slash();
 	}
-	if (keys_pressed[GLFW_KEY_LEFT_SHIFT]) {
+	if (input.action(INPUT_ACTION::DASH)) {
 		player_dash();
 	}
 }
@@ -2221,12 +2409,11 @@ void WorldSystem::control_direction() {
 	Transform& playertransform = registry.transforms.get(player);
 	Transform& cursortransform = registry.transforms.get(cursor);
 
-	int present = glfwJoystickPresent(GLFW_JOYSTICK_1);
-	if (present && controller_mode) {
+	if (input.gamepad_present() && controller_mode) {
 
 		//float controller_angle = playertransform.angle;
-		if (!(axes_state[5] <= 0.4 && axes_state[5] >= -0.4) || !(axes_state[2] <= 0.4 && axes_state[2] >= -0.4)) {
-			float controller_angle = atan2f(-axes_state[5] * abs(axes_state[5]), axes_state[2] * abs(axes_state[2]));
+		if (!(input.axis(5) <= 0.4 && input.axis(5) >= -0.4) || !(input.axis(2) <= 0.4 && input.axis(2) >= -0.4)) {
+			float controller_angle = atan2f(-input.axis(5) * abs(input.axis(5)), input.axis(2) * abs(input.axis(2)));
 			playertransform.angle = controller_angle + playertransform.angle_offset;
 
 			// Set cursor position
@@ -2264,7 +2451,7 @@ void WorldSystem::control_direction() {
 void WorldSystem::player_shoot() {
 	Gun& playerGun = registry.guns.get(player);
 	if (playerGun.attack_timer <= 0) {
-		createBullet(player, playerGun.bullet_size, playerGun.bullet_color);
+		createBullet(registry, player, playerGun.bullet_size, playerGun.bullet_color);
 		playerGun.attack_timer = playerGun.attack_delay;
 	}
 	else if (playerGun.attack_timer > PLAYER_ATTACK_DELAY * 2 &&
@@ -2304,15 +2491,15 @@ void WorldSystem::player_dash() {
 	Motion& playerMovement = registry.motions.get(player);
 	vec2 dashDirection;
 
-	if (keys_pressed[GLFW_KEY_W] || keys_pressed[GLFW_KEY_A] || keys_pressed[GLFW_KEY_S] || keys_pressed[GLFW_KEY_D]) {
+	if (input.action(INPUT_ACTION::MOVE_UP) || input.action(INPUT_ACTION::MOVE_LEFT) || input.action(INPUT_ACTION::MOVE_DOWN) || input.action(INPUT_ACTION::MOVE_RIGHT)) {
 		// prioritize direction of key presses (players intended direction)
-		dashDirection.x = static_cast<float> (keys_pressed[GLFW_KEY_D] - keys_pressed[GLFW_KEY_A]);
-		dashDirection.y = static_cast<float> (keys_pressed[GLFW_KEY_W] - keys_pressed[GLFW_KEY_S]);
+		dashDirection.x = static_cast<float> (input.action(INPUT_ACTION::MOVE_RIGHT) - input.action(INPUT_ACTION::MOVE_LEFT));
+		dashDirection.y = static_cast<float> (input.action(INPUT_ACTION::MOVE_UP) - input.action(INPUT_ACTION::MOVE_DOWN));
 
 
 		// handle conflicting key-presses
-		bool leftAndRight = keys_pressed[GLFW_KEY_D] && keys_pressed[GLFW_KEY_A];
-		bool upAndDown = keys_pressed[GLFW_KEY_W] && keys_pressed[GLFW_KEY_S];
+		bool leftAndRight = input.action(INPUT_ACTION::MOVE_RIGHT) && input.action(INPUT_ACTION::MOVE_LEFT);
+		bool upAndDown = input.action(INPUT_ACTION::MOVE_UP) && input.action(INPUT_ACTION::MOVE_DOWN);
 		if ((leftAndRight != upAndDown) || (leftAndRight && upAndDown)) {
 			dashDirection = normalize(playerMovement.velocity);
 		}
@@ -2369,17 +2556,13 @@ void WorldSystem::handle_shooting_sound_effect() {
 }
 
 void WorldSystem::setGameMode(GAME_MODE_ID id) {
-	GameMode gm;
-	if (id == GAME_MODE_ID::EASY_MODE) {
-		gm = easyMode;
-	}
-	else {
-		gm = regularMode;
-	}
-	registry.gameMode.components.back() = gm;
-	maxEnemies[ENEMY_ID::RED] = gm.max_red;
-	maxEnemies[ENEMY_ID::GREEN] = gm.max_green;
-	maxEnemies[ENEMY_ID::YELLOW] = gm.max_yellow;
+	set_game_mode(get_game_mode(id));
+}
+
+void WorldSystem::set_game_mode(const GameMode& mode) {
+	GameMode& gm = registry.gameMode.components.back();
+	gm = mode;
+	update_enemy_limits();
 	for (int i = 0; i < registry.enemies.components.size(); i++) {
 		auto& enemyCom = registry.enemies.components[i];
 		auto& enemyEn = registry.enemies.entities[i];
@@ -2387,6 +2570,13 @@ void WorldSystem::setGameMode(GAME_MODE_ID id) {
 	}
 }
 
+void WorldSystem::update_enemy_limits() {
+	const GameMode& gm = registry.gameMode.components.back();
+	maxEnemies[ENEMY_ID::RED] = gm.max_red;
+	maxEnemies[ENEMY_ID::GREEN] = gm.max_green;
+	maxEnemies[ENEMY_ID::YELLOW] = gm.max_yellow;
+}
+
 void WorldSystem::step_menu() {
 	if (state == GAME_STATE::START_MENU) {
 		MENU_OPTION option = menu_system->poll_start_menu();
@@ -2444,6 +2634,8 @@ void WorldSystem::detect_bossfight() {
 			vec2 distance = abs(player_pos - boss_pos);	// As soon as half of the boss is visible
 			// Enter boss fight when player is close enough to the boss
 			if (distance.x < CONTENT_WIDTH_PX / 2.f && distance.y < CONTENT_HEIGHT_PX / 2.f) {
+				// Retrying the fight starts over from here
+				push_checkpoint();
 				registry.bosses.get(current_boss).activated = true;
 				registry.collidePlayers.emplace(current_boss);	// set here to avoid hitting boss when inactive
 				// start boss music
@@ -2452,12 +2644,8 @@ void WorldSystem::detect_bossfight() {
 				// rotate player to face the boss
 				vec2 delta_pos = boss_pos - player_pos;
 				player_transform.angle = atan2f(delta_pos.y, delta_pos.x) + player_transform.angle_offset;
-				for (uint i = 0; i < registry.attachments.size(); i++) {
-					Entity att_entity = registry.attachments.entities[i];
-					Attachment& att_comp = registry.attachments.components[i];
-					if (att_comp.parent == player) {
-						PhysicsSystem::update_attachment_orientation(att_entity, 1000.f);
-					}
+				for (Entity att_entity : registry.attachments.children_of(player)) {
+					PhysicsSystem::update_attachment_orientation(registry, att_entity, 1000.f);
 				}
 
 				// Kill all small enemies when boss fight starts
@@ -2473,9 +2661,7 @@ void WorldSystem::detect_bossfight() {
 					}
 				}
 				// Remove all bullets when boss fight starts
-				while (registry.projectiles.entities.size() > 0) {
-					registry.remove_all_components_of(registry.projectiles.entities.back());
-				}
+				registry.projectiles.clear();
 				if (registry.enemies.get(current_boss).type == ENEMY_ID::BOSS) {
 					registry.motions.get(current_boss).max_velocity = BOSS_MAX_VELOCITY;
 					for (uint i = 0; i < registry.attachments.size(); i++) {
@@ -2519,28 +2705,11 @@ void WorldSystem::step_chests() {
 
 				individual_spawn_interval = 200.f;
 
-				// first timer: spawn lots of enemies for a couple seconds
-				TimedEvent& timer = registry.timedEvents.emplace(Entity());
-				timer.timer_ms = 2700.f;
-				timer.callback = [c, this]() {
-					// first callback: this code will run when first timer expires
-					individual_spawn_interval = 1000.f; // revert spawn change
-					enemy_spawn_cooldown = 25000.f; // don't spawn for x seconds
-					printf("set cooldown\n");
-
-					// second timer: don't activate again for x seconds
-					TimedEvent& timer = registry.timedEvents.emplace(Entity());
-					timer.timer_ms = 25000.f;
-					timer.callback = [c, this]() {
-						// second callback: this code will run when second timer expires
-						if (registry.chests.has(c)) {
-							Chest& chest = registry.chests.get(c);
-							printf("deactivating\n");
-
-							chest.waveActivated = false;
-						}
-						};
-					};
+				// spawn lots of enemies for a couple seconds, see fire_event
+				TimedEvent wave_end;
+				wave_end.type = TIMED_EVENT_ID::CHEST_WAVE_END;
+				wave_end.entity = c;
+				schedule_event(2700.f, wave_end);
 			}
 		}
 	}
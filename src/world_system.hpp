@@ -2,12 +2,21 @@
 
 // internal
 #include "common.hpp"
+#include "frame_context.hpp"
+#include "input_recording.hpp"
+#include "input_state.hpp"
+#include "random_service.hpp"
+#include "registry_snapshot.hpp"
 #include "render_system.hpp"
+#include "save_game.hpp"
+#include "spawn_manager.hpp"
+#include "timer_wheel.hpp"
 #include "./sub_systems/dialog_system.hpp"
 #include "./sub_systems/effects_system.hpp"
 #include "./sub_systems/menu_system.hpp"
 
 // stlib
+#include <map>
 #include <vector>
 #include <random>
 
@@ -20,15 +29,18 @@
 class WorldSystem
 {
 public:
-	WorldSystem();
+	WorldSystem(ECSRegistry& registry);
 
 	// Creates a window
 	GLFWwindow* create_window();
 
 	void on_controller_joy(int joy, int event);
 
-	// starts the game
-	void init(RenderSystem* renderer);
+	// starts the game, false if its data fails to load
+	bool init(RenderSystem* renderer, const FrameContext* frame);
+
+	// Starts a fresh run right away, skipping the start menu. Without dialogs nothing waits for input.
+	void start_run(bool show_dialogs);
 
 	// Releases all associated resources
 	~WorldSystem();
@@ -41,6 +53,7 @@ public:
 
 	// Check for collisions
 	void resolve_collisions();
+	void resolve_projectile_hits();
 
 	// Should the game be over ?
 	bool is_over()const;
@@ -49,9 +62,46 @@ public:
 
 	void startEntityDeath(Entity entity);
 
+	// Delayed callbacks, advanced while the game is running. Changes to the world go through
+	// schedule_event instead, so saves can hold them.
+	TimerWheel timers;
+	// Applies event after delay_ms of play (effect durations, camera shake, ...)
+	void schedule_event(float delay_ms, const TimedEvent& event);
+
+	// Keyboard, mouse and gamepad state, edges are cleared by the caller after each step
+	InputState input;
+	// Records every event passed to handle_input_event while set
+	InputRecorder* recorder = nullptr;
+	// Input from the GLFW callbacks is dropped while false, e.g. during a replay
+	bool live_input = true;
+
+	// Entry point of all player input, live from GLFW or replayed
+	void handle_input_event(const InputEvent& event);
+	// Reads the joystick and forwards it as an input event when it changed
+	void poll_gamepad();
+	// Replaces the seed picked at construction, call before init()
+	void set_seed(uint32_t seed);
+	// Preset of the easy or regular mode, as picked in the start menu
+	const GameMode& get_game_mode(GAME_MODE_ID id) const { return id == GAME_MODE_ID::EASY_MODE ? easyMode : regularMode; }
+	// Plays with the given enemy caps, health and boss difficulty from now on, call after init()
+	void set_game_mode(const GameMode& mode);
+	// Simulated time between autosaves during play, 0 turns autosave off
+	float autosave_interval_ms = AUTOSAVE_INTERVAL_MS;
+
+	// Checkpoints of the whole simulation, e.g. the start of a boss fight so dying in it retries the
+	// fight. Besides the registry they hold the pending timed events, the random streams and what
+	// this system and the effects keep next to the registry. Restarts and loads drop them.
+	void push_checkpoint();
+	// Goes back to the checkpoint pushed back checkpoints ago, see SnapshotRing::restore. Input stays
+	// as it is. Between ticks the caller refreshes its FrameContext afterwards, the camera moved.
+	bool restore_checkpoint(size_t back = 0);
+	size_t checkpoint_count() const { return checkpoints.size(); }
+
 private:
 	// Input callback functions
+	void on_glfw_input(const InputEvent& event);
 	void on_key(int key, int, int action, int mod);
+	void on_mouse_button(int button, int action, int mod);
 	void on_mouse_move(vec2 pos);
 
 	void menu_controller(float elapsed_ms_since_last_update);
@@ -72,14 +122,20 @@ private:
 	void reset_game_state(bool hard_reset = false);
 	template <typename Component>
 	void clearSpecificEntities(ComponentContainer<Component>& componentRegistry);
+	// Calls visitor with every container whose entities make up a run, the ones a reset removes
+	template <typename Visitor>
+	static void for_each_run_container(ECSRegistry& registry, bool hard_reset, Visitor&& visitor);
 	void populate_player_abilities();
+	void apply_health_boost_hud();
 	void populate_region_goals();
 
 	// OpenGL window handle
 	GLFWwindow* window;
 
 	// Game state
+	ECSRegistry& registry;	// The world this system runs
 	RenderSystem* renderer;
+	const FrameContext* frame;	// Camera and view matrices of the current tick
 	EffectsSystem* effects_system;
 	float current_speed;
 	Entity player;
@@ -111,21 +167,74 @@ private:
 	void handle_shooting_sound_effect();
 	bool isShootingSoundQueued;
 
-	// C++ random number generator
-	std::default_random_engine rng;
+	// Counter-based random stream, seeded through registry.random
+	RandomStream rng;
 	std::uniform_real_distribution<float> uniform_dist; // number between 0..1
 
 	DialogSystem* dialog_system = nullptr;
 	MenuSystem* menu_system = nullptr;
 	
-	// Maintain enemy counts
-	std::unordered_map<ENEMY_ID, int> enemyCounts;
+	// Enemy caps of the game mode, live counts are in registry.population
 	std::unordered_map<ENEMY_ID, int> maxEnemies;
+	SpawnManager spawn_manager;
+	std::vector<Entity> despawned;	// Scratch list for spawn_manager.step
+	float enemy_spawn_cooldown = 5000.f;
+	float individual_spawn_interval = 1000.f;
+
+	// Kept for each checkpoint in the ring, by slot
+	struct CheckpointState {
+		GAME_STATE state = GAME_STATE::RUNNING;
+		Entity player;
+		Entity death_screen;
+		RandomStream rng;
+		float enemy_spawn_cooldown = 0.f;
+		float individual_spawn_interval = 0.f;
+		float current_speed = 0.f;
+		bool allow_accel = true;
+		float camera_time_ms = 0.f;
+		SpawnManager::ScanTimes scan_times = {};
+		TimerWheel::Time timer_time;
+		std::vector<std::pair<float, TimedEvent>> events;	// Remaining ms and event, in scheduling order
+		EffectsSystem::Checkpoint effects;
+	};
+	static const size_t CHECKPOINT_CAPACITY = 4;
+	SnapshotRing checkpoints;
+	std::vector<CheckpointState> checkpoint_states;
 
 	bool allow_accel;
+	float camera_time_ms = 0.f;		// Drives the camera shake
+	float menu_timer = 0.f;
+	bool controller_mode = false; //if most recent input is controller set to 1, if mouse/keyboard set to 0
+	float spaceBarPressDuration = 0.0f;
+	vec2 mouse = { 0.f, 0.f };
 	void shakeCamera(float amount, float ms, float shake_scale = 2.f, vec2 direction = vec2(1.f, 0.f));
 	void squish(Entity entity, float squish_amount);
 
+	// Events waiting for their timer, by id in scheduling order
+	struct PendingEvent {
+		TimedEvent event;
+		TimerHandle timer;
+	};
+	std::map<uint32_t, PendingEvent> pending_events;
+	uint32_t next_event_id = 0;
+	void fire_event(uint32_t id);
+	// Schedules an event of a loaded game, redoing what it changed outside the saved world
+	void resume_event(float delay_ms, TimedEvent event);
+
+
+	// Collision handlers, called by registry.collisionEvents with every collision of their type
+	void subscribe_collision_handlers();
+	void on_boundary_collisions(const std::vector<CollisionEvent>& events);
+	void on_region_boundary_collisions(const std::vector<CollisionEvent>& events);
+	void on_player_enemy_collisions(const std::vector<CollisionEvent>& events);
+	void on_player_cure_collisions(const std::vector<CollisionEvent>& events);
+	void on_sword_enemy_collisions(const std::vector<CollisionEvent>& events);
+	void on_sword_cyst_collisions(const std::vector<CollisionEvent>& events);
+	void on_player_cyst_collisions(const std::vector<CollisionEvent>& events);
+	// Opens the chest the player touches once interact was held long enough
+	void step_chest_pickup();
+	bool show_hold_guide = false;
+	std::vector<Entity> collision_garbage;	// Removed once all handlers ran
 
 	// Step different sub-systems
 	void step_deathTimer(float elapsed_ms);
@@ -135,7 +244,6 @@ private:
 	void step_attack(float elapsed_ms);
 	void step_dash(float elapsed_ms);
 	void step_enemySpawn(float elapsed_ms);
-	void step_timer_with_callback(float elapsed_ms);
 	void step_waypoints();
 	void step_menu();
 	void detect_bossfight();
@@ -147,18 +255,27 @@ private:
 	void spawnEnemyOfType(ENEMY_ID type, vec2 player_position, vec2 player_velocity);
 	int getMaxEnemiesForType(ENEMY_ID type);
 
-	void remove_garbage();
+	void remove_garbage(float elapsed_ms);
 	void remove_entity(Entity entity);
 	void create_debug_lines();
 
 	void load_game();
-	void loadRegions(const json& regionsData);
+	// staged holds the world of a JSON save, see read_save_json
+	void apply_save_state(const SaveState& saved, WorldStaging* staged = nullptr);
+	void loadRegions(const std::vector<SavedRegion>& regionsData);
 	void save_game();
-	json serializeGameState();
-
-	Entity& getAttachment(Entity character, ATTACHMENT_ID type);
+	// Read the save out of a registry copy on the writer thread, see SaveWriter
+	static void build_save_state(ECSRegistry& registry, const SaveCapture& capture, SaveState& saved);
+	static void build_world_state(ECSRegistry& registry, const SaveCapture& capture, SaveState& saved);
+	bool restore_world_state(const SaveState& saved, WorldStaging* staged);
+	void step_autosave(float elapsed_ms);
+	SaveWriter save_writer;
+	float autosave_timer_ms = 0.f;
+
+	Entity getAttachment(Entity character, ATTACHMENT_ID type);
 	bool hasPlayerAbility(PLAYER_ABILITY_ID abilityId);
 	void show_hold_to_collect();
 
 	void setGameMode(GAME_MODE_ID id);
+	void update_enemy_limits();
 };